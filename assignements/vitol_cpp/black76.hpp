@@ -0,0 +1,323 @@
+/*
+ * black76.hpp - Options sur futures : modèle de Black-76
+ *
+ * Nos options de commodités sont réglées sur des FUTURES, pas sur le spot :
+ * le sous-jacent d'une option WTI de maturité T est (à peu près) le future
+ * de même échéance, dont le prix est lu sur la courbe forward.
+ * BlackScholesModel part du spot et reconstruit le forward par le portage
+ * au taux sans risque (F = S e^{rT}) : faux dès que la courbe est en
+ * backwardation ou intègre stockage et convenience yield.
+ *
+ * Black-76 prend directement F = ForwardCurve::get_forward(T) :
+ *     prix = D × w × (F N(w d1) - K N(w d2)),   D = facteur d'actualisation
+ *     d1 = (ln(F/K) + σ²T/2) / σ√T,   d2 = d1 - σ√T,   w = +1 call / -1 put
+ *
+ * Même forme que le modèle de Black d'ImpliedVolatility::black_batch :
+ * l'inversion prix → vol est directe (aucune conversion spot/forward).
+ */
+
+#pragma once
+
+#include "types.hpp"              // expected<>, RiskError, Position
+#include "math_utils.hpp"         // norm_cdf, fast_log, fast_norm_cdf
+#include "curve_builder.hpp"      // ForwardCurve
+#include "implied_volatility.hpp" // Inversion du modèle de Black par lots
+#include <unordered_map>          // Courbes et vols par sous-jacent
+#include <string>                 // Noms des sous-jacents
+#include <vector>                 // Colonnes du book
+#include <span>                   // Entrées/sorties par lots
+#include <array>                  // Tranches locales
+#include <algorithm>              // min, max
+#include <utility>                // pair (F, D) par maturité
+#include <cstdint>                // uint8_t, uint32_t
+#include <cmath>                  // exp, log, sqrt
+
+// ===== DONNÉES DE MARCHÉ DES OPTIONS SUR FUTURES =====
+/*
+ * Équivalent de MarketData pour Black-76 : une courbe de futures par
+ * sous-jacent au lieu d'un spot
+ */
+struct FuturesMarketData {
+    std::unordered_map<std::string, ForwardCurve> curves;  // "WTI" → courbe des futures WTI
+    std::unordered_map<std::string, double> volatilities;  // Vol Black par sous-jacent
+    double risk_free_rate{0.05};                           // Actualisation (ForwardCurve::discount_factor)
+};
+
+// ===== MODÈLE BLACK-76 =====
+/*
+ * Sans état : toutes les fonctions sont static.
+ * ATTENTION : ForwardCurve::get_forward mémorise ses interpolations dans un
+ * cache mutable non protégé → les lectures de courbe de price_book sont
+ * faites par un seul thread ; le noyau black_batch, lui, est réentrant.
+ */
+class Black76Model {
+public:
+    static constexpr size_t BATCH_CHUNK = 64;  // Options par tranche (comme BlackScholesModel)
+
+    /*
+     * PRIX SUR LE FORWARD (noyau scalaire)
+     * ====================================
+     * F = prix du future, D = facteur d'actualisation jusqu'au paiement
+     * Pas de validation : à l'appelant (voir price())
+     */
+    [[nodiscard]] static double price_forward(double F, double K, double T, double D, double vol, bool is_call = true) noexcept {
+        const double w = is_call ? 1.0 : -1.0;
+        if (T <= 0.0) return D * std::max(w * (F - K), 0.0);  // Valeur intrinsèque
+
+        const double vol_sqrt_T = vol * std::sqrt(T);
+        const double d1 = (std::log(F / K) + 0.5 * vol_sqrt_T * vol_sqrt_T) / vol_sqrt_T;
+        const double d2 = d1 - vol_sqrt_T;
+        return D * w * (F * FastMath::norm_cdf(w * d1) - K * FastMath::norm_cdf(w * d2));
+        /*
+         * Pas de terme en r dans d1 : le future ne coûte rien à porter,
+         * le taux n'intervient que par D
+         */
+    }
+
+    /*
+     * PRIX D'UNE OPTION SUR FUTURE À PARTIR DE LA COURBE
+     * ==================================================
+     * F = curve.get_forward(T), D = curve.discount_factor(T, r)
+     * Erreurs : MISSING_MARKET_DATA (courbe vide ou invalide),
+     * INVALID_VOLATILITY, NEGATIVE_TIME, INVALID_STRIKE (comme price_uncached)
+     */
+    [[nodiscard]] static expected<double, RiskError> price(const ForwardCurve& curve, double K, double T,
+                                                           double r, double vol, bool is_call = true) {
+        if (!curve.is_valid()) return expected<double, RiskError>{RiskError::MISSING_MARKET_DATA};
+        if (vol <= 0) return expected<double, RiskError>{RiskError::INVALID_VOLATILITY};
+        if (T < 0) return expected<double, RiskError>{RiskError::NEGATIVE_TIME};
+        if (K <= 0) return expected<double, RiskError>{RiskError::INVALID_STRIKE};
+
+        const double F = curve.get_forward(T);
+        if (F <= 0) return expected<double, RiskError>{RiskError::MISSING_MARKET_DATA};
+        return expected<double, RiskError>{price_forward(F, K, T, curve.discount_factor(T, r), vol, is_call)};
+    }
+
+    /*
+     * SORTIES DU CALCUL PAR LOTS
+     * ==========================
+     * price : prix unitaire actualisé
+     * delta : dPrix/dF, sensibilité au FUTURE (= D × w × N(w d1)) : nombre
+     *         de futures à traiter pour couvrir une option
+     */
+    struct Black76Batch {
+        std::span<double> price;
+        std::span<double> delta;
+    };
+
+    /*
+     * PRIX ET DELTA FUTURES PAR LOTS (STRUCTURE DE TABLEAUX)
+     * ======================================================
+     * Option i = (F[i], K[i], T[i], D[i], vol[i], is_call[i]) → out.*[i]
+     * Même noyau que BlackScholesModel::price_and_greeks_batch : tranches
+     * locales, masques au lieu de branches (fast_log, fast_exp, fast_norm_cdf)
+     * - T == 0 → D × valeur intrinsèque, delta 0 / ±D
+     * - Entrées refusées (vol ≤ 0, T < 0, F, K ou D ≤ 0) → 0, valid[i] = 0
+     */
+    static void black_batch(
+        std::span<const double> F,
+        std::span<const double> K,
+        std::span<const double> T,
+        std::span<const double> D,
+        std::span<const double> vol,
+        std::span<const uint8_t> is_call,
+        const Black76Batch& out,
+        std::span<uint8_t> valid = {}) noexcept {
+
+        const size_t n = F.size();
+        for (size_t begin = 0; begin < n; begin += BATCH_CHUNK) {
+            const size_t m = std::min(BATCH_CHUNK, n - begin);
+            std::array<double, BATCH_CHUNK> chunk_price, chunk_delta;
+
+            // Call : +1, Put : -1 (conversion à part : octets et doubles ne se vectorisent pas ensemble)
+            std::array<double, BATCH_CHUNK> chunk_sign;
+            for (size_t lane = 0; lane < m; ++lane) chunk_sign[lane] = is_call[begin + lane] ? 1.0 : -1.0;
+
+            for (size_t lane = 0; lane < m; ++lane) {
+                const size_t j = begin + lane;
+                const bool ok = (vol[j] > 0.0) & (T[j] >= 0.0) & (K[j] > 0.0) & (F[j] > 0.0) & (D[j] > 0.0);
+                const bool live = ok & (T[j] > 0.0);
+
+                // Entrées neutres pour les options masquées
+                const double f = ok ? F[j] : 1.0;
+                const double k = ok ? K[j] : 1.0;
+                const double d = ok ? D[j] : 1.0;
+                const double t = live ? T[j] : 1.0;
+                const double v = live ? vol[j] : 1.0;
+                const double w = chunk_sign[lane];
+
+                const double vol_sqrt_t = v * std::sqrt(t);
+                const double d1 = (FastMath::fast_log(f / k) + 0.5 * vol_sqrt_t * vol_sqrt_t) / vol_sqrt_t;
+                const double d2 = d1 - vol_sqrt_t;
+                const double n_d1 = FastMath::fast_norm_cdf(w * d1);
+                const double n_d2 = FastMath::fast_norm_cdf(w * d2);
+
+                const double price = d * w * (f * n_d1 - k * n_d2);
+                const double delta = d * w * n_d1;
+
+                const double moneyness = w * (f - k);
+                const double intrinsic = d * std::max(moneyness, 0.0);
+                const double step_delta = moneyness > 0.0 ? d * w : 0.0;
+
+                chunk_price[lane] = live ? price : (ok ? intrinsic : 0.0);
+                chunk_delta[lane] = live ? delta : (ok ? step_delta : 0.0);
+            }
+
+            std::copy_n(chunk_price.begin(), m, out.price.begin() + begin);
+            std::copy_n(chunk_delta.begin(), m, out.delta.begin() + begin);
+        }
+
+        if (!valid.empty()) {
+            for (size_t i = 0; i < n; ++i) {
+                valid[i] = (vol[i] > 0.0) & (T[i] >= 0.0) & (K[i] > 0.0) & (F[i] > 0.0) & (D[i] > 0.0);
+            }
+        }
+    }
+
+    /*
+     * PRICING D'UN BOOK D'OPTIONS SUR FUTURES
+     * =======================================
+     * Position i → out.price[i], out.delta[i] (unitaires : × notional pour la position)
+     *
+     * Les positions sont regroupées par courbe (sous-jacent) puis par
+     * maturité (table par courbe, sans tri) : F et D sont lus UNE fois par
+     * couple (courbe, maturité) distinct, et non une fois par option. Un book de 10,000 options sur
+     * une vingtaine d'échéances listées fait ~20 interpolations par courbe
+     * au lieu de 10,000 recherches dans la map de get_forward.
+     * Le pricing lui-même est le noyau vectorisé black_batch, dans l'ordre
+     * d'origine des positions.
+     *
+     * Positions invalides, sans courbe ou sans vol → 0, valid[i] = 0
+     */
+    static void price_book(
+        std::span<const Position> positions,
+        const FuturesMarketData& market_data,
+        const Black76Batch& out,
+        std::span<uint8_t> valid = {}) {
+
+        const size_t n = positions.size();
+
+        /*
+         * 1. RÉSOLUTION DES SOUS-JACENTS (une recherche par nom distinct ;
+         *    positions consécutives sur le même sous-jacent : aucune)
+         */
+        struct CurveGroup {
+            const ForwardCurve* curve;  // nullptr = pas de courbe exploitable
+            double vol;
+            std::unordered_map<double, std::pair<double, double>> by_maturity;  // T → (F, D)
+        };
+        std::vector<CurveGroup> groups;
+        std::unordered_map<std::string, uint32_t> group_ids;
+        std::vector<uint32_t> group_of(n);
+
+        for (size_t i = 0; i < n; ++i) {
+            const std::string& name = positions[i].underlying;
+            if (i > 0 && name == positions[i - 1].underlying) {
+                group_of[i] = group_of[i - 1];
+                continue;
+            }
+            const auto [it, inserted] = group_ids.try_emplace(name, static_cast<uint32_t>(groups.size()));
+            if (inserted) {
+                const auto curve = market_data.curves.find(name);
+                const auto vol = market_data.volatilities.find(name);
+                const bool usable = curve != market_data.curves.end() && curve->second.is_valid()
+                                 && vol != market_data.volatilities.end();
+                groups.push_back({usable ? &curve->second : nullptr, usable ? vol->second : 0.0, {}});
+            }
+            group_of[i] = it->second;
+        }
+
+        /*
+         * 2. COLONNES DU NOYAU + LECTURE DES COURBES
+         *    F et D mémorisés par (courbe, maturité) : get_forward n'est
+         *    appelé qu'à la première option de chaque maturité distincte.
+         *    Lignes inutilisables : F = 0, masquées par black_batch
+         */
+        std::vector<double> forwards(n, 0.0), strikes(n), maturities(n), discounts(n, 1.0), vols(n, 0.0);
+        std::vector<uint8_t> is_call(n);
+        for (size_t i = 0; i < n; ++i) {
+            const Position& pos = positions[i];
+            strikes[i] = pos.strike;
+            maturities[i] = pos.maturity;
+            is_call[i] = pos.is_call;
+
+            CurveGroup& group = groups[group_of[i]];
+            if (!pos.is_valid() || group.curve == nullptr) continue;
+
+            auto [it, first_seen] = group.by_maturity.try_emplace(pos.maturity);
+            if (first_seen) {
+                it->second = {group.curve->get_forward(pos.maturity),
+                              group.curve->discount_factor(pos.maturity, market_data.risk_free_rate)};
+            }
+            forwards[i] = it->second.first;
+            discounts[i] = it->second.second;
+            vols[i] = group.vol;
+        }
+
+        /*
+         * 4. PRICING VECTORISÉ
+         */
+        black_batch(forwards, strikes, maturities, discounts, vols, is_call, out, valid);
+    }
+
+    /*
+     * VOLATILITÉ IMPLICITE D'UNE OPTION SUR FUTURE
+     * ============================================
+     * price = prix de marché actualisé ; même courbe et même actualisation
+     * que price(). Pour une chaîne entière : ImpliedVolatility::black_batch
+     * directement sur (F, K, T, D, prix), c'est le même modèle.
+     * Erreurs : MISSING_MARKET_DATA, NEGATIVE_TIME (T ≤ 0), INVALID_STRIKE,
+     * COMPUTATION_FAILED (prix hors des bornes d'arbitrage, sans valeur temps mesurable
+     * ou non convergé)
+     */
+    [[nodiscard]] static expected<double, RiskError> implied_volatility(
+        const ForwardCurve& curve, double price, double K, double T, double r, bool is_call = true) {
+        if (!curve.is_valid()) return expected<double, RiskError>{RiskError::MISSING_MARKET_DATA};
+        if (T <= 0) return expected<double, RiskError>{RiskError::NEGATIVE_TIME};
+        if (K <= 0) return expected<double, RiskError>{RiskError::INVALID_STRIKE};
+
+        const double F = curve.get_forward(T);
+        if (F <= 0) return expected<double, RiskError>{RiskError::MISSING_MARKET_DATA};
+        const double D = curve.discount_factor(T, r);
+
+        const uint8_t call = is_call;
+        double vol = 0.0;
+        ImpliedVolStatus status = ImpliedVolStatus::INVALID_INPUT;
+        ImpliedVolatility::black_batch({&F, 1}, {&K, 1}, {&T, 1}, {&D, 1}, {&price, 1}, {&call, 1},
+                                       {&vol, 1}, {&status, 1});
+        if (status != ImpliedVolStatus::CONVERGED) return expected<double, RiskError>{RiskError::COMPUTATION_FAILED};
+        return expected<double, RiskError>{vol};
+    }
+};
+
+/*
+ * RÉSUMÉ DE CE FICHIER :
+ * ======================
+ *
+ * 1. FuturesMarketData : courbe de futures + vol par sous-jacent, taux d'actualisation
+ * 2. Black76Model::price_forward : formule de Black-76 sur (F, K, T, D, σ)
+ * 3. Black76Model::price : option sur future, F et D lus sur une ForwardCurve
+ * 4. Black76Model::black_batch : prix + delta futures par lots (SoA, vectorisé)
+ * 5. Black76Model::price_book : book entier, une lecture de courbe par
+ *    couple (sous-jacent, maturité) distinct, puis black_batch
+ * 6. Black76Model::implied_volatility : prix de marché → vol Black
+ *    (ImpliedVolatility::black_batch, même modèle)
+ *
+ * POURQUOI PAS BLACK-SCHOLES SUR LE SPOT ?
+ * - Le forward de Black-Scholes est S e^{rT} : toujours en contango
+ * - Une courbe pétrolière en backwardation (F < S) surévalue alors les
+ *   calls et sous-évalue les puts
+ * - Black-76 price contre le future réellement livré à l'exercice
+ *
+ * USAGE TYPIQUE :
+ * FuturesMarketData market{
+ *     .curves = {{"WTI", ForwardCurveBuilder::build_from_futures("WTI", wti_quotes, InterpolationType::LINEAR)}},
+ *     .volatilities = {{"WTI", 0.35}},
+ *     .risk_free_rate = 0.05
+ * };
+ * auto call = Black76Model::price(market.curves.at("WTI"), 80.0, 0.5, 0.05, 0.35, true);
+ *
+ * // Book entier : une span par résultat
+ * std::vector<double> prices(positions.size()), deltas(positions.size());
+ * Black76Model::price_book(positions, market, {.price = prices, .delta = deltas});
+ */
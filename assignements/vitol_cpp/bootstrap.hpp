@@ -94,8 +94,8 @@ public:
                 }
             }  // CORRECTION: Fermeture du switch manquait
             
-            // ES sur cet échantillon
-            auto [var_boot, es_boot] = mc_.calculate_var_es(boot_sample, confidence);
+            // ES sur cet échantillon (échantillon jetable : sélection sur place, sans copie)
+            auto [var_boot, es_boot] = MonteCarloEngine::calculate_var_es_in_place(boot_sample, confidence);
             bootstrap_es_values.push_back(es_boot);
         }
         
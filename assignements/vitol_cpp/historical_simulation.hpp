@@ -0,0 +1,273 @@
+/*
+ * historical_simulation.hpp - Historiques de rendements pour la VaR historique
+ *
+ * La VaR Monte Carlo suppose des rendements log-normaux corrélés : queues
+ * minces, volatilité constante. La simulation historique rejoue à la place
+ * les rendements OBSERVÉS (ex: 10 ans de WTI, Brent, NatGas...) sur le
+ * portefeuille d'aujourd'hui : queues épaisses et co-mouvements réels.
+ *
+ * Ce fichier fournit :
+ * - des sources d'historique lues par blocs de dates (concept ReturnSource) :
+ *   fichier CSV ou séries en mémoire (ex: TimeSeriesSimulator)
+ * - le filtre de volatilité EWMA de la simulation historique FILTRÉE
+ * Le calcul lui-même (réévaluation du book, quantiles) est celui de
+ * PortfolioRiskCalculator::calculate_historical_risk.
+ */
+
+#pragma once
+
+#include "types.hpp"   // ReturnSource
+#include <string>      // Noms des sous-jacents, lignes du fichier
+#include <string_view> // Découpage des lignes
+#include <vector>      // Colonnes, variances
+#include <span>        // Blocs de dates
+#include <fstream>     // Lecture du CSV
+#include <charconv>    // from_chars (lecture sans locale ni allocation)
+#include <algorithm>   // min, ranges::min
+#include <cmath>       // sqrt
+
+// ===== CONFIGURATION =====
+/*
+ * MÉTHODE
+ * - HISTORICAL : rendement du scénario d = rendement observé à la date d
+ * - FILTERED_HISTORICAL : rendement observé divisé par la volatilité EWMA
+ *   du moment (résidu standardisé z_d), puis multiplié par la volatilité
+ *   COURANTE → un choc de 2008 est rejoué à l'échelle du marché d'aujourd'hui
+ */
+enum class HistoricalMethod {
+    HISTORICAL,
+    FILTERED_HISTORICAL
+};
+
+struct HistoricalConfig {
+    HistoricalMethod method{HistoricalMethod::HISTORICAL};
+    size_t block_dates{256};   // Dates lues et réévaluées ensemble (mémoire : bloc × colonnes)
+    double ewma_lambda{0.94};  // FILTERED_HISTORICAL : persistance de la variance (RiskMetrics)
+};
+
+/*
+ * VALEURS DU FICHIER
+ * - RETURNS : rendements simples, une ligne par date
+ * - PRICES : prix ; rendement = P_d / P_{d-1} - 1 (la première date sert de base)
+ */
+enum class HistoryValues {
+    RETURNS,
+    PRICES
+};
+
+// ===== HISTORIQUE EN FICHIER CSV =====
+/*
+ * FORMAT :
+ *     date,WTI,BRENT,NATGAS
+ *     2015-01-02,-0.0123,-0.0101,0.0210
+ *     ...
+ * Première colonne (date) ignorée, dates croissantes.
+ * Le fichier est lu au fil de read() : seul le bloc courant est en mémoire.
+ * Lignes illisibles (champ manquant, nombre invalide, prix ≤ 0) ignorées
+ * et comptées (malformed_lines). En PRICES, la ligne suivante redevient une
+ * base : un rendement de moins, mais jamais de rendement sur deux dates.
+ */
+class CsvReturnHistory {
+public:
+    explicit CsvReturnHistory(const std::string& path, HistoryValues values = HistoryValues::RETURNS)
+        : file_(path), values_(values) {
+        std::string header;
+        if (!file_ || !std::getline(file_, header)) return;
+        std::string_view fields(header);
+        strip_carriage_return(fields);
+        next_field(fields);  // Colonne des dates
+        while (!fields.empty()) underlyings_.emplace_back(next_field(fields));
+        data_start_ = file_.tellg();
+    }
+
+    [[nodiscard]] bool is_open() const noexcept { return !underlyings_.empty(); }
+    [[nodiscard]] std::span<const std::string> underlyings() const noexcept { return underlyings_; }
+    [[nodiscard]] size_t malformed_lines() const noexcept { return malformed_; }
+
+    void rewind() {
+        if (!is_open()) return;
+        file_.clear();
+        file_.seekg(data_start_);
+        previous_prices_.clear();
+        malformed_ = 0;
+    }
+
+    [[nodiscard]] size_t read(std::span<double> block) {
+        const size_t n_columns = underlyings_.size();
+        if (n_columns == 0) return 0;
+        const size_t capacity = block.size() / n_columns;
+
+        size_t n_dates = 0;
+        std::string line;
+        while (n_dates < capacity && std::getline(file_, line)) {
+            std::string_view fields(line);
+            strip_carriage_return(fields);
+            if (fields.empty()) continue;
+
+            const auto row = block.subspan(n_dates * n_columns, n_columns);
+            if (!parse_row(fields, row)) {
+                ++malformed_;
+                previous_prices_.clear();  // PRICES : pas de rendement à cheval sur la ligne perdue
+                continue;
+            }
+            if (values_ == HistoryValues::PRICES) {
+                if (previous_prices_.empty()) {  // Première date : base des rendements
+                    previous_prices_.assign(row.begin(), row.end());
+                    continue;
+                }
+                for (size_t c = 0; c < n_columns; ++c) {
+                    const double price = row[c];
+                    row[c] = price / previous_prices_[c] - 1.0;
+                    previous_prices_[c] = price;
+                }
+            }
+            ++n_dates;
+        }
+        return n_dates;
+    }
+
+private:
+    std::ifstream file_;
+    HistoryValues values_;
+    std::vector<std::string> underlyings_;
+    std::streampos data_start_{};
+    std::vector<double> previous_prices_;  // PRICES : prix de la dernière date lue
+    size_t malformed_{0};
+
+    [[nodiscard]] bool parse_row(std::string_view fields, std::span<double> row) const {
+        next_field(fields);  // Date
+        for (double& value : row) {
+            if (fields.empty()) return false;
+            const std::string_view field = next_field(fields);
+            const auto [end, error] = std::from_chars(field.data(), field.data() + field.size(), value);
+            if (error != std::errc{} || end != field.data() + field.size()) return false;
+            if (values_ == HistoryValues::PRICES && !(value > 0.0)) return false;
+        }
+        return fields.empty();
+    }
+
+    // Champ suivant (avant la virgule), retiré de fields
+    static std::string_view next_field(std::string_view& fields) noexcept {
+        const size_t comma = fields.find(',');
+        const std::string_view field = fields.substr(0, comma);
+        fields.remove_prefix(comma == std::string_view::npos ? fields.size() : comma + 1);
+        return field;
+    }
+
+    static void strip_carriage_return(std::string_view& line) noexcept {
+        if (!line.empty() && line.back() == '\r') line.remove_suffix(1);
+    }
+};
+
+// ===== HISTORIQUE EN MÉMOIRE =====
+/*
+ * Une série de rendements par sous-jacent (ex: générées par
+ * TimeSeriesSimulator). Séries de longueurs différentes : alignées sur la
+ * date la plus récente, seules les dates communes sont rejouées.
+ */
+class InMemoryReturnHistory {
+public:
+    InMemoryReturnHistory(std::vector<std::string> underlyings, std::vector<std::vector<double>> returns)
+        : underlyings_(std::move(underlyings)), returns_(std::move(returns)) {
+        if (returns_.size() != underlyings_.size() || returns_.empty()) {
+            underlyings_.clear();
+            returns_.clear();
+            return;
+        }
+        n_dates_ = std::ranges::min(returns_, {}, &std::vector<double>::size).size();
+    }
+
+    // Séries de PRIX → rendements P_d / P_{d-1} - 1 (même formule que TimeSeriesSimulator::prices_to_returns)
+    [[nodiscard]] static InMemoryReturnHistory from_prices(std::vector<std::string> underlyings,
+                                                           const std::vector<std::vector<double>>& prices) {
+        std::vector<std::vector<double>> returns(prices.size());
+        for (size_t c = 0; c < prices.size(); ++c) {
+            for (size_t d = 1; d < prices[c].size(); ++d) {
+                returns[c].push_back((prices[c][d] - prices[c][d - 1]) / prices[c][d - 1]);
+            }
+        }
+        return InMemoryReturnHistory(std::move(underlyings), std::move(returns));
+    }
+
+    [[nodiscard]] std::span<const std::string> underlyings() const noexcept { return underlyings_; }
+    [[nodiscard]] size_t n_dates() const noexcept { return n_dates_; }
+
+    void rewind() noexcept { cursor_ = 0; }
+
+    [[nodiscard]] size_t read(std::span<double> block) noexcept {
+        const size_t n_columns = underlyings_.size();
+        if (n_columns == 0) return 0;
+        const size_t n = std::min(block.size() / n_columns, n_dates_ - cursor_);
+        for (size_t c = 0; c < n_columns; ++c) {
+            const size_t first = returns_[c].size() - n_dates_ + cursor_;  // Alignement sur la fin
+            for (size_t d = 0; d < n; ++d) block[d * n_columns + c] = returns_[c][first + d];
+        }
+        cursor_ += n;
+        return n;
+    }
+
+private:
+    std::vector<std::string> underlyings_;
+    std::vector<std::vector<double>> returns_;
+    size_t n_dates_{0};
+    size_t cursor_{0};
+};
+
+static_assert(ReturnSource<CsvReturnHistory>);
+static_assert(ReturnSource<InMemoryReturnHistory>);
+
+// ===== FILTRE DE VOLATILITÉ EWMA =====
+/*
+ * Variance de chaque série, mise à jour date par date :
+ *     σ²_{d+1} = λ σ²_d + (1 - λ) r_d²
+ * σ_d n'utilise que les rendements ANTÉRIEURS à d : z_d = r_d / σ_d est
+ * le résidu standardisé (≈ variance 1 quelle que soit l'époque).
+ * État : une variance par série, quelle que soit la longueur de l'historique.
+ */
+class EwmaVolatilityFilter {
+public:
+    EwmaVolatilityFilter(std::span<const double> initial_variances, double lambda)
+        : variances_(initial_variances.begin(), initial_variances.end()), lambda_(lambda) {}
+
+    [[nodiscard]] double volatility(size_t series) const noexcept { return std::sqrt(variances_[series]); }
+
+    void update(size_t series, double r) noexcept {
+        variances_[series] = lambda_ * variances_[series] + (1.0 - lambda_) * r * r;
+    }
+
+    // z_d = r_d / σ_d, puis σ_{d+1} (variance nulle : rendement inchangé)
+    [[nodiscard]] double standardize(size_t series, double r) noexcept {
+        const double sigma = volatility(series);
+        update(series, r);
+        return sigma > 0.0 ? r / sigma : r;
+    }
+
+private:
+    std::vector<double> variances_;
+    double lambda_;
+};
+
+/*
+ * RÉSUMÉ DE CE FICHIER :
+ * ======================
+ *
+ * 1. HistoricalConfig : méthode (historique / historique filtrée), taille des
+ *    blocs de dates, λ de l'EWMA
+ * 2. CsvReturnHistory : fichier date,WTI,BRENT,... (rendements ou prix),
+ *    lu au fil de l'eau, lignes illisibles ignorées et comptées
+ * 3. InMemoryReturnHistory : séries en mémoire (TimeSeriesSimulator),
+ *    alignées sur la date la plus récente
+ * 4. EwmaVolatilityFilter : résidus standardisés de la simulation filtrée
+ *
+ * MÉMOIRE (10 ans × 500 sous-jacents, blocs de 256 dates) :
+ * - historique complet : 2,520 × 500 × 8 octets = 10 Mo (jamais chargé)
+ * - bloc courant : 256 × 500 × 8 octets = 1 Mo
+ * - P&L du portefeuille : 2,520 doubles (un par date)
+ *
+ * USAGE TYPIQUE :
+ * CsvReturnHistory history("history_10y.csv", HistoryValues::PRICES);
+ * if (!history.is_open()) return;
+ * auto result = calculator.calculate_historical_risk(positions, market_data, history,
+ *     HistoricalConfig{.method = HistoricalMethod::FILTERED_HISTORICAL});
+ * if (result.has_value()) std::cout << "HS VaR 99%: " << result.value().var_99 << "\n";
+ */
@@ -0,0 +1,272 @@
+/*
+ * implied_volatility.hpp - Volatilité implicite par lots
+ *
+ * Le pricer donne un prix à partir d'une vol ; pour construire les vols de
+ * MarketData à partir d'une chaîne d'options cotées, il faut l'inverse :
+ * quelle vol σ redonne le prix observé ?
+ *
+ * Pas de formule fermée : on résout b(σ) = prix. La bissection par strike
+ * demande ~50 évaluations ; ici, à la manière de "Let's Be Rational"
+ * (Jäckel) :
+ * - passage à l'option HORS de la monnaie (parité call-put) : plus de
+ *   soustraction de deux grands nombres pour les options dans la monnaie
+ * - point de départ rationnel de part et d'autre du point d'inflexion
+ *   s_c = √(2|ln(F/K)|) de b en s = σ√T
+ * - quelques pas de Householder d'ordre 3 (dérivées analytiques), gardés
+ *   par un encadrement [lo, hi] (pas hors de l'encadrement ou vega
+ *   négligeable → bissection)
+ * - itérations vectorisées sur toute une tranche de la chaîne (même
+ *   noyau sans branchement que BlackScholesModel::price_and_greeks_batch)
+ *
+ * Modèle de Black sur le FORWARD : prix = D × w × (F N(w d1) - K N(w d2)).
+ * Black-Scholes s'y ramène avec F = S e^{rT}, D = e^{-rT}
+ * (BlackScholesModel::implied_volatility_batch).
+ */
+
+#pragma once
+
+#include "math_utils.hpp"  // fast_log, fast_exp, fast_norm_cdf, norm_inv
+#include <span>            // Entrées/sorties par lots
+#include <array>           // Tranches locales
+#include <cstdint>         // uint8_t
+#include <cmath>           // sqrt, abs
+#include <limits>          // infinity
+#include <algorithm>       // min, max
+
+// ===== STATUT DE L'INVERSION (un par option) =====
+enum class ImpliedVolStatus : uint8_t {
+    CONVERGED,        // Prix retrouvé à la tolérance près
+    BELOW_INTRINSIC,  // Prix ≤ valeur intrinsèque (actualisée) : aucune vol ne convient
+    NO_TIME_VALUE,    // Valeur temps sous la résolution du prix (très dans la monnaie,
+                      // échéance courte) : le prix ne contient aucune information de vol
+    ABOVE_MAXIMUM,    // Prix ≥ borne haute (call : D×F, put : D×K)
+    INVALID_INPUT,    // F, K, T ou D ≤ 0, prix non fini
+    NOT_CONVERGED     // Tolérance non atteinte en MAX_ITERATIONS pas (vol = dernier itéré)
+};
+
+// ===== SOLVEUR =====
+class ImpliedVolatility {
+public:
+    static constexpr size_t BATCH_CHUNK = 64;           // Options par tranche
+    static constexpr int MAX_ITERATIONS = 12;           // Pas de Householder au plus (2 à 4 en pratique)
+    static constexpr double RELATIVE_TOLERANCE = 1e-12; // Sur la valeur temps hors de la monnaie...
+    static constexpr double ABSOLUTE_TOLERANCE = 1e-15; // ... + plancher × (F + K) (arrondi du pricer)
+    /*
+     * RÉSOLUTION DE LA VALEUR TEMPS (× (F + K))
+     * Un prix dans la monnaie porte une erreur d'arrondi de quelques ε × (F + K),
+     * que la parité reporte telle quelle sur la valeur temps hors de la monnaie.
+     * En dessous de ~4500 ε, cette erreur domine : inverser le prix revient à
+     * inverser le bruit (ex : S = 100, K = 54, T = 17 jours, σ = 9.5% → vol
+     * "convergée" de 34%). Au-dessus, l'erreur de vol d'un aller-retour avec
+     * price_and_greeks_batch reste sous 3e-6 (sous 1e-6 pour 99.99% des
+     * options). 1e-12 × (F + K) reste très en dessous de tout pas de cotation.
+     */
+    static constexpr double TIME_VALUE_RESOLUTION = 1e-12;
+
+    /*
+     * MODÈLE DE BLACK (FORWARD)
+     * =========================
+     * Option i = (F[i], K[i], T[i], discount[i], price[i], is_call[i]) → vol[i]
+     * price = prix ACTUALISÉ observé, discount = facteur d'actualisation D
+     * Options en échec : vol = 0 (sauf NOT_CONVERGED), status renseigné si fourni
+     */
+    static void black_batch(
+        std::span<const double> F,
+        std::span<const double> K,
+        std::span<const double> T,
+        std::span<const double> discount,
+        std::span<const double> price,
+        std::span<const uint8_t> is_call,
+        std::span<double> vol,
+        std::span<ImpliedVolStatus> status = {}) noexcept {
+
+        const size_t n = F.size();
+        for (size_t begin = 0; begin < n; begin += BATCH_CHUNK) {
+            const size_t m = std::min(BATCH_CHUNK, n - begin);
+            solve_chunk(F.subspan(begin, m), K.subspan(begin, m), T.subspan(begin, m),
+                        discount.subspan(begin, m), price.subspan(begin, m), is_call.subspan(begin, m),
+                        vol.subspan(begin, m), status.empty() ? status : status.subspan(begin, m));
+        }
+    }
+
+private:
+    /*
+     * TRANCHE DE m ≤ BATCH_CHUNK OPTIONS
+     * Notations : x = ln(F/K), s = σ√T, q = valeur temps non actualisée,
+     * w = +1 (call) / -1 (put) de l'option HORS de la monnaie équivalente
+     */
+    static void solve_chunk(
+        std::span<const double> F,
+        std::span<const double> K,
+        std::span<const double> T,
+        std::span<const double> discount,
+        std::span<const double> price,
+        std::span<const uint8_t> is_call,
+        std::span<double> vol,
+        std::span<ImpliedVolStatus> status) noexcept {
+
+        constexpr double INF = std::numeric_limits<double>::infinity();
+        const size_t m = F.size();
+        std::array<double, BATCH_CHUNK> f, k, x, w, q, tolerance, s, lo, hi, residual;
+        std::array<ImpliedVolStatus, BATCH_CHUNK> lane_status;
+
+        /*
+         * 1. NORMALISATION ET BORNES (parité call-put non actualisée : C - P = F - K)
+         *    Options sans solution : entrées neutres (F = K = 1, q = 0.2),
+         *    résultat écrasé à la fin
+         */
+        // Call : +1, Put : -1, converti à part (octets et doubles dans une même boucle bloquent la vectorisation)
+        std::array<double, BATCH_CHUNK> sign, code;  // code = ImpliedVolStatus en double, même raison
+        for (size_t j = 0; j < m; ++j) sign[j] = is_call[j] ? 1.0 : -1.0;
+
+        for (size_t j = 0; j < m; ++j) {
+            const bool finite = price[j] - price[j] == 0.0;  // Faux pour NaN et ±∞
+            const bool ok = (F[j] > 0.0) & (K[j] > 0.0) & (T[j] > 0.0) & (discount[j] > 0.0) & finite;
+            const double forward = ok ? F[j] : 1.0;
+            const double strike = ok ? K[j] : 1.0;
+            const double undiscounted = ok ? price[j] / discount[j] : 0.0;
+            const double intrinsic = std::max(sign[j] * (forward - strike), 0.0);
+            const double otm_sign = strike >= forward ? 1.0 : -1.0;  // Call hors de la monnaie si K ≥ F
+            const double upper = otm_sign > 0.0 ? forward : strike;   // b(s) → F (call) ou K (put)
+            const double time_value = undiscounted - intrinsic;
+
+            const bool below = !(time_value > 0.0);
+            const bool unresolved = !(time_value > TIME_VALUE_RESOLUTION * (forward + strike));
+            const bool above = !(time_value < upper);
+            code[j] = !ok ? static_cast<double>(ImpliedVolStatus::INVALID_INPUT)
+                    : below ? static_cast<double>(ImpliedVolStatus::BELOW_INTRINSIC)
+                    : unresolved ? static_cast<double>(ImpliedVolStatus::NO_TIME_VALUE)
+                    : above ? static_cast<double>(ImpliedVolStatus::ABOVE_MAXIMUM)
+                    : static_cast<double>(ImpliedVolStatus::CONVERGED);
+            const bool solvable = ok & !unresolved & !above;
+
+            f[j] = solvable ? forward : 1.0;
+            k[j] = solvable ? strike : 1.0;
+            x[j] = solvable ? FastMath::fast_log(forward / strike) : 0.0;
+            w[j] = solvable ? otm_sign : 1.0;
+            q[j] = solvable ? time_value : 0.2;
+            tolerance[j] = RELATIVE_TOLERANCE * q[j] + ABSOLUTE_TOLERANCE * (f[j] + k[j]);
+        }
+        for (size_t j = 0; j < m; ++j) lane_status[j] = static_cast<ImpliedVolStatus>(static_cast<uint8_t>(code[j]));
+
+        /*
+         * 2. POINT DE DÉPART (de part et d'autre du point d'inflexion s_c)
+         *    b_c = b(s_c)
+         *    - q ≤ b_c (branche basse, b ≈ b_c e^{-x²/2s² + x²/2s_c²}) :
+         *          1/s² = 1/s_c² + 2 ln(b_c/q) / x²
+         *    - q > b_c (branche haute, u - b ≈ (u - b_c) N(-s/2) / N(-s_c/2)) :
+         *          s = -2 N⁻¹((u - q) / (u - b_c) × N(-s_c/2))      (exact à la monnaie)
+         *    u = borne haute (F ou K) ; s = s_c quand q = b_c dans les deux cas
+         *    s_c borne aussi l'encadrement initial (b est croissante en s)
+         */
+        std::array<double, BATCH_CHUNK> tail;  // Branche haute : argument de N⁻¹
+        for (size_t j = 0; j < m; ++j) {
+            const double s_c = std::sqrt(2.0 * std::abs(x[j]));
+            const bool at_the_money = !(s_c > 0.0);
+            const double b_c = at_the_money ? 0.0 : otm_black(f[j], k[j], x[j], w[j], at_the_money ? 1.0 : s_c);
+            const double upper = w[j] > 0.0 ? f[j] : k[j];
+            const bool low = q[j] <= b_c;  // Jamais à la monnaie (q > 0 = b_c)
+
+            const double s_c_safe = at_the_money ? 1.0 : s_c;
+            const double x2_safe = at_the_money ? 1.0 : x[j] * x[j];
+            const double ratio = low ? b_c / q[j] : 1.0;
+            const double s_low = 1.0 / std::sqrt(1.0 / (s_c_safe * s_c_safe) + 2.0 * FastMath::fast_log(ratio) / x2_safe);
+
+            tail[j] = (upper - q[j]) / (upper - b_c) * FastMath::fast_norm_cdf(-0.5 * s_c);
+            s[j] = low ? s_low : 0.0;
+            lo[j] = low ? 0.0 : s_c;  // b croissante : racine dans ]0, s_c] ou [s_c, ∞[
+            hi[j] = low ? s_c : INF;
+        }
+        // N⁻¹ (branché, non vectorisable) pour les seules options de la branche haute
+        for (size_t j = 0; j < m; ++j) {
+            if (s[j] == 0.0) s[j] = -2.0 * FastMath::norm_inv(tail[j]);
+            if (!(std::isfinite(s[j]) && s[j] > 0.0)) s[j] = std::max(std::sqrt(2.0 * std::abs(x[j])), 0.1);
+        }
+
+        /*
+         * 3. PAS DE HOUSEHOLDER D'ORDRE 3 (boucle vectorisée)
+         *    b'(s) = F φ(d1)                       (vega en s, call et put)
+         *    h2 = b''/b'  = x²/s³ - s/4
+         *    h3 = b'''/b' = h2² - 3x²/s⁴ - 1/4
+         *    ν = -(b - q) / b'   s ← s + ν (1 + h2 ν/2) / (1 + h2 ν + h3 ν²/6)
+         *    Pas hors de ]lo, hi[ (ou vega nulle) → bissection (ou doublement si hi = ∞)
+         *    Options déjà dans la tolérance : s figé (le résidu final est bien celui de s)
+         */
+        for (int iteration = 0; iteration < MAX_ITERATIONS; ++iteration) {
+            size_t n_open = 0;  // Options encore hors tolérance (réduction entière : vectorisable)
+            for (size_t j = 0; j < m; ++j) {
+                const double sj = s[j];
+                const double d1 = x[j] / sj + 0.5 * sj;
+                const double d2 = d1 - sj;
+                const double b = w[j] * (f[j] * FastMath::fast_norm_cdf(w[j] * d1)
+                                       - k[j] * FastMath::fast_norm_cdf(w[j] * d2));
+                const double vega = f[j] * FastMath::INV_SQRT_2PI * FastMath::fast_exp(-0.5 * d1 * d1);
+                const double diff = b - q[j];
+                const bool open = std::abs(diff) > tolerance[j];
+                residual[j] = diff;
+                n_open += open ? 1 : 0;
+
+                // Lectures puis écritures inconditionnelles (pas de store masqué : boucle vectorisable)
+                const double lo_j = diff < 0.0 ? sj : lo[j];
+                const double hi_j = diff > 0.0 ? sj : hi[j];
+                lo[j] = lo_j;
+                hi[j] = hi_j;
+
+                const double x2 = x[j] * x[j];
+                const double h2 = x2 / (sj * sj * sj) - 0.25 * sj;
+                const double h3 = h2 * h2 - 3.0 * x2 / (sj * sj * sj * sj) - 0.25;
+                const double nu = -diff / std::max(vega, std::numeric_limits<double>::min());
+                const double step = nu * (1.0 + 0.5 * h2 * nu) / (1.0 + h2 * nu + h3 * nu * nu / 6.0);
+                const double candidate = sj + step;
+
+                const bool inside = (candidate > lo_j) & (candidate < hi_j) & (vega > 0.0);
+                const double fallback = hi_j < INF ? 0.5 * (lo_j + hi_j) : 2.0 * sj;
+                const double next = inside ? candidate : fallback;
+                s[j] = open ? next : sj;  // Option convergée : s figé
+            }
+            if (n_open == 0) break;
+        }
+
+        /*
+         * 4. RÉSULTATS : σ = s / √T
+         */
+        for (size_t j = 0; j < m; ++j) {
+            ImpliedVolStatus lane = lane_status[j];
+            if (lane == ImpliedVolStatus::CONVERGED && std::abs(residual[j]) > tolerance[j]) {
+                lane = ImpliedVolStatus::NOT_CONVERGED;
+            }
+            const bool solved = lane == ImpliedVolStatus::CONVERGED || lane == ImpliedVolStatus::NOT_CONVERGED;
+            vol[j] = solved ? s[j] / std::sqrt(T[j]) : 0.0;
+            if (!status.empty()) status[j] = lane;
+        }
+    }
+
+    // Prix de Black non actualisé de l'option hors de la monnaie (même CDF que le pricer)
+    [[nodiscard]] static double otm_black(double f, double k, double x, double w, double s) noexcept {
+        const double d1 = x / s + 0.5 * s;
+        const double d2 = d1 - s;
+        return w * (f * FastMath::fast_norm_cdf(w * d1) - k * FastMath::fast_norm_cdf(w * d2));
+    }
+};
+
+/*
+ * RÉSUMÉ DE CE FICHIER :
+ * ======================
+ *
+ * 1. ImpliedVolStatus : convergé / sous l'intrinsèque / valeur temps sous la
+ *    résolution du prix / au-dessus du maximum / entrée invalide / non convergé
+ * 2. ImpliedVolatility::black_batch : inversion du modèle de Black (forward F,
+ *    actualisation D) pour toute une chaîne, par tranches de 64 options
+ *
+ * ÉTAPES PAR TRANCHE :
+ * - option hors de la monnaie équivalente (parité), bornes d'arbitrage,
+ *   valeur temps comparée à la résolution du prix (TIME_VALUE_RESOLUTION)
+ * - point de départ rationnel (branches basse/haute autour de s_c)
+ * - pas de Householder d'ordre 3 encadrés, arrêt quand toute la tranche
+ *   est dans la tolérance
+ *
+ * USAGE TYPIQUE :
+ * // Black-Scholes (spot, taux) : voir BlackScholesModel::implied_volatility_batch
+ * ImpliedVolatility::black_batch(forwards, strikes, maturities, discounts, market_prices,
+ *                                is_call, implied_vols, statuses);
+ */
@@ -27,8 +27,11 @@
 #include "types.hpp"              // Types de base et concepts
 #include "math_utils.hpp"         // Utilitaires mathématiques
 #include "pricing_models.hpp"     // Modèle Black-Scholes
+#include "black76.hpp"            // Options sur futures (courbe forward)
 #include "monte_carlo.hpp"        // Simulations Monte Carlo
 #include "portfolio_calculator.hpp" // Calculs de risque portefeuille
+#include "risk_session.hpp"       // Mises à jour incrémentales du risque
+#include "timeseries_simulator.hpp" // Historiques synthétiques (VaR historique)
 
 // ===== CLASSE DE BENCHMARK DE PERFORMANCE =====
 /*
@@ -131,7 +134,12 @@ public:
                 {"GOLD", 0.20},       // 20% volatilité (métal précieux plus stable)
                 {"SILVER", 0.30}      // 30% volatilité (plus volatil que l'or)
             },
-            .risk_free_rate = 0.05    // Taux sans risque 5% (typique environnement normal)
+            .risk_free_rate = 0.05,   // Taux sans risque 5% (typique environnement normal)
+            .correlations = {
+                {"WTI", {{"BRENT", 0.92}, {"NATGAS", 0.30}}},  // Deux bruts : quasi le même marché
+                {"BRENT", {{"NATGAS", 0.28}}},
+                {"GOLD", {{"SILVER", 0.80}}}                   // Métaux précieux liés entre eux
+            }
         };
         /*
          * Designated initializers C++20 (.spot_prices = ...)
@@ -328,6 +336,14 @@ void demonstrate_basic_pricing() {
      * - Theta ≈ -10 → Option perd 10¢ par jour qui passe
      */
     
+    // Ordre supérieur : mêmes d1, d2, φ(d1) → rho, vanna, volga, charm, speed
+    const auto extended = BlackScholesModel::calculate_extended_greeks(S, K, T, r, vol, true);
+    std::cout << "  Rho:   " << std::fixed << std::setprecision(4) << extended.rho << "\n";
+    std::cout << "  Vanna: " << std::fixed << std::setprecision(4) << extended.vanna << "\n";
+    std::cout << "  Volga: " << std::fixed << std::setprecision(4) << extended.volga << "\n";
+    std::cout << "  Charm: " << std::fixed << std::setprecision(6) << extended.charm << "\n";
+    std::cout << "  Speed: " << std::fixed << std::setprecision(6) << extended.speed << "\n";
+    
     /*
      * VÉRIFICATION PUT-CALL PARITY
      * =============================
@@ -346,6 +362,98 @@ void demonstrate_basic_pricing() {
      * std::scientific = notation scientifique (1.23e-15)
      * Résultat attendu : ~1e-15 (erreur d'arrondi machine)
      */
+    
+    // Call et put déjà pricés plus haut : relus dans le cache (clé distincte par type d'option)
+    const auto cache = bs_model.cache_stats();
+    std::cout << "Pricing cache: " << cache.hits << " hits, " << cache.misses << " misses, "
+              << cache.size << "/" << cache.capacity << " entries\n";
+    
+    /*
+     * VOLATILITÉ IMPLICITE D'UNE CHAÎNE
+     * ==================================
+     * Prix "de marché" générés avec un smile (vol plus haute loin de la monnaie),
+     * puis inversés d'un coup : on doit retrouver le smile
+     */
+    std::vector<double> chain_strikes, chain_vols, chain_prices;
+    for (double strike = 80.0; strike <= 120.0; strike += 10.0) {
+        const double moneyness = std::log(strike / S);
+        chain_strikes.push_back(strike);
+        chain_vols.push_back(vol + 0.5 * moneyness * moneyness);
+        chain_prices.push_back(BlackScholesModel::price_uncached(S, strike, T, r, chain_vols.back(), true).value());
+    }
+    const size_t n_chain = chain_strikes.size();
+    const std::vector<double> chain_spots(n_chain, S), chain_maturities(n_chain, T), chain_rates(n_chain, r);
+    const std::vector<uint8_t> chain_calls(n_chain, 1);
+    std::vector<double> implied(n_chain);
+    std::vector<ImpliedVolStatus> statuses(n_chain);
+    BlackScholesModel::implied_volatility_batch(chain_spots, chain_strikes, chain_maturities, chain_rates,
+                                                chain_prices, chain_calls, implied, statuses);
+    
+    std::cout << "Implied vol smile (strike: input → implied):\n" << std::fixed << std::setprecision(4);
+    for (size_t i = 0; i < n_chain; ++i) {
+        std::cout << "  " << chain_strikes[i] << ": " << chain_vols[i] << " → " << implied[i]
+                  << (statuses[i] == ImpliedVolStatus::CONVERGED ? "" : " (not converged)") << "\n";
+    }
+}
+
+/*
+ * DÉMONSTRATION OPTIONS SUR FUTURES (BLACK-76)
+ * =============================================
+ * Courbe WTI en backwardation : le spot reporté au taux sans risque
+ * surestime le future livré à l'échéance de l'option
+ */
+void demonstrate_futures_options() {
+    std::cout << "\n=== FUTURES OPTIONS (BLACK-76) ===\n";
+    
+    const std::vector<FutureQuote> wti_quotes = {
+        {"WTI_M1", 0.08, 78.00, 77.98, 78.02, 250000},
+        {"WTI_M3", 0.25, 76.50, 76.48, 76.52, 120000},
+        {"WTI_M6", 0.50, 74.80, 74.77, 74.83, 80000},
+        {"WTI_M12", 1.00, 72.40, 72.36, 72.44, 40000}
+    };
+    FuturesMarketData market{
+        .curves = {{"WTI", ForwardCurveBuilder::build_from_futures("WTI", wti_quotes, InterpolationType::LINEAR)}},
+        .volatilities = {{"WTI", 0.35}},
+        .risk_free_rate = 0.05
+    };
+    const ForwardCurve& wti = market.curves.at("WTI");
+    
+    // Même option : Black-Scholes sur le spot (premier future) contre Black-76 sur la courbe
+    const double K = 75.0, T = 0.75;
+    const auto on_spot = BlackScholesModel::price_uncached(wti.get_forward(0.08), K, T, market.risk_free_rate, 0.35, true);
+    const auto on_curve = Black76Model::price(wti, K, T, market.risk_free_rate, 0.35, true);
+    if (on_spot.has_value() && on_curve.has_value()) {
+        std::cout << std::fixed << std::setprecision(4)
+                  << "9M 75 call, F(9M) = " << wti.get_forward(T) << "\n"
+                  << "  Black-Scholes on spot: " << on_spot.value() << "\n"
+                  << "  Black-76 on curve:     " << on_curve.value() << "\n";
+    }
+    
+    // Book entier : une lecture de courbe par maturité distincte (3 ici pour 6 positions)
+    const std::vector<Position> book = {
+        {"FO_1", "WTI", 1000, 75.0, 0.25, true},
+        {"FO_2", "WTI", -500, 70.0, 0.25, false},
+        {"FO_3", "WTI", 2000, 80.0, 0.50, true},
+        {"FO_4", "WTI", -1500, 72.0, 0.50, false},
+        {"FO_5", "WTI", 800, 75.0, 1.00, true},
+        {"FO_6", "WTI", 600, 68.0, 1.00, false}
+    };
+    std::vector<double> prices(book.size()), deltas(book.size());
+    Black76Model::price_book(book, market, {.price = prices, .delta = deltas});
+    
+    double value = 0.0, futures_delta = 0.0;
+    for (size_t i = 0; i < book.size(); ++i) {
+        value += book[i].notional * prices[i];
+        futures_delta += book[i].notional * deltas[i];
+    }
+    std::cout << std::setprecision(0) << "Futures option book: value $" << value
+              << ", futures delta " << futures_delta << "\n";
+    
+    // Prix de marché → vol Black (même courbe, même actualisation)
+    if (on_curve.has_value()) {
+        const auto vol = Black76Model::implied_volatility(wti, on_curve.value(), K, T, market.risk_free_rate, true);
+        if (vol.has_value()) std::cout << std::setprecision(4) << "Implied Black vol: " << vol.value() << "\n";
+    }
 }
 
 /*
@@ -421,6 +529,28 @@ void demonstrate_monte_carlo() {
      * ES toujours > VaR (par définition mathématique)
      */
     
+    /*
+     * STRUCTURE PAR TERME : VaR/ES SUR PLUSIEURS HORIZONS
+     * ===================================================
+     * Un seul jeu de trajectoires sur 1 an, VaR 99% à 1 jour, 1 semaine,
+     * 1 mois, 1 trimestre et 1 an (pas de matrice trajectoires × pas)
+     */
+    const std::array horizons = {size_t{1}, size_t{5}, size_t{21}, size_t{63}, size_t{252}};
+    const std::array term_levels = {0.99};
+    const auto term_structure = mc_engine.calculate_var_es_term_structure(
+        S0, mu, sigma, 1.0, 252, n_sims, horizons, term_levels);
+    
+    std::cout << "\nVaR/ES 99% Term Structure:\n";
+    for (const auto& horizon : term_structure) {
+        const auto [var, es] = horizon.var_es[0];
+        std::cout << "  " << std::setw(3) << horizon.step << " days - ";
+        std::cout << "VaR: " << std::setprecision(4) << var << ", ";
+        std::cout << "ES: " << std::setprecision(4) << es << "\n";
+    }
+    /*
+     * VaR(h) ≈ VaR(1 jour) × √h tant que la dérive reste négligeable
+     */
+    
     /*
      * STATISTIQUES DE BASE DES RENDEMENTS
      * ====================================
@@ -479,7 +609,8 @@ void demonstrate_portfolio_risk() {
     PortfolioRiskCalculator::MarketData market_data{
         .spot_prices = {{"WTI", 75.0}, {"BRENT", 78.0}, {"NATGAS", 3.5}},
         .volatilities = {{"WTI", 0.35}, {"BRENT", 0.33}, {"NATGAS", 0.60}},
-        .risk_free_rate = 0.05
+        .risk_free_rate = 0.05,
+        .correlations = {{"WTI", {{"BRENT", 0.92}, {"NATGAS", 0.30}}}, {"BRENT", {{"NATGAS", 0.28}}}}
     };
     /*
      * NOTES MARCHÉ :
@@ -529,6 +660,16 @@ void demonstrate_portfolio_risk() {
                       << metrics.vega_by_underlying.at(underlying) << "\n";
             std::cout << "    Theta: " << std::fixed << std::setprecision(0) 
                       << metrics.theta_by_underlying.at(underlying) << "\n";
+            std::cout << "    Rho:   " << std::fixed << std::setprecision(0)
+                      << metrics.rho_by_underlying.at(underlying) << "\n";
+            std::cout << "    Vanna: " << std::fixed << std::setprecision(0)
+                      << metrics.vanna_by_underlying.at(underlying) << "\n";
+            std::cout << "    Volga: " << std::fixed << std::setprecision(0)
+                      << metrics.volga_by_underlying.at(underlying) << "\n";
+            std::cout << "    Charm: " << std::fixed << std::setprecision(0)
+                      << metrics.charm_by_underlying.at(underlying) << "\n";
+            std::cout << "    Speed: " << std::fixed << std::setprecision(4)
+                      << metrics.speed_by_underlying.at(underlying) << "\n";
         }
     }
     /*
@@ -548,6 +689,7 @@ void demonstrate_portfolio_risk() {
      * Compliance réglementaire et limites internes
      */
     std::cout << "\nRisk Measures:\n";
+    if (metrics.var_error) std::cout << "  VaR/ES not computed: correlation matrix is not positive semi-definite\n";
     std::cout << "  95% VaR:  " << std::fixed << std::setprecision(4) << metrics.var_95 << "\n";
     std::cout << "  95% ES:   " << std::fixed << std::setprecision(4) << metrics.es_95 << "\n";
     std::cout << "  99% VaR:  " << std::fixed << std::setprecision(4) << metrics.var_99 << "\n";
@@ -563,6 +705,112 @@ void demonstrate_portfolio_risk() {
      * VaR et ES croissants par construction (queue de plus en plus mince)
      */
     
+    /*
+     * VAR DELTA-GAMMA (MODE INTRADAY)
+     * ===============================
+     * Même calcul, P&L approché par les Greeks + contrôle sur 500 scénarios réévalués
+     * Pas de comparaison avec la VaR complète ci-dessus : chaque appel tire
+     * ses propres scénarios (nouveau flux), l'écart mêlerait bruit
+     * d'échantillonnage et erreur d'approximation. L'erreur est mesurée
+     * par var_approximation_error, sur les MÊMES scénarios
+     */
+    const auto dg_metrics = calculator.calculate_portfolio_risk(positions, market_data,
+        RiskConfig{.var_method = VarMethod::DELTA_GAMMA, .error_sample_size = 500});
+    const auto& dg_error = dg_metrics.var_approximation_error;
+    std::cout << "\nDelta-Gamma VaR:\n";
+    std::cout << "  99% VaR:  " << std::fixed << std::setprecision(4) << dg_metrics.var_99 << "\n";
+    std::cout << "  Calculation Time: " << dg_metrics.calculation_time_us << " μs\n";
+    std::cout << "  Approx. error on " << dg_error.n_sampled << " scenarios: rms "
+              << std::scientific << std::setprecision(2) << dg_error.rms_error
+              << ", max " << dg_error.max_abs_error
+              << ", tail max " << dg_error.tail_max_abs_error << std::fixed << "\n";
+    /*
+     * Erreurs en fraction de la valeur du portefeuille (mêmes unités que la VaR)
+     * Horizon 1 jour : chocs petits → erreur négligeable devant la VaR
+     */
+
+    /*
+     * VAR PAR PROXY DE CHEBYSHEV
+     * ==========================
+     * Un polynôme par sous-jacent, ajusté sur quelques prix par position
+     * Comme pour le delta-gamma : erreur mesurée sur les mêmes scénarios
+     * (500 réévalués complètement), pas par écart à la VaR complète ci-dessus
+     */
+    const auto proxy_metrics = calculator.calculate_portfolio_risk(positions, market_data,
+        RiskConfig{.var_method = VarMethod::CHEBYSHEV_PROXY, .error_sample_size = 500});
+    const auto& proxy_fit = proxy_metrics.proxy_fit;
+    const auto& proxy_error = proxy_metrics.var_approximation_error;
+    std::cout << "\nChebyshev Proxy VaR:\n";
+    std::cout << "  99% VaR:  " << std::fixed << std::setprecision(4) << proxy_metrics.var_99 << "\n";
+    std::cout << "  Calculation Time: " << proxy_metrics.calculation_time_us << " μs\n";
+    std::cout << "  Fit: " << proxy_fit.pricer_calls << " pricer calls, degree " << proxy_fit.max_degree
+              << ", " << proxy_fit.n_exact_positions << " exact positions, hold-out error (fraction of gross exposure) "
+              << std::scientific << std::setprecision(2) << proxy_fit.holdout_error << std::fixed << "\n";
+    std::cout << "  Approx. error on " << proxy_error.n_sampled << " scenarios: rms "
+              << std::scientific << std::setprecision(2) << proxy_error.rms_error
+              << ", max " << proxy_error.max_abs_error
+              << ", tail max " << proxy_error.tail_max_abs_error << std::fixed << "\n";
+
+    /*
+     * VAR HISTORIQUE (SIMPLE ET FILTRÉE)
+     * ==================================
+     * 10 ans de prix quotidiens synthétiques rejoués sur le portefeuille
+     */
+    TimeSeriesSimulator history_simulator{2024};
+    TimeSeriesParams wti_params;
+    wti_params.n_periods = 2'520;
+    wti_params.base_volatility = 0.35;
+    TimeSeriesParams brent_params = wti_params;
+    brent_params.initial_price = 78.0;
+    brent_params.base_volatility = 0.33;
+    TimeSeriesParams natgas_params = wti_params;
+    natgas_params.initial_price = 3.5;
+    natgas_params.base_volatility = 0.60;
+    auto [wti_prices, brent_prices] = history_simulator.generate_correlated_pair(wti_params, brent_params, 0.92);
+    auto history = InMemoryReturnHistory::from_prices(
+        {"WTI", "BRENT", "NATGAS"}, {wti_prices, brent_prices, history_simulator.generate_gbm(natgas_params)});
+    
+    std::cout << "\nHistorical Simulation (" << history.n_dates() << " days):\n";
+    for (const auto method : {HistoricalMethod::HISTORICAL, HistoricalMethod::FILTERED_HISTORICAL}) {
+        const auto historical = calculator.calculate_historical_risk(positions, market_data, history,
+                                                                     HistoricalConfig{.method = method});
+        if (!historical.has_value()) continue;
+        std::cout << (method == HistoricalMethod::HISTORICAL ? "  HS  " : "  FHS ")
+                  << "99% VaR: " << std::fixed << std::setprecision(4) << historical.value().var_99
+                  << "  99% ES: " << historical.value().es_99
+                  << "  (" << historical.value().calculation_time_us << " μs)\n";
+    }
+
+    /*
+     * ATTRIBUTION DE LA VaR/ES PAR POSITION
+     * =====================================
+     * Qui porte la queue à 99% ? (Σ Component ES = ES du portefeuille)
+     */
+    const auto attributed = calculator.calculate_portfolio_risk(positions, market_data,
+        RiskConfig{.attribution = AttributionLevel::POSITION});
+    std::cout << "\nRisk Attribution (99%, ES " << std::setprecision(4) << attributed.attribution.es << "):\n";
+    for (const auto& contribution : attributed.attribution.contributions) {
+        std::cout << "  " << std::setw(14) << std::left << contribution.name << std::right
+                  << " Component ES: " << std::setw(8) << contribution.component_es
+                  << "  Incremental VaR: " << std::setw(8) << contribution.incremental_var
+                  << "  Marginal VaR: " << std::setw(7) << contribution.marginal_var << "\n";
+    }
+
+    /*
+     * SESSION INCRÉMENTALE
+     * ====================
+     * Un trader double son call WTI : seule la ligne du trade est repricée
+     */
+    RiskSession session(calculator, positions, market_data);
+    if (const auto amended = session.amend_position({"CALL_WTI_1", "WTI", 2'000'000, 80.0, 0.25, true});
+        amended.has_value()) {
+        std::cout << "\nIncremental Amendment (CALL_WTI_1 x2):\n";
+        std::cout << "  New position value: $" << std::fixed << std::setprecision(0) << amended.value() << "\n";
+        std::cout << "  WTI Delta: " << session.metrics().delta_by_underlying.at("WTI") << "\n";
+        std::cout << "  99% VaR:  " << std::setprecision(4) << session.metrics().var_99 << "\n";
+        std::cout << "  Update Time: " << session.metrics().calculation_time_us << " μs\n";
+    }
+    
     /*
      * STRESS TESTING
      * ==============
@@ -600,6 +848,30 @@ void demonstrate_portfolio_risk() {
      * Portefeuille "long bias" → profit si marchés montent
      * Asymétrie typique des positions longues en calls
      */
+    
+    /*
+     * SCÉNARIOS MULTI-FACTEURS
+     * ========================
+     * Chocs par sous-jacent sur spot, vol et taux ; P&L détaillé par sous-jacent
+     */
+    const std::vector<StressScenario> multi_factor_scenarios = {
+        {"Hormuz closure", {{"BRENT", StressFactor::SPOT, ShockType::RELATIVE, 0.40},
+                            {"WTI", StressFactor::SPOT, ShockType::RELATIVE, 0.30},
+                            {"BRENT", StressFactor::VOL, ShockType::ABSOLUTE, 0.15},
+                            {"WTI", StressFactor::VOL, ShockType::ABSOLUTE, 0.10}}},
+        {"Gas glut", {{"NATGAS", StressFactor::SPOT, ShockType::RELATIVE, -0.35},
+                      {"NATGAS", StressFactor::VOL, ShockType::RELATIVE, 0.50}}},
+        {"Rates +200bp", {{"", StressFactor::RATE, ShockType::ABSOLUTE, 0.02}}}
+    };
+    const auto stress = calculator.run_stress_scenarios(positions, market_data, multi_factor_scenarios);
+    std::cout << "  Multi-factor scenarios:\n";
+    for (size_t s = 0; s < stress.n_scenarios(); ++s) {
+        std::cout << "  " << stress.scenario_names[s] << ": $" << stress.total(s) << " (";
+        for (size_t u = 0; u < stress.n_underlyings(); ++u) {
+            std::cout << (u ? ", " : "") << stress.underlyings[u] << " $" << stress.at(s, u);
+        }
+        std::cout << ")\n";
+    }
 }
 
 
@@ -629,6 +901,7 @@ int main() {
         
         // 1. Concepts de base : pricing individuel
         demonstrate_basic_pricing();
+        demonstrate_futures_options();
         
         // 2. Techniques avancées : simulation Monte Carlo
         demonstrate_monte_carlo();
@@ -670,6 +943,7 @@ int main() {
          */
         std::cout << "\n=== VITOL ASSIGNMENT READY ===\n";
         std::cout << "✓ Black-Scholes pricing with Greeks\n";              // Pricing de base
+        std::cout << "✓ Black-76 futures options on forward curves\n";    // Options sur futures
         std::cout << "✓ Monte Carlo VaR/ES calculation\n";                 // Risk management
         std::cout << "✓ Portfolio risk aggregation\n";                    // Vue portefeuille
         std::cout << "✓ Stress testing framework\n";                      // Tests de résistance
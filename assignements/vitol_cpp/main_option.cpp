@@ -171,6 +171,30 @@ void demonstrate_monte_carlo_option_pricing() {
         }
     }
     
+    /*
+     * PRÉCISION CIBLE (ARRÊT ADAPTATIF)
+     * =================================
+     * Au lieu de deviner un nombre de simulations : on fixe une erreur
+     * standard cible, n_simulations n'est plus qu'un plafond
+     */
+    std::cout << "\n=== ADAPTIVE STOPPING (target SE = $0.01, budget 500K) ===\n";
+    
+    PricingOptions adaptive_options;
+    adaptive_options.control_variate = true;
+    adaptive_options.target_standard_error = 0.01;
+    
+    for (const auto& [option_type, name] : option_types) {
+        auto result = mc_pricer.calculate_option_price(option_type, S, K, T, r, vol, 500'000, adaptive_options);
+        
+        if (result.has_value()) {
+            std::cout << std::left << std::setw(22) << name << ": $"
+                      << std::fixed << std::setprecision(4) << result.value().option_value
+                      << " ± " << result.value().standard_error
+                      << " (" << result.value().monte_carlo_simulations << " paths"
+                      << (result.value().target_reached ? "" : ", budget exhausted") << ")\n";
+        }
+    }
+    
     /*
      * VALIDATION AVEC DIFFÉRENTS PARAMÈTRES DE MARCHÉ
      * ================================================
@@ -221,7 +245,9 @@ void demonstrate_monte_carlo_option_pricing() {
     std::cout << "• Use 50K-100K simulations for daily pricing\n";
     std::cout << "• Use 500K+ simulations for critical P&L calculations\n";
     std::cout << "• Monitor convergence for options near expiry\n";
-    std::cout << "• Consider variance reduction techniques for production\n";
+    std::cout << "• Enable variance reduction (PricingOptions: antithetic, control_variate, moment_matching)\n";
+    std::cout << "  to reach the same standard error with 5-50x fewer paths\n";
+    std::cout << "• Set target_standard_error / relative_tolerance instead of guessing a path count\n";
 }
 
 
@@ -7,11 +7,16 @@
 
 #pragma once  // Évite l'inclusion multiple
 
+#include "types.hpp"   // Pour expected<>, RiskError (factorisation de Cholesky)
 #include <cmath>       // Pour sqrt, log, exp, abs
 #include <numbers>     // Pour les constantes mathématiques (C++20)
 #include <span>        // Pour manipuler des tableaux de façon sûre (C++20)
 #include <algorithm>   // Pour std::transform
 #include <execution>   // Pour les algorithmes parallèles (pas utilisé ici)
+#include <bit>         // Pour std::bit_cast (manipulation des bits d'un double)
+#include <cstdint>     // Pour uint64_t
+#include <limits>      // Pour l'infini (norm_inv aux bornes)
+#include <vector>      // Pour le facteur de Cholesky
 
 // ===== CLASSE D'UTILITAIRES MATHÉMATIQUES RAPIDES =====
 /*
@@ -144,6 +149,260 @@ public:
          */
     }
 
+    /*
+     * NOYAUX "SIMD-FRIENDLY" : LOG ET SIN/COS SANS BRANCHEMENT
+     * ========================================================
+     * std::log / std::cos sont des appels de bibliothèque scalaires :
+     * une boucle qui les appelle ne peut PAS être vectorisée par le compilateur.
+     * 
+     * Ces versions n'utilisent que +, ×, ÷, √, des opérations sur les bits
+     * et des sélections (pas de if) → dans une boucle, GCC/Clang les compilent
+     * en AVX2 / AVX-512 avec -O3 -march=native, et en scalaire sinon.
+     * Précision : quelques ulps (≈ 1e-15 relatif), largement suffisant pour du Monte Carlo.
+     */
+    
+    /*
+     * LOGARITHME NATUREL RAPIDE (x > 0, x normalisé)
+     * ===============================================
+     * x = 2^e × m avec m ∈ [√½, √2)
+     * ln(x) = e × ln(2) + ln(m)
+     * ln(m) = 2 × atanh(s) = 2 × (s + s³/3 + s⁵/5 + ...) avec s = (m-1)/(m+1), |s| ≤ 0.172
+     */
+    [[nodiscard]] static double fast_log(double x) noexcept {
+        constexpr uint64_t ONE_BITS = 0x3FF0000000000000ull;           // bits de 1.0
+        constexpr uint64_t SQRT_HALF_BITS = 0x3FE6A09E667F3BCDull;     // bits de √½
+        constexpr uint64_t EXPONENT_MAGIC = 0x4330000000000000ull;     // bits de 2^52
+        constexpr double LN2_HI = 6.93147180369123816490e-01;          // ln(2) en deux morceaux
+        constexpr double LN2_LO = 1.90821492927058770002e-10;          // pour garder la précision
+        
+        /*
+         * EXTRACTION EXPOSANT / MANTISSE PAR MANIPULATION DE BITS
+         * =======================================================
+         * En décalant de (1 - √½) avant de lire l'exposant, la mantisse
+         * tombe directement dans [√½, √2) : pas de if, que des entiers non signés
+         */
+        const uint64_t bits = std::bit_cast<uint64_t>(x);
+        const uint64_t biased_exp = (bits + (ONE_BITS - SQRT_HALF_BITS)) >> 52;
+        const double m = std::bit_cast<double>(bits - (biased_exp << 52) + ONE_BITS);
+        // Conversion entier → double sans instruction de conversion (astuce 2^52)
+        const double e = std::bit_cast<double>(biased_exp | EXPONENT_MAGIC) - 0x1.0p52 - 1023.0;
+        
+        // Série atanh : polynôme en z = s², évalué par Horner
+        const double s = (m - 1.0) / (m + 1.0);
+        const double z = s * s;
+        const double poly = 1.0 + z * (1.0 / 3 + z * (1.0 / 5 + z * (1.0 / 7 + z * (1.0 / 9 + z * (1.0 / 11
+                          + z * (1.0 / 13 + z * (1.0 / 15 + z * (1.0 / 17 + z * (1.0 / 19 + z * (1.0 / 21))))))))));
+        
+        return e * LN2_HI + (e * LN2_LO + 2.0 * s * poly);
+    }
+    
+    /*
+     * SINUS ET COSINUS DE 2πu (u ∈ [0, 1))
+     * =====================================
+     * Réduction d'argument au quart de tour le plus proche :
+     * 2πu = q × π/2 + θ avec q ∈ {0..4} et θ ∈ [-π/4, π/4]
+     * Puis séries de Taylor (erreur < 1e-16 sur cet intervalle)
+     * et permutation/signe selon le quadrant q, par sélection.
+     */
+    static void fast_sincos_2pi(double u, double& sin_out, double& cos_out) noexcept {
+        constexpr double ROUND_MAGIC = 0x1.8p52;  // x + 1.5×2^52 arrondit x à l'entier le plus proche
+        
+        /*
+         * ARRONDI SANS std::floor (qui bloque la vectorisation avec GCC)
+         * Après l'ajout de ROUND_MAGIC, l'entier q est lisible dans les bits bas
+         */
+        const double t = 4.0 * u;
+        const double shifted = t + ROUND_MAGIC;
+        const double q = shifted - ROUND_MAGIC;                       // Quadrant le plus proche
+        const uint64_t k = std::bit_cast<uint64_t>(shifted);         // q dans les bits bas
+        const double theta = (t - q) * (std::numbers::pi / 2.0);      // Angle résiduel
+        const double z = theta * theta;
+        
+        const double sin_t = theta * (1.0 + z * (-1.0 / 6 + z * (1.0 / 120 + z * (-1.0 / 5040 + z * (1.0 / 362880
+                           + z * (-1.0 / 39916800 + z * (1.0 / 6227020800 + z * (-1.0 / 1307674368000))))))));
+        const double cos_t = 1.0 + z * (-0.5 + z * (1.0 / 24 + z * (-1.0 / 720 + z * (1.0 / 40320
+                           + z * (-1.0 / 3628800 + z * (1.0 / 479001600 + z * (-1.0 / 87178291200
+                           + z * (1.0 / 20922789888000))))))));
+        
+        /*
+         * QUADRANTS : sin(qπ/2 + θ), cos(qπ/2 + θ)
+         * q=0 : ( sinθ,  cosθ)    q=1 : ( cosθ, -sinθ)
+         * q=2 : (-sinθ, -cosθ)    q=3 : (-cosθ,  sinθ)    q=4 ≡ q=0
+         * Sélection et signe par masques de bits : aucun test, aucun branchement
+         */
+        const uint64_t odd_mask = uint64_t{0} - (k & 1);               // Tout à 1 si q impair
+        const uint64_t sin_sign = ((k >> 1) & 1) << 63;                 // Négatif pour q ∈ {2,3}
+        const uint64_t cos_sign = (((k + 1) >> 1) & 1) << 63;           // Négatif pour q ∈ {1,2}
+        const uint64_t sin_bits = std::bit_cast<uint64_t>(sin_t);
+        const uint64_t cos_bits = std::bit_cast<uint64_t>(cos_t);
+        
+        sin_out = std::bit_cast<double>(((cos_bits & odd_mask) | (sin_bits & ~odd_mask)) ^ sin_sign);
+        cos_out = std::bit_cast<double>(((sin_bits & odd_mask) | (cos_bits & ~odd_mask)) ^ cos_sign);
+    }
+
+    /*
+     * EXPONENTIELLE RAPIDE (x ∈ [-708, 709], bornée au-delà)
+     * ======================================================
+     * x = n × ln(2) + r avec n entier et |r| ≤ ln(2)/2
+     * exp(x) = 2^n × exp(r), exp(r) par Taylor (ordre 13, erreur < 1e-17)
+     * 2^n est fabriqué directement dans les bits de l'exposant
+     */
+    [[nodiscard]] static double fast_exp(double x) noexcept {
+        constexpr double LOG2E = 1.4426950408889634073599;
+        constexpr double LN2_HI = 6.93147180369123816490e-01;
+        constexpr double LN2_LO = 1.90821492927058770002e-10;
+        constexpr double ROUND_MAGIC = 0x1.8p52;  // x + 1.5×2^52 arrondit x à l'entier le plus proche
+        
+        x = std::min(std::max(x, -708.0), 709.0);  // min/max = sélections, pas de branchement
+        const double shifted = x * LOG2E + ROUND_MAGIC;
+        const double n = shifted - ROUND_MAGIC;
+        const double r = (x - n * LN2_HI) - n * LN2_LO;
+        
+        const double poly = 1.0 + r * (1.0 + r * (1.0 / 2 + r * (1.0 / 6 + r * (1.0 / 24 + r * (1.0 / 120
+                          + r * (1.0 / 720 + r * (1.0 / 5040 + r * (1.0 / 40320 + r * (1.0 / 362880
+                          + r * (1.0 / 3628800 + r * (1.0 / 39916800 + r * (1.0 / 479001600
+                          + r * (1.0 / 6227020800)))))))))))));
+        
+        // n (complément à deux) est lisible dans les bits bas de shifted → exposant biaisé n + 1023
+        const uint64_t k = std::bit_cast<uint64_t>(shifted) - std::bit_cast<uint64_t>(ROUND_MAGIC);
+        return poly * std::bit_cast<double>((k + 1023) << 52);
+    }
+    
+    /*
+     * CDF NORMALE SANS BRANCHEMENT
+     * ============================
+     * Même approximation d'Abramowitz & Stegun que norm_cdf (mêmes résultats
+     * à quelques ulps près), mais fast_exp et des sélections à la place des if
+     * → vectorisable dans les boucles des noyaux Black-Scholes par lots
+     */
+    [[nodiscard]] static double fast_norm_cdf(double x) noexcept {
+        constexpr double a1 = 0.254829592;
+        constexpr double a2 = -0.284496736;
+        constexpr double a3 = 1.421413741;
+        constexpr double a4 = -1.453152027;
+        constexpr double a5 = 1.061405429;
+        constexpr double p = 0.3275911;
+        
+        const double z = std::abs(x) / std::numbers::sqrt2;
+        const double t = 1.0 / (1.0 + p * z);
+        const double y = 1.0 - (((((a5 * t + a4) * t) + a3) * t + a2) * t + a1) * t * fast_exp(-z * z);
+        const double cdf = 0.5 * (1.0 + (x >= 0 ? y : -y));
+        
+        return x < -8.0 ? 0.0 : (x > 8.0 ? 1.0 : cdf);  // Mêmes bornes que norm_cdf
+    }
+
+    /*
+     * INVERSE DE LA FONCTION DE RÉPARTITION NORMALE
+     * ==============================================
+     * Trouve x tel que P(X ≤ x) = p (p ∈ (0, 1))
+     * Indispensable en quasi-Monte Carlo : les points Sobol sont des uniformes
+     * "bien réparties", qu'il faut transformer en N(0,1) SANS Box-Muller
+     * (qui mélangerait deux dimensions et détruirait leur structure).
+     * 
+     * Algorithme d'Acklam (fractions rationnelles, erreur relative ≈ 1e-9)
+     * + une itération de Halley avec std::erfc → précision machine
+     */
+    [[nodiscard]] static double norm_inv(double p) noexcept {
+        // Coefficients d'Acklam : région centrale (a, b) et queues (c, d)
+        constexpr double a[] = {-3.969683028665376e+01,  2.209460984245205e+02, -2.759285104469687e+02,
+                                 1.383577518672690e+02, -3.066479806614716e+01,  2.506628277459239e+00};
+        constexpr double b[] = {-5.447609879822406e+01,  1.615858368580409e+02, -1.556989798598866e+02,
+                                 6.680131188771972e+01, -1.328068155288572e+01};
+        constexpr double c[] = {-7.784894002430293e-03, -3.223964580411365e-01, -2.400758277161838e+00,
+                                -2.549732539343734e+00,  4.374664141464968e+00,  2.938163982698783e+00};
+        constexpr double d[] = { 7.784695709041462e-03,  3.224671290700398e-01,  2.445134137142996e+00,
+                                 3.754408661907416e+00};
+        constexpr double P_LOW = 0.02425;  // Frontière entre région centrale et queues
+        
+        // Cas extrêmes
+        if (p <= 0.0) return -std::numeric_limits<double>::infinity();
+        if (p >= 1.0) return std::numeric_limits<double>::infinity();
+        
+        double x;
+        if (p < P_LOW) {
+            // Queue gauche
+            const double q = std::sqrt(-2.0 * std::log(p));
+            x = (((((c[0] * q + c[1]) * q + c[2]) * q + c[3]) * q + c[4]) * q + c[5])
+              / ((((d[0] * q + d[1]) * q + d[2]) * q + d[3]) * q + 1.0);
+        } else if (p <= 1.0 - P_LOW) {
+            // Région centrale
+            const double q = p - 0.5;
+            const double r = q * q;
+            x = (((((a[0] * r + a[1]) * r + a[2]) * r + a[3]) * r + a[4]) * r + a[5]) * q
+              / (((((b[0] * r + b[1]) * r + b[2]) * r + b[3]) * r + b[4]) * r + 1.0);
+        } else {
+            // Queue droite (symétrie)
+            const double q = std::sqrt(-2.0 * std::log1p(-p));
+            x = -(((((c[0] * q + c[1]) * q + c[2]) * q + c[3]) * q + c[4]) * q + c[5])
+              / ((((d[0] * q + d[1]) * q + d[2]) * q + d[3]) * q + 1.0);
+        }
+        
+        /*
+         * RAFFINEMENT DE HALLEY
+         * =====================
+         * e = Φ(x) - p (calculé avec erfc, précis même dans les queues)
+         * x ← x - u / (1 + x×u/2) avec u = e / φ(x)
+         */
+        const double e = 0.5 * std::erfc(-x / std::numbers::sqrt2) - p;
+        const double u = e * SQRT_2PI * std::exp(0.5 * x * x);
+        return x - u / (1.0 + 0.5 * x * u);
+    }
+    
+    /*
+     * FACTORISATION DE CHOLESKY
+     * =========================
+     * Pour une matrice symétrique semi-définie positive A (n×n, ligne par ligne),
+     * trouve L triangulaire inférieure telle que A = L × Lᵀ.
+     * 
+     * UTILITÉ : corréler des chocs indépendants
+     * Si z ~ N(0, I) alors x = L × z ~ N(0, A)
+     * → WTI et BRENT bougent ensemble au lieu d'être indépendants
+     * 
+     * SEMI-DÉFINIE : un pivot nul (à PIVOT_TOLERANCE × A_ii près) n'est pas
+     * une erreur, c'est une combinaison exacte des lignes précédentes
+     * (ex. ρ = 1 entre deux futures du même contrat) : L_ii = 0 et la colonne
+     * i de L est nulle, la ligne i reprend exactement les chocs précédents.
+     * 
+     * Coût O(n³/3), fait UNE fois ; ensuite chaque scénario coûte O(n²/2)
+     * Erreur INVALID_CORRELATION si A est indéfinie (pivot négatif, ou terme
+     * hors diagonale non nul face à un pivot nul) : corrélations incohérentes,
+     * ex: ρ(A,B) = 0.9, ρ(B,C) = 0.9, ρ(A,C) = -0.9
+     */
+    static constexpr double PIVOT_TOLERANCE = 1e-10;
+    
+    [[nodiscard]] static expected<std::vector<double>, RiskError> cholesky(
+        std::span<const double> matrix, size_t n) {
+        
+        if (matrix.size() != n * n) return expected<std::vector<double>, RiskError>{RiskError::INVALID_CORRELATION};
+        
+        std::vector<double> L(n * n, 0.0);
+        for (size_t i = 0; i < n; ++i) {
+            for (size_t j = 0; j <= i; ++j) {
+                // Produit scalaire des lignes i et j déjà calculées
+                double sum = matrix[i * n + j];
+                for (size_t k = 0; k < j; ++k) {
+                    sum -= L[i * n + k] * L[j * n + k];
+                }
+                
+                // Échelle de l'erreur d'arrondi sur ce terme
+                const double tolerance = PIVOT_TOLERANCE * std::sqrt(std::abs(matrix[i * n + i] * matrix[j * n + j]));
+                
+                if (i == j) {
+                    // Pivot négatif (au-delà de l'arrondi) ou NaN : matrice indéfinie
+                    if (!(sum >= -tolerance)) return expected<std::vector<double>, RiskError>{RiskError::INVALID_CORRELATION};
+                    L[i * n + i] = sum > tolerance ? std::sqrt(sum) : 0.0;
+                } else if (L[j * n + j] > 0.0) {
+                    L[i * n + j] = sum / L[j * n + j];
+                } else {
+                    // Pivot j nul : le terme résiduel doit l'être aussi (sinon indéfinie)
+                    if (!(std::abs(sum) <= tolerance)) return expected<std::vector<double>, RiskError>{RiskError::INVALID_CORRELATION};
+                }
+            }
+        }
+        
+        return expected<std::vector<double>, RiskError>{std::move(L)};
+    }
+    
     /*
      * HELPER POUR BLACK-SCHOLES : CALCUL DE D1 ET D2
      * ===============================================
@@ -197,7 +456,10 @@ public:
  * 2. NORM_CDF : Fonction de répartition normale (approximation rapide)
  * 3. NORM_PDF : Fonction de densité normale
  * 4. BATCH : Traitement de tableaux entiers
- * 5. D1_D2 : Calculs spécifiques à Black-Scholes
+ * 5. FAST_LOG / FAST_EXP / FAST_SINCOS_2PI / FAST_NORM_CDF : Noyaux sans branchement, vectorisables
+ * 6. NORM_INV : Inverse de la CDF normale (uniformes quasi-aléatoires → N(0,1))
+ * 7. CHOLESKY : Factorisation A = L×Lᵀ (chocs corrélés multi-actifs)
+ * 8. D1_D2 : Calculs spécifiques à Black-Scholes
  * 
  * POURQUOI C'EST IMPORTANT :
  * - Vitesse : Optimisé pour des millions de calculs par seconde
@@ -20,8 +20,192 @@
 #include <ranges>       // Pour manipuler des plages de données (C++20)
 #include <span>         // Pour manipuler des tableaux de façon sûre (C++20)
 #include <numeric>      // Pour accumulate, reduce, etc.
+#include <functional>   // Pour std::greater
+#include <atomic>       // Pour le compteur de flux aléatoires
+#include "parallel_utils.hpp"  // Pour répartir les trajectoires sur les threads
+#include "random_streams.hpp"  // Pour les flux aléatoires Philox adressables
+#include "quasi_random.hpp"    // Pour Sobol et le pont brownien (QMC)
 
 
+// ===== STATISTIQUES D'UN ESTIMATEUR MONTE CARLO =====
+/*
+ * Résultat d'un "fold" de trajectoires : au lieu de renvoyer N valeurs,
+ * on renvoie moyennes et sommes de carrés des écarts → variance et erreur
+ * standard.
+ * Chaque bloc de trajectoires remplit sa propre PathStatistics, puis les
+ * blocs sont fusionnés DANS L'ORDRE → résultat identique quel que soit
+ * le nombre de threads.
+ *
+ * VARIANCE EN LIGNE (WELFORD, FUSION DE CHAN)
+ * ===========================================
+ * Σ y² - N ȳ² soustrait deux grands nombres presque égaux dès que la
+ * variance est petite devant ȳ² (option très dans la monnaie, variable de
+ * contrôle efficace) : l'erreur standard, et donc l'arrêt adaptatif, ne
+ * valent plus rien. On suit plutôt la moyenne et M2 = Σ (y - ȳ)² :
+ *     ajout : δ = y - ȳ, ȳ += δ / N, M2 += δ × (y - ȳ)
+ *     fusion de A et B : δ = ȳ_B - ȳ_A,
+ *         ȳ = ȳ_A + δ N_B / N,  M2 = M2_A + M2_B + δ² N_A N_B / N
+ * (idem pour le contrôle X et le co-moment C = Σ (x - x̄)(y - ȳ))
+ */
+struct PathStatistics {
+    uint64_t stream_id{0};  // Flux aléatoire utilisé (pour rejouer)
+    size_t count{0};        // Nombre de trajectoires
+    double mean_value{0.0}; // ȳ
+    double m2{0.0};         // Σ (y - ȳ)²
+    
+    // Variable de contrôle X (optionnelle) : x̄, Σ (x - x̄)², Σ (x - x̄)(y - ȳ)
+    double mean_control{0.0};
+    double m2_control{0.0};
+    double co_moment{0.0};
+    
+    // Sans contrôle : X = 0 (les statistiques du contrôle restent nulles)
+    void add(double value) noexcept {
+        add(value, 0.0);
+    }
+    
+    void add(double value, double control) noexcept {
+        ++count;
+        const double n = static_cast<double>(count);
+        const double delta = value - mean_value;
+        const double delta_control = control - mean_control;
+        mean_value += delta / n;
+        mean_control += delta_control / n;
+        m2 += delta * (value - mean_value);
+        m2_control += delta_control * (control - mean_control);
+        co_moment += delta_control * (value - mean_value);
+    }
+    
+    void merge(const PathStatistics& other) noexcept {
+        if (other.count == 0) return;
+        if (count == 0) {
+            const uint64_t stream = stream_id;
+            *this = other;
+            stream_id = stream;
+            return;
+        }
+        const double n_a = static_cast<double>(count);
+        const double n_b = static_cast<double>(other.count);
+        const double n = n_a + n_b;
+        const double delta = other.mean_value - mean_value;
+        const double delta_control = other.mean_control - mean_control;
+        
+        count += other.count;
+        mean_value += delta * n_b / n;
+        mean_control += delta_control * n_b / n;
+        m2 += other.m2 + delta * delta * n_a * n_b / n;
+        m2_control += other.m2_control + delta_control * delta_control * n_a * n_b / n;
+        co_moment += other.co_moment + delta_control * delta * n_a * n_b / n;
+    }
+    
+    [[nodiscard]] double mean() const noexcept {
+        return count > 0 ? mean_value : 0.0;
+    }
+    
+    // Variance empirique (non biaisée)
+    [[nodiscard]] double variance() const noexcept {
+        if (count < 2) return 0.0;
+        return std::max(m2 / (count - 1), 0.0);
+    }
+    
+    // Erreur standard de la moyenne : σ / √N
+    [[nodiscard]] double standard_error() const noexcept {
+        return count > 0 ? std::sqrt(variance() / count) : 0.0;
+    }
+    
+    /*
+     * ESTIMATEUR À VARIABLE DE CONTRÔLE
+     * =================================
+     * Y = valeur, X = contrôle d'espérance connue E[X] = control_mean
+     *     Ŷ = moy(Y) - β × (moy(X) - E[X])   avec β = Cov(X,Y) / Var(X)
+     * Variance résiduelle = Var(Y) × (1 - ρ²) : plus X et Y sont corrélés,
+     * plus le gain est grand (ρ = 0.99 → variance divisée par 50)
+     */
+    [[nodiscard]] double control_beta() const noexcept {
+        if (count < 2) return 0.0;
+        return m2_control > 0.0 ? co_moment / m2_control : 0.0;
+    }
+    
+    [[nodiscard]] double controlled_mean(double control_mean) const noexcept {
+        if (count == 0) return 0.0;
+        return mean() - control_beta() * (mean_control - control_mean);
+    }
+    
+    [[nodiscard]] double controlled_standard_error() const noexcept {
+        if (count < 3) return standard_error();
+        const double residual = m2_control > 0.0 ? m2 - co_moment * co_moment / m2_control : m2;
+        return std::sqrt(std::max(residual, 0.0) / (count - 2) / count);
+    }
+};
+
+// ===== MODÈLE MULTI-ACTIFS CORRÉLÉ =====
+/*
+ * Paramètres de n sous-jacents simulés ENSEMBLE :
+ * dérives μ_i, volatilités σ_i et facteur de Cholesky L de la matrice
+ * de corrélation ρ (ρ = L × Lᵀ), factorisé une seule fois à la construction.
+ * 
+ * Construction via from_correlation (ρ + σ) ou from_covariance (Σ) :
+ * erreur INVALID_CORRELATION si la matrice est indéfinie (semi-définie acceptée :
+ * ρ = 1 entre deux contrats donne deux chocs identiques).
+ */
+struct CorrelatedAssets {
+    std::vector<double> drifts;    // μ_i annualisés
+    std::vector<double> vols;      // σ_i annualisées
+    std::vector<double> cholesky;  // L (n×n, ligne par ligne, triangulaire inférieure)
+    
+    [[nodiscard]] size_t size() const noexcept { return vols.size(); }
+    
+    [[nodiscard]] static expected<CorrelatedAssets, RiskError> from_correlation(
+        std::span<const double> drifts, std::span<const double> vols, std::span<const double> correlation) {
+        
+        const size_t n = vols.size();
+        if (drifts.size() != n) return expected<CorrelatedAssets, RiskError>{RiskError::INVALID_CORRELATION};
+        
+        auto factor = FastMath::cholesky(correlation, n);
+        if (!factor.has_value()) return expected<CorrelatedAssets, RiskError>{factor.error()};
+        
+        return expected<CorrelatedAssets, RiskError>{CorrelatedAssets{
+            std::vector<double>(drifts.begin(), drifts.end()),
+            std::vector<double>(vols.begin(), vols.end()),
+            factor.value()
+        }};
+    }
+    
+    /*
+     * Σ_ij = ρ_ij × σ_i × σ_j → σ_i = √Σ_ii et ρ_ij = Σ_ij / (σ_i σ_j)
+     */
+    [[nodiscard]] static expected<CorrelatedAssets, RiskError> from_covariance(
+        std::span<const double> drifts, std::span<const double> covariance) {
+        
+        const size_t n = drifts.size();
+        if (covariance.size() != n * n) return expected<CorrelatedAssets, RiskError>{RiskError::INVALID_CORRELATION};
+        
+        std::vector<double> vols(n);
+        for (size_t i = 0; i < n; ++i) {
+            if (!(covariance[i * n + i] > 0.0)) return expected<CorrelatedAssets, RiskError>{RiskError::INVALID_CORRELATION};
+            vols[i] = std::sqrt(covariance[i * n + i]);
+        }
+        
+        std::vector<double> correlation(n * n);
+        for (size_t i = 0; i < n; ++i) {
+            for (size_t j = 0; j < n; ++j) {
+                correlation[i * n + j] = covariance[i * n + j] / (vols[i] * vols[j]);
+            }
+        }
+        
+        return from_correlation(drifts, vols, correlation);
+    }
+};
+
+// ===== VaR/ES D'UN HORIZON (STRUCTURE PAR TERME) =====
+/*
+ * Un point de la courbe "risque en fonction de l'horizon" :
+ * rendement S(step)/S(0) - 1, un couple (VaR, ES) par niveau de confiance
+ */
+struct HorizonVarEs {
+    size_t step{0};                                // Horizon, en pas de temps
+    std::vector<std::pair<double, double>> var_es; // (VaR, ES) dans l'ordre des niveaux demandés
+};
+
 // ===== MOTEUR MONTE CARLO HAUTE PERFORMANCE =====
 /*
  * Cette classe simule l'évolution aléatoire des prix d'actifs financiers
@@ -34,53 +218,138 @@ private:
      * ==================================
      * On a besoin de BEAUCOUP de nombres aléatoires de haute qualité
      */
-    std::mt19937_64 rng_;  // Générateur principal (Mersenne Twister 64-bit)
+    uint64_t seed_;  // Graine maître de toutes les simulations
+    
+    size_t n_threads_;  // Nombre de threads utilisés pour les simulations
+    /*
+     * n_threads_ = 1 → mode séquentiel (tout dans le thread appelant)
+     * n_threads_ > 1 → les trajectoires sont réparties sur plusieurs threads
+     */
+    
+    mutable std::atomic<uint64_t> next_stream_{0};  // Un flux aléatoire par appel de simulation
     /*
-     * mt19937_64 = générateur d'excellence pour la finance
-     * - Période : 2^19937 - 1 (pratiquement infinie)
-     * - Qualité statistique excellente
-     * - Rapide pour les simulations intensives
+     * Chaque appel à simulate_*() consomme un nouvel identifiant de flux.
+     * Deux appels successifs (ex: WTI puis BRENT) tirent donc des chocs
+     * indépendants, exactement comme avant avec des générateurs qui avancent.
      */
     
-    mutable std::vector<std::mt19937_64> thread_rngs_;  // Un générateur par thread
     /*
-     * mutable = peut être modifié même dans des fonctions const
-     * vector<mt19937_64> = tableau de générateurs indépendants
+     * GÉNÉRATEUR "COUNTER-BASED" (PHILOX)
+     * ===================================
+     * Chaque choc aléatoire est adressé par (graine, flux, trajectoire, pas) :
+     *     Z = RandomStream(seed, flux).normal(path_idx, step)
+     * 
+     * Conséquences :
+     * - Le résultat ne dépend ni du nombre de threads ni de l'ordre de calcul
+     * - N'importe quelle trajectoire peut être régénérée seule (replay_gbm_path)
+     * - Des workers peuvent se partager [0, N) sans se coordonner (first_path)
+     * - Plus de graines voisines seed + i, ni de 2.5KB d'état par générateur
      * 
-     * Pourquoi plusieurs générateurs ?
-     * - Éviter les conflits entre threads parallèles
-     * - Chaque thread a son propre flux aléatoire
-     * - Performance : pas de synchronisation nécessaire
+     * Les blocs ne servent plus qu'à répartir le travail entre threads.
+     */
+    static constexpr size_t PATHS_PER_BLOCK = 256;     // Trajectoires complètes (n_steps chocs chacune)
+    static constexpr size_t DRAWS_PER_BLOCK = 8'192;   // Tirages uniques (rendements, prix finaux)
+    
+    [[nodiscard]] uint64_t resolve_stream(uint64_t stream_id) const noexcept {
+        return stream_id == NEXT_STREAM ? next_stream_.fetch_add(1) : stream_id;
+    }
+
+    /*
+     * NOYAU COMMUN DES "FOLDS" DE TRAJECTOIRES
+     * ========================================
+     * fold_block(stats, begin, end) réduit les trajectoires [begin, end)
+     * dans stats ; les statistiques des blocs sont fusionnées dans l'ordre
+     */
+    template<typename BlockFolder>
+    [[nodiscard]] PathStatistics fold_path_blocks(size_t n_paths, BlockFolder&& fold_block) const {
+        std::vector<PathStatistics> partial(parallel::block_count(n_paths, PATHS_PER_BLOCK));
+        
+        parallel::for_each_block(n_paths, PATHS_PER_BLOCK, n_threads_,
+            [&](size_t block_idx, size_t begin, size_t end) {
+            fold_block(partial[block_idx], begin, end);
+        });
+        
+        PathStatistics total;
+        for (const auto& block_stats : partial) total.merge(block_stats);
+        return total;
+    }
+    
+    /*
+     * ENREGISTREMENT D'UNE TRAJECTOIRE (OU D'UNE PAIRE ANTITHÉTIQUE)
+     * ==============================================================
+     * Si l'accumulateur fournit une variable de contrôle, elle est
+     * enregistrée avec la valeur. Une paire antithétique compte pour
+     * UN échantillon : la moyenne des deux (elles ne sont pas indépendantes)
      */
+    template<PathAccumulator Accumulator>
+    static void record_path(PathStatistics& stats, const Accumulator& acc) noexcept {
+        if constexpr (ControlledPathAccumulator<Accumulator>) {
+            stats.add(acc.value(), acc.control());
+        } else {
+            stats.add(acc.value());
+        }
+    }
+    
+    template<PathAccumulator Accumulator>
+    static void record_pair(PathStatistics& stats, const Accumulator& acc, const Accumulator& mirror) noexcept {
+        if constexpr (ControlledPathAccumulator<Accumulator>) {
+            stats.add(0.5 * (acc.value() + mirror.value()), 0.5 * (acc.control() + mirror.control()));
+        } else {
+            stats.add(0.5 * (acc.value() + mirror.value()));
+        }
+    }
     
 public:
     /*
      * CONSTRUCTEUR : INITIALISE LES GÉNÉRATEURS ALÉATOIRES
      * =====================================================
      */
-    explicit MonteCarloEngine(uint64_t seed = std::random_device{}()) 
-        : rng_(seed) {
+    explicit MonteCarloEngine(uint64_t seed = std::random_device{}(),
+                              size_t n_threads = parallel::default_thread_count()) 
+        : seed_(seed), n_threads_(std::max<size_t>(n_threads, 1)) {
         /*
          * explicit = empêche la conversion implicite
          * std::random_device{}() = graine vraiment aléatoire (hardware)
          * seed = point de départ pour la séquence aléatoire
+         * n_threads = par défaut, un thread par cœur CPU détecté
          */
-        
-        // Détecte le nombre de cœurs/threads disponibles sur le CPU
-        const auto num_threads = std::thread::hardware_concurrency();
-        thread_rngs_.reserve(num_threads);  // Pré-alloue la mémoire
-        
-        /*
-         * Crée un générateur indépendant pour chaque thread
-         * Chaque générateur a une graine différente (seed + i)
-         */
-        for (unsigned i = 0; i < num_threads; ++i) {
-            thread_rngs_.emplace_back(seed + i);
-            /*
-             * emplace_back = construit directement dans le vector
-             * Plus efficace que push_back(mt19937_64(seed + i))
-             */
-        }
+    }
+    
+    /*
+     * MODE D'EXÉCUTION
+     * ================
+     * set_thread_count(1) → séquentiel ; set_thread_count(8) → 8 threads
+     * Le résultat reste identique quel que soit ce réglage
+     */
+    void set_thread_count(size_t n_threads) noexcept {
+        n_threads_ = std::max<size_t>(n_threads, 1);
+    }
+    
+    /*
+     * GESTION DES FLUX ALÉATOIRES
+     * ===========================
+     * NEXT_STREAM (défaut) = "prends le prochain flux libre".
+     * Chaque simulate_*() renvoie le flux utilisé : on le garde pour rejouer
+     * un scénario, ou on réserve un flux à l'avance pour le partager
+     * entre plusieurs workers (chacun avec son first_path).
+     */
+    static constexpr uint64_t NEXT_STREAM = ~uint64_t{0};
+    
+    [[nodiscard]] uint64_t reserve_stream() const noexcept {
+        return next_stream_.fetch_add(1);
+    }
+    
+    [[nodiscard]] uint64_t get_seed() const noexcept { return seed_; }
+    
+    /*
+     * ACCÈS DIRECT À UN CHOC
+     * ======================
+     * Le N(0,1) utilisé par la trajectoire path_idx au pas step (step ≥ 1)
+     * du flux stream_id. Pour simulate_single_step_returns et
+     * simulate_final_prices, le choc de l'élément i est à (i, 1).
+     */
+    [[nodiscard]] double normal_variate(uint64_t stream_id, uint64_t path_idx, uint64_t step) const noexcept {
+        return RandomStream(seed_, stream_id).normal(path_idx, step - 1);
     }
     
     /*
@@ -92,8 +361,9 @@ public:
      * où dW est un mouvement brownien (bruit aléatoire)
      */
     template<RandomAccessRange Container>
-    void simulate_gbm_paths(Container& paths, double S0, double mu, double sigma, 
-                           double T, size_t n_steps, size_t n_paths) const {
+    uint64_t simulate_gbm_paths(Container& paths, double S0, double mu, double sigma, 
+                               double T, size_t n_steps, size_t n_paths,
+                               uint64_t stream_id = NEXT_STREAM, uint64_t first_path = 0) const {
         /*
          * PARAMÈTRES :
          * - paths : tableau pour stocker tous les prix simulés
@@ -103,6 +373,10 @@ public:
          * - T : horizon de temps (ex: 1 an)
          * - n_steps : nombre d'étapes (ex: 252 jours de trading)
          * - n_paths : nombre de trajectoires (ex: 10,000 simulations)
+         * - stream_id : flux aléatoire (défaut : un nouveau flux)
+         * - first_path : numéro global de la 1re trajectoire (paths[0] = trajectoire first_path)
+         * 
+         * RETOUR : le flux utilisé (pour rejouer une trajectoire plus tard)
          */
         
         /*
@@ -123,91 +397,192 @@ public:
         /*
          * BOUCLE DE SIMULATION PRINCIPALE
          * ================================
-         * Pour chaque trajectoire possible (path)
+         * Les trajectoires sont réparties par blocs sur les threads
          */
-        for (size_t path_idx = 0; path_idx < n_paths; ++path_idx) {
-            /*
-             * GÉNÉRATEUR ALÉATOIRE LOCAL AU THREAD
-             * ====================================
-             * thread_local = une copie par thread, évite les conflits
-             */
-            thread_local std::normal_distribution<double> normal{0.0, 1.0};
-            /*
-             * normal_distribution = loi normale centrée réduite N(0,1)
-             * C'est la "source de hasard" du mouvement brownien
-             */
-            
-            // Choisit le bon générateur pour ce thread
-            auto& thread_rng = thread_rngs_[path_idx % thread_rngs_.size()];
-            
-            /*
-             * INITIALISATION DE LA TRAJECTOIRE
-             * =================================
-             */
-            paths[path_idx * (n_steps + 1)] = S0;  // Prix initial
+        stream_id = resolve_stream(stream_id);
+        const RandomStream stream(seed_, stream_id);
+        /*
+         * RandomStream = fonction pure (trajectoire, pas) → N(0,1)
+         * Aucun état partagé entre threads, donc aucune synchronisation
+         */
+        
+        parallel::for_each_block(n_paths, PATHS_PER_BLOCK, n_threads_,
+            [&](size_t, size_t block_begin, size_t block_end) {
             /*
-             * Structure du tableau paths :
-             * [S0_path1, S1_path1, ..., Sn_path1, S0_path2, S1_path2, ...]
-             * Chaque trajectoire occupe (n_steps + 1) positions
+             * BUFFER DE CHOCS PRÉ-REMPLI
+             * ==========================
+             * Tous les N(0,1) d'une trajectoire sont générés d'un coup par le
+             * noyau vectorisé, puis consommés par la boucle GBM
              */
+            std::vector<double> shocks(n_steps);
             
-            /*
-             * GÉNÉRATION DE LA TRAJECTOIRE COMPLÈTE
-             * ======================================
-             * Pour chaque pas de temps de cette trajectoire
-             */
-            for (size_t step = 1; step <= n_steps; ++step) {
+            for (size_t path_idx = block_begin; path_idx < block_end; ++path_idx) {
+                stream.fill_normals_along_path(shocks, first_path + path_idx, 0);
+                
                 /*
-                 * GÉNÉRATION D'UN CHOC ALÉATOIRE
-                 * ===============================
+                 * INITIALISATION DE LA TRAJECTOIRE
+                 * =================================
                  */
-                const double dW = normal(thread_rng);  // Nombre aléatoire N(0,1)
+                paths[path_idx * (n_steps + 1)] = S0;  // Prix initial
                 /*
-                 * dW = incrément du mouvement brownien
-                 * Représente le "hasard" qui affecte le prix
+                 * Structure du tableau paths :
+                 * [S0_path1, S1_path1, ..., Sn_path1, S0_path2, S1_path2, ...]
+                 * Chaque trajectoire occupe (n_steps + 1) positions
                  */
                 
                 /*
-                 * CALCUL DES INDICES DANS LE TABLEAU
-                 * ===================================
-                 */
-                const size_t idx = path_idx * (n_steps + 1) + step;      // Position actuelle
-                const size_t prev_idx = path_idx * (n_steps + 1) + step - 1;  // Position précédente
-                
-                /*
-                 * FORMULE DU MODÈLE GÉOMÉTRIQUE BROWNIEN
+                 * GÉNÉRATION DE LA TRAJECTOIRE COMPLÈTE
                  * ======================================
-                 * S(t+dt) = S(t) × exp((μ - σ²/2)×dt + σ×√dt×dW)
-                 */
-                paths[idx] = paths[prev_idx] * std::exp(drift + vol_sqrt_dt * dW);
-                /*
-                 * INTERPRÉTATION :
-                 * - paths[prev_idx] : prix à l'étape précédente
-                 * - drift : tendance déterministe
-                 * - vol_sqrt_dt * dW : choc aléatoire
-                 * - exp() : garantit que le prix reste positif
-                 * 
-                 * EXEMPLE CONCRET :
-                 * Si pétrole = 75$, drift = 0.0002, dW = 0.5
-                 * → Nouveau prix = 75 × exp(0.0002 + 0.35×√(1/252)×0.5)
-                 *                ≈ 75 × exp(0.0113) ≈ 75.85$
+                 * Pour chaque pas de temps de cette trajectoire
                  */
+                for (size_t step = 1; step <= n_steps; ++step) {
+                    /*
+                     * GÉNÉRATION D'UN CHOC ALÉATOIRE
+                     * ===============================
+                     */
+                    const double dW = shocks[step - 1];  // Nombre aléatoire N(0,1)
+                    /*
+                     * dW = incrément du mouvement brownien
+                     * Représente le "hasard" qui affecte le prix
+                     * Adressé par (trajectoire globale, pas) → reproductible
+                     */
+                    
+                    /*
+                     * CALCUL DES INDICES DANS LE TABLEAU
+                     * ===================================
+                     */
+                    const size_t idx = path_idx * (n_steps + 1) + step;      // Position actuelle
+                    const size_t prev_idx = path_idx * (n_steps + 1) + step - 1;  // Position précédente
+                    
+                    /*
+                     * FORMULE DU MODÈLE GÉOMÉTRIQUE BROWNIEN
+                     * ======================================
+                     * S(t+dt) = S(t) × exp((μ - σ²/2)×dt + σ×√dt×dW)
+                     */
+                    paths[idx] = paths[prev_idx] * std::exp(drift + vol_sqrt_dt * dW);
+                    /*
+                     * INTERPRÉTATION :
+                     * - paths[prev_idx] : prix à l'étape précédente
+                     * - drift : tendance déterministe
+                     * - vol_sqrt_dt * dW : choc aléatoire
+                     * - exp() : garantit que le prix reste positif
+                     * 
+                     * EXEMPLE CONCRET :
+                     * Si pétrole = 75$, drift = 0.0002, dW = 0.5
+                     * → Nouveau prix = 75 × exp(0.0002 + 0.35×√(1/252)×0.5)
+                     *                ≈ 75 × exp(0.0113) ≈ 75.85$
+                     */
+                }
             }
+        });
+        
+        return stream_id;
+    }
+    
+    /*
+     * REJEU D'UNE TRAJECTOIRE UNIQUE
+     * ==============================
+     * Régénère la trajectoire path_idx du flux stream_id, identique à celle
+     * produite par simulate_gbm_paths (ex: le pire scénario d'un calcul de VaR)
+     * path doit contenir n_steps + 1 éléments
+     */
+    void replay_gbm_path(std::span<double> path, uint64_t stream_id, uint64_t path_idx,
+                         double S0, double mu, double sigma, double T, size_t n_steps) const {
+        const double dt = T / n_steps;
+        const double drift = (mu - 0.5 * sigma * sigma) * dt;
+        const double vol_sqrt_dt = sigma * std::sqrt(dt);
+        const RandomStream stream(seed_, stream_id);
+        
+        std::vector<double> shocks(n_steps);
+        stream.fill_normals_along_path(shocks, path_idx, 0);
+        
+        path[0] = S0;
+        for (size_t step = 1; step <= n_steps; ++step) {
+            path[step] = path[step - 1] * std::exp(drift + vol_sqrt_dt * shocks[step - 1]);
         }
     }
     
+    /*
+     * TRAJECTOIRES EN FLUX ("FOLD") : SANS MATRICE DE TRAJECTOIRES
+     * ============================================================
+     * Mêmes trajectoires que simulate_gbm_paths (même flux, mêmes chocs,
+     * mêmes prix au bit près), mais chaque prix est passé à l'accumulateur
+     * dès qu'il est calculé puis oublié :
+     *     acc.reset(S0); acc.add(S1); ... acc.add(Sn); valeur = acc.value()
+     * 
+     * MÉMOIRE : O(n_steps) par bloc (le buffer de chocs) au lieu de
+     * O(n_paths × n_steps) → 1M trajectoires × 252 pas = 2GB en matrice,
+     * quelques KB ici, et tout reste dans le cache.
+     * 
+     * RETOUR : statistiques des valeurs (moyenne, erreur standard) + flux utilisé
+     */
+    template<PathAccumulator Accumulator>
+    [[nodiscard]] PathStatistics fold_gbm_paths(const Accumulator& prototype, double S0, double mu, double sigma,
+                                                double T, size_t n_steps, size_t n_paths,
+                                                uint64_t stream_id = NEXT_STREAM, uint64_t first_path = 0,
+                                                bool antithetic = false) const {
+        /*
+         * antithetic = true : chaque trajectoire (chocs Z) est accompagnée de
+         * sa trajectoire miroir (chocs -Z). n_paths = nombre de PAIRES.
+         * Pour un payoff monotone en les chocs, les deux erreurs se
+         * compensent → variance réduite pour le même nombre de tirages.
+         */
+        const double dt = T / n_steps;
+        const double drift = (mu - 0.5 * sigma * sigma) * dt;
+        const double vol_sqrt_dt = sigma * std::sqrt(dt);
+        
+        stream_id = resolve_stream(stream_id);
+        const RandomStream stream(seed_, stream_id);
+        
+        PathStatistics stats = fold_path_blocks(n_paths,
+            [&](PathStatistics& block_stats, size_t block_begin, size_t block_end) {
+            Accumulator acc = prototype;            // Une copie par bloc (état local au thread)
+            Accumulator mirror = prototype;         // Trajectoire antithétique
+            std::vector<double> shocks(n_steps);    // Seul buffer : réutilisé par chaque trajectoire
+            
+            for (size_t path_idx = block_begin; path_idx < block_end; ++path_idx) {
+                stream.fill_normals_along_path(shocks, first_path + path_idx, 0);
+                
+                double S = S0;
+                acc.reset(S);
+                for (size_t step = 1; step <= n_steps; ++step) {
+                    S *= std::exp(drift + vol_sqrt_dt * shocks[step - 1]);
+                    acc.add(S);  // Moyenne, max, barrière... mis à jour au fil de l'eau
+                }
+                
+                if (!antithetic) {
+                    record_path(block_stats, acc);
+                    continue;
+                }
+                
+                double S_mirror = S0;
+                mirror.reset(S_mirror);
+                for (size_t step = 1; step <= n_steps; ++step) {
+                    S_mirror *= std::exp(drift - vol_sqrt_dt * shocks[step - 1]);
+                    mirror.add(S_mirror);
+                }
+                record_pair(block_stats, acc, mirror);
+            }
+        });
+        
+        stats.stream_id = stream_id;
+        return stats;
+    }
+    
     /*
      * VERSION OPTIMISÉE POUR VaR QUOTIDIENNE
      * =======================================
      * Simule seulement les rendements sur 1 jour (pas besoin de trajectoires complètes)
      */
-    void simulate_single_step_returns(std::span<double> returns, double mu, double sigma, double dt) const {
+    uint64_t simulate_single_step_returns(std::span<double> returns, double mu, double sigma, double dt,
+                                          uint64_t stream_id = NEXT_STREAM, uint64_t first_path = 0) const {
         /*
          * PARAMÈTRES :
          * - returns : tableau pour stocker les rendements simulés
          * - mu : dérive annualisée
          * - sigma : volatilité annualisée  
          * - dt : période (ex: 1/252 pour 1 jour)
+         * - stream_id / first_path : comme simulate_gbm_paths
          */
         
         // Pré-calculs (même logique que GBM complet)
@@ -219,30 +594,101 @@ public:
          * ==================================
          * Plus rapide car on évite de stocker toute la trajectoire
          */
-        for (size_t i = 0; i < returns.size(); ++i) {
-            thread_local std::normal_distribution<double> normal{0.0, 1.0};
-            auto& thread_rng = thread_rngs_[i % thread_rngs_.size()];
+        stream_id = resolve_stream(stream_id);
+        const RandomStream stream(seed_, stream_id);
+        
+        parallel::for_each_block(returns.size(), DRAWS_PER_BLOCK, n_threads_,
+            [&](size_t, size_t begin, size_t end) {
+            // Chocs du bloc générés d'un coup, directement dans le tableau de sortie
+            const auto block = returns.subspan(begin, end - begin);
+            stream.fill_normals_across_paths(block, first_path + begin, 0);
+            
+            for (double& r : block) {
+                const double dW = r;  // Choc aléatoire
+                r = std::exp(drift + vol_sqrt_dt * dW) - 1.0;
+                /*
+                 * FORMULE DU RENDEMENT :
+                 * R = S(t+dt)/S(t) - 1 = exp(drift + vol×√dt×dW) - 1
+                 * 
+                 * EXEMPLE :
+                 * Si exp(...) = 1.012, alors rendement = 1.2%
+                 * Si exp(...) = 0.988, alors rendement = -1.2%
+                 */
+            }
+        });
+        
+        return stream_id;
+    }
+    
+
+    /*
+     * RENDEMENTS CORRÉLÉS MULTI-ACTIFS (1 PÉRIODE)
+     * ============================================
+     * returns = n_assets × n_scenarios, en "structure de tableaux" :
+     *     returns[asset × n_scenarios + scénario]
+     * Chaque sous-jacent occupe une ligne contiguë → la boucle de
+     * réévaluation d'une position parcourt ses scénarios avec un pas de 1.
+     * 
+     * Le choc N(0,1) indépendant de l'actif j dans le scénario s est à
+     * l'adresse (s, j) du flux ; puis x = L × z corrèle les actifs.
+     */
+    uint64_t simulate_correlated_returns(std::span<double> returns, const CorrelatedAssets& assets, double dt,
+                                         uint64_t stream_id = NEXT_STREAM, uint64_t first_path = 0) const {
+        const size_t n_assets = assets.size();
+        if (n_assets == 0) return stream_id;
+        const size_t n_scenarios = returns.size() / n_assets;
+        const double sqrt_dt = std::sqrt(dt);
+        
+        stream_id = resolve_stream(stream_id);
+        const RandomStream stream(seed_, stream_id);
+        
+        parallel::for_each_block(n_scenarios, DRAWS_PER_BLOCK, n_threads_,
+            [&](size_t, size_t begin, size_t end) {
+            const size_t count = end - begin;
+            auto row = [&](size_t asset) { return returns.subspan(asset * n_scenarios + begin, count); };
+            
+            // 1. Chocs indépendants, directement dans les lignes de sortie
+            for (size_t j = 0; j < n_assets; ++j) {
+                stream.fill_normals_across_paths(row(j), first_path + begin, j);
+            }
             
-            const double dW = normal(thread_rng);  // Choc aléatoire
-            returns[i] = std::exp(drift + vol_sqrt_dt * dW) - 1.0;
             /*
-             * FORMULE DU RENDEMENT :
-             * R = S(t+dt)/S(t) - 1 = exp(drift + vol×√dt×dW) - 1
-             * 
-             * EXEMPLE :
-             * Si exp(...) = 1.012, alors rendement = 1.2%
-             * Si exp(...) = 0.988, alors rendement = -1.2%
+             * 2. CORRÉLATION SUR PLACE : x_i = Σ_{k≤i} L_ik × z_k
+             * En partant du dernier actif, les lignes k < i contiennent
+             * encore les z_k indépendants quand on calcule x_i.
+             * Boucle interne sur les scénarios : contiguë, vectorisable.
              */
-        }
+            for (size_t i = n_assets; i-- > 0; ) {
+                const auto x = row(i);
+                const double L_ii = assets.cholesky[i * n_assets + i];
+                for (double& v : x) v *= L_ii;
+                for (size_t k = 0; k < i; ++k) {
+                    const double L_ik = assets.cholesky[i * n_assets + k];
+                    if (L_ik == 0.0) continue;
+                    const auto z_k = row(k);
+                    for (size_t s = 0; s < count; ++s) x[s] += L_ik * z_k[s];
+                }
+            }
+            
+            // 3. Choc corrélé → rendement GBM sur dt (même formule que simulate_single_step_returns)
+            for (size_t i = 0; i < n_assets; ++i) {
+                const double sigma = assets.vols[i];
+                const double drift = (assets.drifts[i] - 0.5 * sigma * sigma) * dt;
+                const double vol_sqrt_dt = sigma * sqrt_dt;
+                for (double& r : row(i)) r = std::exp(drift + vol_sqrt_dt * r) - 1.0;
+            }
+        });
+        
+        return stream_id;
     }
     
-
     /*
     * GÉNÉRATION OPTIMISÉE DES PRIX FINAUX
     * =====================================
     * Pour options européennes : on n'a besoin que du prix final, pas de toute la trajectoire
     */
-    void simulate_final_prices(std::span<double> final_prices, double S0, double mu, double sigma, double T) const {
+    uint64_t simulate_final_prices(std::span<double> final_prices, double S0, double mu, double sigma, double T,
+                                   uint64_t stream_id = NEXT_STREAM, uint64_t first_path = 0) const {
         /*
         * PARAMÈTRES :
         * - final_prices : tableau pour stocker les prix finaux simulés
@@ -250,6 +696,7 @@ public:
         * - mu : dérive (taux sans risque pour pricing)
         * - sigma : volatilité annualisée
         * - T : temps jusqu'à expiration
+        * - stream_id / first_path : comme simulate_gbm_paths
         */
         
         /*
@@ -265,30 +712,35 @@ public:
         * ===================================
         * Plus efficace que simulate_gbm_paths pour options européennes
         */
-        for (size_t i = 0; i < final_prices.size(); ++i) {
-            /*
-            * GÉNÉRATEUR LOCAL AU THREAD
-            * ===========================
-            */
-            thread_local std::normal_distribution<double> normal{0.0, 1.0};
-            auto& thread_rng = thread_rngs_[i % thread_rngs_.size()];
+        stream_id = resolve_stream(stream_id);
+        const RandomStream stream(seed_, stream_id);
+        
+        parallel::for_each_block(final_prices.size(), DRAWS_PER_BLOCK, n_threads_,
+            [&](size_t, size_t begin, size_t end) {
+            // Chocs du bloc générés d'un coup, directement dans le tableau de sortie
+            const auto block = final_prices.subspan(begin, end - begin);
+            stream.fill_normals_across_paths(block, first_path + begin, 0);
             
-            /*
-            * GÉNÉRATION DU PRIX FINAL
-            * =========================
-            */
-            const double Z = normal(thread_rng);  // Variable aléatoire N(0,1)
-            final_prices[i] = S0 * std::exp(drift_term + vol_term * Z);
-            /*
-            * FORMULE GBM FERMÉE :
-            * S(T) = S0 × exp((μ - σ²/2)×T + σ×√T×Z)
-            * 
-            * AVANTAGES :
-            * - Pas de boucle sur les steps intermédiaires
-            * - Moins d'allocations mémoire
-            * - Plus rapide pour options européennes
-            */
-        }
+            for (double& price : block) {
+                /*
+                * GÉNÉRATION DU PRIX FINAL
+                * =========================
+                */
+                const double Z = price;  // Variable aléatoire N(0,1)
+                price = S0 * std::exp(drift_term + vol_term * Z);
+                /*
+                * FORMULE GBM FERMÉE :
+                * S(T) = S0 × exp((μ - σ²/2)×T + σ×√T×Z)
+                * 
+                * AVANTAGES :
+                * - Pas de boucle sur les steps intermédiaires
+                * - Moins d'allocations mémoire
+                * - Plus rapide pour options européennes
+                */
+            }
+        });
+        
+        return stream_id;
     }
 
     /*
@@ -296,8 +748,8 @@ public:
     * =================================
     * Interface alternative qui prend un std::vector
     */
-    void simulate_final_prices(std::vector<double>& final_prices, double S0, double mu, double sigma, double T) const {
-        simulate_final_prices(std::span<double>(final_prices), S0, mu, sigma, T);
+    uint64_t simulate_final_prices(std::vector<double>& final_prices, double S0, double mu, double sigma, double T) const {
+        return simulate_final_prices(std::span<double>(final_prices), S0, mu, sigma, T);
     }
 
     /*
@@ -310,163 +762,375 @@ public:
     [[nodiscard]] std::pair<double, double> calculate_var_es(const Container& returns, double confidence) const {
         /*
          * PARAMÈTRES :
-         * - returns : tableau des rendements simulés
+         * - returns : tableau des rendements simulés (non modifié)
          * - confidence : niveau de confiance (ex: 0.95 = 95%)
          * 
          * RETOUR :
          * - pair<VaR, ES> : les deux mesures de risque
-         */
-        
-        /*
-         * ÉTAPE 1 : TRIER LES RENDEMENTS
-         * ===============================
-         * On trie du plus mauvais au meilleur pour identifier la "queue" de distribution
-         */
-        std::vector<double> sorted_returns(returns.begin(), returns.end());
-        std::sort(sorted_returns.begin(), sorted_returns.end());
-        /*
-         * Après tri : [-5%, -3%, -2%, ..., 0%, 1%, 2%, 3%]
-         * Les pertes les plus importantes sont au début
-         */
-        
-        /*
-         * ÉTAPE 2 : CALCUL DE L'INDEX VAR
-         * ================================
-         */
-        const size_t var_index = static_cast<size_t>((1.0 - confidence) * sorted_returns.size());
-        /*
-         * LOGIQUE :
-         * - confidence = 0.95 → on veut le 5e percentile
-         * - (1 - 0.95) = 0.05 = 5%
-         * - Sur 10,000 simulations : index = 500
-         * → On regarde la 500e pire perte
-         */
-        
-        // Vérification de sécurité
-        if (var_index >= sorted_returns.size()) return {0.0, 0.0};
-        
-        /*
-         * ÉTAPE 3 : CALCUL DU VAR
-         * ========================
-         */
-        const double var = -sorted_returns[var_index];
-        /*
-         * POURQUOI LE SIGNE MOINS ?
-         * - sorted_returns contient des rendements (négatifs = pertes)
-         * - VaR s'exprime comme un nombre positif
-         * - Si sorted_returns[500] = -3%, alors VaR = 3%
-         */
-        
-        /*
-         * ÉTAPE 4 : CALCUL DE L'EXPECTED SHORTFALL
-         * =========================================
-         * ES = moyenne des pertes dans la queue (pire que VaR)
-         */
-        const double es = var_index > 0 
-            ? -std::accumulate(sorted_returns.begin(), 
-                              sorted_returns.begin() + var_index, 0.0) / var_index
-            : 0.0;
-        /*
-         * LOGIQUE :
-         * - On prend la moyenne des 500 pires pertes
-         * - accumulate() fait la somme
-         * - Division par var_index pour avoir la moyenne
-         * - Signe moins pour exprimer comme perte positive
          * 
-         * INTERPRÉTATION :
-         * - VaR 95% = 3% : "On risque maximum 3% dans 95% des cas"
-         * - ES 95% = 4.5% : "Si on dépasse le VaR, on perd en moyenne 4.5%"
+         * Une copie de travail, puis sélection sur place
+         * (si returns peut être réordonné : calculate_var_es_in_place, sans copie)
          */
-        
-        return {var, es};
+        std::vector<double> scenarios(returns.begin(), returns.end());
+        return calculate_var_es_in_place(scenarios, confidence);
     }
     
     /*
      * CALCUL VaR/ES POUR PLUSIEURS NIVEAUX DE CONFIANCE
      * ==================================================
-     * Plus efficace que d'appeler calculate_var_es() plusieurs fois
+     * Plus efficace que d'appeler calculate_var_es() plusieurs fois :
+     * une seule copie, une seule passe de sélection pour tous les niveaux
      */
     [[nodiscard]] std::vector<std::pair<double, double>> calculate_var_es_batch(
         const std::vector<double>& returns, 
         std::span<const double> confidence_levels) const {
         /*
          * PARAMÈTRES :
-         * - returns : rendements simulés
+         * - returns : rendements simulés (non modifiés)
          * - confidence_levels : {0.90, 0.95, 0.99, 0.995} par exemple
          */
-        
+        std::vector<double> scenarios(returns);
+        return calculate_var_es_in_place(scenarios, confidence_levels);
         /*
-         * OPTIMISATION : TRIER UNE SEULE FOIS
-         * ====================================
-         * Au lieu de trier à chaque niveau de confiance
+         * EXEMPLE DE RÉSULTAT :
+         * [(VaR90%, ES90%), (VaR95%, ES95%), (VaR99%, ES99%)]
+         * [(2.1%, 2.8%), (3.0%, 3.9%), (4.5%, 5.7%)]
          */
-        std::vector<double> sorted_returns(returns);
-        std::sort(sorted_returns.begin(), sorted_returns.end());
+    }
+    
+    /*
+     * NOYAU VaR/ES PAR SÉLECTION (SUR PLACE, SANS TRI COMPLET)
+     * ========================================================
+     * Pour k = (1 - confiance) × N :
+     *     VaR = -x_(k)                      (k-ième plus petit rendement)
+     *     ES  = -moyenne(x_(0), ..., x_(k-1)) (les k pires scénarios)
+     * 
+     * Pas besoin de l'ordre complet, seulement de savoir QUELS scénarios
+     * sont dans la queue → O(N) au lieu de O(N log N) :
+     * - nth_element au plus grand k (queue la plus large) sur tout le tableau
+     * - puis chaque k plus petit, seulement dans la partie gauche déjà isolée
+     *   (la queue à 99.5% ne fait que 0.5% de N)
+     * - la somme de la queue est accumulée tranche par tranche [k_i, k_{i+1}),
+     *   chaque élément de la queue n'est lu qu'une fois pour tous les niveaux
+     * 
+     * ATTENTION : scenarios est réordonné (pas de copie). Résultats dans
+     * l'ordre de confidence_levels ; (0, 0) si k ≥ N, ES = 0 si k = 0.
+     */
+    [[nodiscard]] static std::vector<std::pair<double, double>> calculate_var_es_in_place(
+        std::span<double> scenarios, std::span<const double> confidence_levels) {
         
-        // Pré-allocation du résultat
-        std::vector<std::pair<double, double>> results;
-        results.reserve(confidence_levels.size());
+        const size_t n = scenarios.size();
+        std::vector<std::pair<double, double>> results(confidence_levels.size(), {0.0, 0.0});
         
-        /*
-         * CALCUL POUR CHAQUE NIVEAU DE CONFIANCE
-         * =======================================
-         */
-        for (double confidence : confidence_levels) {
-            const size_t var_index = static_cast<size_t>((1.0 - confidence) * sorted_returns.size());
-            
-            // Vérification de sécurité
-            if (var_index >= sorted_returns.size()) {
-                results.emplace_back(0.0, 0.0);
-                continue;
+        // Niveaux valides, du plus grand k au plus petit
+        std::vector<std::pair<size_t, size_t>> ranks;  // (k, position dans confidence_levels)
+        ranks.reserve(confidence_levels.size());
+        for (size_t i = 0; i < confidence_levels.size(); ++i) {
+            const size_t k = static_cast<size_t>((1.0 - confidence_levels[i]) * n);
+            if (k < n) ranks.emplace_back(k, i);
+        }
+        std::sort(ranks.begin(), ranks.end(), std::greater<>());
+        
+        size_t bound = n;  // scenarios[0, bound) reste à partitionner
+        for (const auto& [k, level] : ranks) {
+            if (k < bound) {
+                std::nth_element(scenarios.begin(), scenarios.begin() + k, scenarios.begin() + bound);
+                bound = k;
             }
+            results[level].first = -scenarios[k];
+        }
+        
+        // Somme des queues : du plus petit k au plus grand, tranches disjointes
+        double tail_sum = 0.0;
+        size_t summed = 0;
+        for (auto it = ranks.rbegin(); it != ranks.rend(); ++it) {
+            const auto [k, level] = *it;
+            tail_sum = std::accumulate(scenarios.begin() + summed, scenarios.begin() + k, tail_sum);
+            summed = k;
+            results[level].second = k > 0 ? -tail_sum / k : 0.0;
+        }
+        
+        return results;
+    }
+    
+    // Version un seul niveau (ex: réplications bootstrap)
+    [[nodiscard]] static std::pair<double, double> calculate_var_es_in_place(
+        std::span<double> scenarios, double confidence) {
+        return calculate_var_es_in_place(scenarios, std::span<const double>(&confidence, 1))[0];
+    }
+    
+    /*
+     * STRUCTURE PAR TERME DE LA VaR/ES (MULTI-HORIZONS)
+     * =================================================
+     * VaR/ES du rendement S(h)/S(0) - 1 pour chaque horizon h, sur UN SEUL
+     * jeu de trajectoires GBM (les mêmes que simulate_gbm_paths avec ce flux).
+     * 
+     * Au lieu d'une matrice trajectoires × pas parcourue en colonnes :
+     * - les trajectoires avancent ensemble, pas par pas ("time-major") :
+     *   un seul vecteur de N prix courants, chocs (trajectoire, pas) générés
+     *   par blocs contigus de trajectoires
+     * - aux pas demandés, les N rendements sont copiés dans un tampon
+     * - dès que n_threads horizons sont en attente, leurs quantiles sont
+     *   calculés en parallèle (un horizon par thread, sélection O(N))
+     * 
+     * Mémoire : (1 + min(n_threads, H)) × N doubles, quel que soit n_steps
+     * 
+     * PARAMÈTRES :
+     * - horizons : pas à évaluer (vide = tous les pas 1..n_steps) ;
+     *   triés et dédoublonnés, les valeurs hors [1, n_steps] sont ignorées
+     * - confidence_levels : {0.95, 0.99, 0.995} par exemple
+     * - stream_id / first_path : comme simulate_gbm_paths
+     */
+    [[nodiscard]] std::vector<HorizonVarEs> calculate_var_es_term_structure(
+        double S0, double mu, double sigma, double T, size_t n_steps, size_t n_paths,
+        std::span<const size_t> horizons, std::span<const double> confidence_levels,
+        uint64_t stream_id = NEXT_STREAM, uint64_t first_path = 0) const {
+        
+        // Horizons valides, croissants
+        std::vector<size_t> steps;
+        if (horizons.empty()) {
+            steps.resize(n_steps);
+            std::iota(steps.begin(), steps.end(), size_t{1});
+        } else {
+            for (size_t h : horizons) {
+                if (h >= 1 && h <= n_steps) steps.push_back(h);
+            }
+            std::sort(steps.begin(), steps.end());
+            steps.erase(std::unique(steps.begin(), steps.end()), steps.end());
+        }
+        
+        std::vector<HorizonVarEs> results(steps.size());
+        if (steps.empty() || n_paths == 0) {
+            for (size_t i = 0; i < steps.size(); ++i) results[i].step = steps[i];
+            return results;
+        }
+        
+        const double dt = T / n_steps;
+        const double drift = (mu - 0.5 * sigma * sigma) * dt;
+        const double vol_sqrt_dt = sigma * std::sqrt(dt);
+        
+        stream_id = resolve_stream(stream_id);
+        const RandomStream stream(seed_, stream_id);
+        
+        const size_t n_buffers = std::min(std::max<size_t>(n_threads_, 1), steps.size());
+        std::vector<double> prices(n_paths, S0);            // Prix courant de chaque trajectoire
+        std::vector<double> returns(n_buffers * n_paths);   // Rendements des horizons en attente
+        
+        size_t next_horizon = 0;  // Prochain horizon à capturer
+        size_t first_pending = 0; // Premier horizon capturé mais pas encore évalué
+        
+        for (size_t step = 1; step <= steps.back(); ++step) {
+            const bool capture = steps[next_horizon] == step;
+            double* const slot = returns.data() + (next_horizon - first_pending) * n_paths;
             
-            // Calculs VaR et ES (même logique qu'avant)
-            const double var = -sorted_returns[var_index];
-            const double es = var_index > 0 
-                ? -std::accumulate(sorted_returns.begin(), 
-                                  sorted_returns.begin() + var_index, 0.0) / var_index
-                : 0.0;
-            
-            results.emplace_back(var, es);
             /*
-             * emplace_back = construit directement la paire dans le vector
-             * Plus efficace que push_back(make_pair(var, es))
+             * UN PAS DE TEMPS POUR TOUTES LES TRAJECTOIRES
+             * S ← S × exp(drift + vol√dt × Z(trajectoire, pas - 1))
+             * (même choc et même arithmétique que simulate_gbm_paths)
              */
+            parallel::for_each_block(n_paths, DRAWS_PER_BLOCK, n_threads_,
+                [&](size_t, size_t begin, size_t end) {
+                std::vector<double> shocks(end - begin);
+                stream.fill_normals_across_paths(shocks, first_path + begin, step - 1);
+                
+                for (size_t p = begin; p < end; ++p) {
+                    prices[p] = prices[p] * std::exp(drift + vol_sqrt_dt * shocks[p - begin]);
+                }
+                if (capture) {
+                    for (size_t p = begin; p < end; ++p) slot[p] = prices[p] / S0 - 1.0;
+                }
+            });
+            
+            if (!capture) continue;
+            ++next_horizon;
+            
+            // Tampon plein (ou dernier horizon) : quantiles des horizons en attente, en parallèle
+            const size_t n_pending = next_horizon - first_pending;
+            if (n_pending < n_buffers && next_horizon < steps.size()) continue;
+            
+            parallel::for_each_block(n_pending, 1, n_threads_,
+                [&](size_t, size_t begin, size_t end) {
+                for (size_t i = begin; i < end; ++i) {
+                    HorizonVarEs& horizon = results[first_pending + i];
+                    horizon.step = steps[first_pending + i];
+                    horizon.var_es = calculate_var_es_in_place(
+                        std::span<double>(returns.data() + i * n_paths, n_paths), confidence_levels);
+                }
+            });
+            first_pending = next_horizon;
         }
         
         return results;
-        /*
-         * EXEMPLE DE RÉSULTAT :
-         * [(VaR90%, ES90%), (VaR95%, ES95%), (VaR99%, ES99%)]
-         * [(2.1%, 2.8%), (3.0%, 3.9%), (4.5%, 5.7%)]
-         */
     }
     
     /*
-     * QUASI-MONTE CARLO (AVANCÉ)
-     * ==========================
-     * Placeholder pour une technique plus sophistiquée
+     * QUASI-MONTE CARLO : TRAJECTOIRES COMPLÈTES
+     * ==========================================
+     * Même sortie que simulate_gbm_paths, mais les chocs viennent d'une
+     * séquence de Sobol brouillée, assemblée par pont brownien
      */
-    void simulate_qmc_paths(std::span<double> paths, double S0, double mu, double sigma, 
-                           double T, size_t n_steps, size_t n_paths) const {
+    uint64_t simulate_qmc_paths(std::span<double> paths, double S0, double mu, double sigma, 
+                                double T, size_t n_steps, size_t n_paths,
+                                uint64_t stream_id = NEXT_STREAM, uint64_t first_path = 0) const {
         /*
          * QMC = Quasi-Monte Carlo
-         * Utilise des séquences "low-discrepancy" (Sobol, Halton) au lieu
+         * Utilise des séquences "low-discrepancy" (Sobol) au lieu
          * de nombres vraiment aléatoires pour une convergence plus rapide.
          * 
          * AVANTAGES :
-         * - Convergence en O(1/N) au lieu de O(1/√N)
+         * - Convergence proche de O(1/N) au lieu de O(1/√N)
          * - Moins de simulations nécessaires pour la même précision
          * 
-         * EN PRODUCTION :
-         * - Implémentation complète des séquences de Sobol
-         * - Gestion de la dimension (nombre de variables aléatoires)
+         * CONSTRUCTION :
+         * - Trajectoire n = point n de Sobol (first_path + path_idx)
+         * - Dimension d du point → d-ième nœud du pont brownien :
+         *   dimension 1 = prix final, dimension 2 = mi-parcours, etc.
+         * - Au-delà de SobolSequence::MAX_DIMENSION pas, les nœuds restants
+         *   (les plus fins, qui portent peu de variance) reçoivent des chocs
+         *   Philox : QMC "hybride"
+         * - Le flux stream_id fixe le brouillage : deux flux = deux
+         *   réplications indépendantes, sans biais
+         * 
+         * CONSEIL : n_paths = puissance de 2 (Sobol est équilibré par blocs de 2^k)
          */
+        const double dt = T / n_steps;
+        const double drift = (mu - 0.5 * sigma * sigma) * dt;
+        const double vol_sqrt_dt = sigma * std::sqrt(dt);
+        
+        stream_id = resolve_stream(stream_id);
+        const RandomStream stream(seed_, stream_id);
+        const SobolSequence sobol(n_steps, stream);
+        const BrownianBridge bridge(n_steps);
+        const size_t qmc_dims = std::min(sobol.dimension(), n_steps);
+        
+        parallel::for_each_block(n_paths, PATHS_PER_BLOCK, n_threads_,
+            [&](size_t, size_t block_begin, size_t block_end) {
+            std::vector<uint32_t> point(sobol.dimension());
+            std::vector<double> z(n_steps);  // Normales, dans l'ordre du pont
+            std::vector<double> w(n_steps);  // Mouvement brownien W_1..W_n (unités de √dt)
+            
+            // Saut direct au premier point du bloc, puis code de Gray
+            sobol.point_bits(first_path + block_begin, point);
+            
+            for (size_t path_idx = block_begin; path_idx < block_end; ++path_idx) {
+                const uint64_t global_idx = first_path + path_idx;
+                if (path_idx > block_begin) sobol.advance(point, global_idx);
+                
+                for (size_t d = 0; d < qmc_dims; ++d) {
+                    z[d] = FastMath::norm_inv(SobolSequence::to_uniform(point[d]));
+                }
+                if (n_steps > qmc_dims) {
+                    stream.fill_normals_along_path(std::span<double>(z).subspan(qmc_dims), global_idx, qmc_dims);
+                }
+                bridge.build(z, w);
+                
+                /*
+                 * S(t_s) = S0 × exp(drift × s + σ√dt × W_s)
+                 * Forme fermée à chaque date : pas d'accumulation d'erreurs
+                 */
+                const size_t base = path_idx * (n_steps + 1);
+                paths[base] = S0;
+                for (size_t step = 1; step <= n_steps; ++step) {
+                    paths[base + step] = S0 * std::exp(drift * static_cast<double>(step) + vol_sqrt_dt * w[step - 1]);
+                }
+            }
+        });
+        
+        return stream_id;
+    }
+    
+    /*
+     * QUASI-MONTE CARLO EN FLUX
+     * =========================
+     * Mêmes trajectoires que simulate_qmc_paths, repliées dans un
+     * accumulateur comme fold_gbm_paths (pas de matrice de trajectoires)
+     */
+    template<PathAccumulator Accumulator>
+    [[nodiscard]] PathStatistics fold_qmc_paths(const Accumulator& prototype, double S0, double mu, double sigma,
+                                                double T, size_t n_steps, size_t n_paths,
+                                                uint64_t stream_id = NEXT_STREAM, uint64_t first_path = 0,
+                                                bool antithetic = false) const {
+        const double dt = T / n_steps;
+        const double drift = (mu - 0.5 * sigma * sigma) * dt;
+        const double vol_sqrt_dt = sigma * std::sqrt(dt);
+        
+        stream_id = resolve_stream(stream_id);
+        const RandomStream stream(seed_, stream_id);
+        const SobolSequence sobol(n_steps, stream);
+        const BrownianBridge bridge(n_steps);
+        const size_t qmc_dims = std::min(sobol.dimension(), n_steps);
+        
+        PathStatistics stats = fold_path_blocks(n_paths,
+            [&](PathStatistics& block_stats, size_t block_begin, size_t block_end) {
+            Accumulator acc = prototype;
+            Accumulator mirror = prototype;  // Trajectoire antithétique : W → -W
+            std::vector<uint32_t> point(sobol.dimension());
+            std::vector<double> z(n_steps);
+            std::vector<double> w(n_steps);
+            
+            sobol.point_bits(first_path + block_begin, point);
+            
+            for (size_t path_idx = block_begin; path_idx < block_end; ++path_idx) {
+                const uint64_t global_idx = first_path + path_idx;
+                if (path_idx > block_begin) sobol.advance(point, global_idx);
+                
+                for (size_t d = 0; d < qmc_dims; ++d) {
+                    z[d] = FastMath::norm_inv(SobolSequence::to_uniform(point[d]));
+                }
+                if (n_steps > qmc_dims) {
+                    stream.fill_normals_along_path(std::span<double>(z).subspan(qmc_dims), global_idx, qmc_dims);
+                }
+                bridge.build(z, w);
+                
+                acc.reset(S0);
+                for (size_t step = 1; step <= n_steps; ++step) {
+                    acc.add(S0 * std::exp(drift * static_cast<double>(step) + vol_sqrt_dt * w[step - 1]));
+                }
+                
+                if (!antithetic) {
+                    record_path(block_stats, acc);
+                    continue;
+                }
+                
+                mirror.reset(S0);
+                for (size_t step = 1; step <= n_steps; ++step) {
+                    mirror.add(S0 * std::exp(drift * static_cast<double>(step) - vol_sqrt_dt * w[step - 1]));
+                }
+                record_pair(block_stats, acc, mirror);
+            }
+        });
+        
+        stats.stream_id = stream_id;
+        return stats;
+    }
+    
+    /*
+     * QUASI-MONTE CARLO : PRIX FINAUX SEULEMENT
+     * =========================================
+     * Pour options européennes : une seule dimension (van der Corput brouillée)
+     * Remplace simulate_final_prices quand on veut la précision QMC
+     */
+    uint64_t simulate_qmc_final_prices(std::span<double> final_prices, double S0, double mu, double sigma, double T,
+                                       uint64_t stream_id = NEXT_STREAM, uint64_t first_path = 0) const {
+        const double drift_term = (mu - 0.5 * sigma * sigma) * T;
+        const double vol_term = sigma * std::sqrt(T);
+        
+        stream_id = resolve_stream(stream_id);
+        const SobolSequence sobol(1, RandomStream(seed_, stream_id));
+        
+        parallel::for_each_block(final_prices.size(), DRAWS_PER_BLOCK, n_threads_,
+            [&](size_t, size_t begin, size_t end) {
+            uint32_t point = 0;
+            sobol.point_bits(first_path + begin, std::span<uint32_t>(&point, 1));
+            
+            for (size_t i = begin; i < end; ++i) {
+                if (i > begin) sobol.advance(std::span<uint32_t>(&point, 1), first_path + i);
+                const double Z = FastMath::norm_inv(SobolSequence::to_uniform(point));
+                final_prices[i] = S0 * std::exp(drift_term + vol_term * Z);
+            }
+        });
         
-        // Pour l'instant, fallback vers Monte Carlo classique
-        std::vector<double> paths_vec(paths.data(), paths.data() + paths.size());
-        simulate_gbm_paths(paths_vec, S0, mu, sigma, T, n_steps, n_paths);
-        std::copy(paths_vec.begin(), paths_vec.end(), paths.begin());
+        return stream_id;
     }
     
     /*
@@ -474,7 +1138,7 @@ public:
      * ===========================================
      */
     [[nodiscard]] size_t get_thread_count() const noexcept {
-        return thread_rngs_.size();
+        return n_threads_;
         /*
          * Utile pour :
          * - Diagnostics de performance
@@ -491,15 +1155,26 @@ public:
  * CLASSE MonteCarloEngine :
  * 1. SIMULATE_GBM_PATHS() : Simule des trajectoires de prix complètes
  * 2. SIMULATE_SINGLE_STEP_RETURNS() : Simule des rendements sur 1 période
- * 3. CALCULATE_VAR_ES() : Calcule VaR et Expected Shortfall
- * 4. CALCULATE_VAR_ES_BATCH() : VaR/ES pour plusieurs niveaux
- * 5. SIMULATE_QMC_PATHS() : Placeholder pour Quasi-Monte Carlo
+ * 3. FOLD_GBM_PATHS() / FOLD_QMC_PATHS() : Trajectoires repliées dans un
+ *    accumulateur (payoff path-dependent sans matrice de trajectoires)
+ * 4. SIMULATE_CORRELATED_RETURNS() : Rendements multi-actifs corrélés (Cholesky),
+ *    en structure de tableaux (une ligne contiguë par sous-jacent)
+ * 5. CALCULATE_VAR_ES() : Calcule VaR et Expected Shortfall
+ * 6. CALCULATE_VAR_ES_BATCH() : VaR/ES pour plusieurs niveaux
+ *    CALCULATE_VAR_ES_IN_PLACE() : même calcul sans copie (tableau réordonné)
+ *    CALCULATE_VAR_ES_TERM_STRUCTURE() : VaR/ES de tous les horizons en une
+ *    passe (trajectoires avancées pas par pas, quantiles par sélection)
+ * 7. SIMULATE_QMC_PATHS() / SIMULATE_QMC_FINAL_PRICES() : Quasi-Monte Carlo
+ *    (Sobol brouillé + pont brownien, quasi_random.hpp)
  * 
  * OPTIMISATIONS CLÉS :
- * - Générateurs aléatoires per-thread (évite les conflits)
+ * - Trajectoires réparties par blocs sur plusieurs threads (parallel_utils.hpp)
+ * - Générateur Philox adressé par (flux, trajectoire, pas) : résultat identique
+ *   quel que soit le nombre de threads, et rejeu d'une trajectoire isolée
  * - Pré-calcul des constantes (évite les calculs répétés)
  * - Templates pour flexibilité des conteneurs
- * - Tri unique pour calculs VaR multiples
+ * - VaR/ES par sélection (nth_element) en O(N), sans tri complet ni copie
+ *   si l'appelant autorise le réordonnancement
  * 
  * MODÈLE MATHÉMATIQUE :
  * - Geometric Brownian Motion : dS = μ×S×dt + σ×S×dW
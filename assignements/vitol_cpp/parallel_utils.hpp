@@ -0,0 +1,110 @@
+/*
+ * parallel_utils.hpp - Découpage du travail en blocs sur plusieurs threads
+ *
+ * Petit "pool" fork-join : on lance N workers, chacun réclame des blocs
+ * de travail via un compteur atomique jusqu'à épuisement, puis on rejoint.
+ *
+ * RÈGLE D'OR POUR LA REPRODUCTIBILITÉ :
+ * Le découpage en blocs dépend UNIQUEMENT de la taille du problème et de
+ * block_size, jamais du nombre de threads. Si chaque bloc écrit dans sa
+ * propre zone (ou produit un résultat partiel réduit dans l'ordre des blocs),
+ * le résultat est identique bit à bit avec 1 ou 64 threads.
+ */
+
+#pragma once
+
+#include <algorithm>   // Pour std::min, std::max
+#include <atomic>      // Pour le compteur de blocs partagé
+#include <exception>   // Pour propager les exceptions des workers
+#include <mutex>       // Pour protéger la première exception capturée
+#include <thread>      // Pour std::jthread, hardware_concurrency
+#include <vector>      // Pour stocker les workers
+
+namespace parallel {
+
+/*
+ * NOMBRE DE THREADS PAR DÉFAUT
+ * ============================
+ * hardware_concurrency() peut renvoyer 0 si l'info n'est pas disponible
+ */
+[[nodiscard]] inline size_t default_thread_count() noexcept {
+    const auto n = std::thread::hardware_concurrency();
+    return n > 0 ? n : 1;
+}
+
+/*
+ * NOMBRE DE BLOCS POUR n_items ÉLÉMENTS
+ * =====================================
+ */
+[[nodiscard]] inline size_t block_count(size_t n_items, size_t block_size) noexcept {
+    block_size = std::max<size_t>(block_size, 1);
+    return (n_items + block_size - 1) / block_size;
+}
+
+/*
+ * BOUCLE PARALLÈLE PAR BLOCS
+ * ==========================
+ * Appelle fn(block_idx, begin, end) pour chaque bloc [begin, end) de [0, n_items)
+ *
+ * - n_threads <= 1 ou un seul bloc → exécution séquentielle dans le thread appelant
+ * - Le thread appelant travaille aussi (n_threads - 1 threads supplémentaires)
+ * - Une exception levée dans un bloc arrête la distribution et est relancée ici
+ */
+template<typename BlockFn>
+void for_each_block(size_t n_items, size_t block_size, size_t n_threads, BlockFn&& fn) {
+    if (n_items == 0) return;
+    block_size = std::max<size_t>(block_size, 1);
+
+    const size_t n_blocks = block_count(n_items, block_size);
+    const size_t n_workers = std::min(std::max<size_t>(n_threads, 1), n_blocks);
+
+    auto run_block = [&](size_t block_idx) {
+        const size_t begin = block_idx * block_size;
+        const size_t end = std::min(begin + block_size, n_items);
+        fn(block_idx, begin, end);
+    };
+
+    // Cas séquentiel : pas de thread à créer
+    if (n_workers <= 1) {
+        for (size_t b = 0; b < n_blocks; ++b) run_block(b);
+        return;
+    }
+
+    std::atomic<size_t> next_block{0};
+    std::exception_ptr first_error;
+    std::mutex error_mutex;
+
+    auto worker = [&]() {
+        try {
+            for (size_t b = next_block.fetch_add(1); b < n_blocks; b = next_block.fetch_add(1)) {
+                run_block(b);
+            }
+        } catch (...) {
+            std::lock_guard lock(error_mutex);
+            if (!first_error) first_error = std::current_exception();
+            next_block.store(n_blocks);  // Les autres workers s'arrêtent au prochain bloc
+        }
+    };
+
+    {
+        std::vector<std::jthread> workers;
+        workers.reserve(n_workers - 1);
+        for (size_t i = 1; i < n_workers; ++i) {
+            workers.emplace_back(worker);
+        }
+        worker();  // Le thread appelant participe
+    }  // jthread = join automatique à la destruction
+
+    if (first_error) std::rethrow_exception(first_error);
+}
+
+} // namespace parallel
+
+/*
+ * USAGE TYPIQUE :
+ * std::vector<double> out(1'000'000);
+ * parallel::for_each_block(out.size(), 4096, parallel::default_thread_count(),
+ *     [&](size_t block_idx, size_t begin, size_t end) {
+ *         for (size_t i = begin; i < end; ++i) out[i] = compute(i);
+ *     });
+ */
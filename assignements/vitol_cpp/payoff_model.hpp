@@ -11,6 +11,7 @@
 #include <span>
 #include <algorithm>
 #include <numeric>
+#include <cmath>
 
 // ===== TYPES D'OPTIONS SUPPORTÉES =====
 enum class OptionType {
@@ -72,6 +73,108 @@ public:
         }
     }
 
+    /*
+     * ACCUMULATEUR DE PAYOFF EN FLUX
+     * ==============================
+     * Calcule le même payoff que calculate_payoff(), mais prix par prix,
+     * pendant que la trajectoire est générée : on ne garde que
+     * somme, maximum, minimum et prix final (quelques doubles au lieu
+     * de n_steps + 1). Satisfait le concept PathAccumulator.
+     * 
+     * reset(S0) → add(S1) → ... → add(Sn) → value() = payoff
+     * 
+     * Avec with_control = true, fournit aussi control() (variable de contrôle) :
+     * - européennes : le prix final S_T (espérance S0 × e^{rT})
+     * - asiatiques : le même payoff sur la moyenne GÉOMÉTRIQUE (formule fermée)
+     * - barrière, lookback, digitale : le call vanille de même strike (Black-Scholes)
+     */
+    class PayoffAccumulator {
+    private:
+        OptionType option_type_;
+        double K_;
+        double barrier_;
+        double payout_amount_;
+        
+        double sum_{0.0};     // Somme des prix (moyenne asiatique)
+        size_t count_{0};     // Nombre de prix observés
+        double max_{0.0};     // Maximum courant (lookback)
+        double min_{0.0};     // Minimum courant (barrière down-and-out : min ≤ B)
+        double last_{0.0};    // Dernier prix = S_final
+        
+        bool with_control_;
+        double log_sum_{0.0}; // Σ ln(S) (moyenne géométrique, si variable de contrôle)
+        
+        [[nodiscard]] bool is_asian() const noexcept {
+            return option_type_ == OptionType::ASIAN_CALL || option_type_ == OptionType::ASIAN_PUT;
+        }
+        
+    public:
+        explicit PayoffAccumulator(OptionType option_type, double K,
+                                   double barrier = 0.0, double payout_amount = 1.0,
+                                   bool with_control = false) noexcept
+            : option_type_(option_type), K_(K), barrier_(barrier), payout_amount_(payout_amount),
+              with_control_(with_control) {}
+        
+        void reset(double S0) noexcept {
+            sum_ = S0;
+            count_ = 1;
+            max_ = min_ = last_ = S0;
+            log_sum_ = (with_control_ && is_asian()) ? std::log(S0) : 0.0;
+        }
+        
+        void add(double price) noexcept {
+            sum_ += price;  // Même ordre de sommation que std::accumulate sur la trajectoire
+            ++count_;
+            max_ = std::max(max_, price);
+            min_ = std::min(min_, price);
+            last_ = price;
+            if (with_control_ && is_asian()) log_sum_ += std::log(price);  // Seulement si demandé
+        }
+        
+        [[nodiscard]] double value() const noexcept {
+            if (count_ == 0) return 0.0;
+            
+            switch (option_type_) {
+                case OptionType::EUROPEAN_CALL:
+                    return std::max(last_ - K_, 0.0);
+                case OptionType::EUROPEAN_PUT:
+                    return std::max(K_ - last_, 0.0);
+                case OptionType::ASIAN_CALL:
+                    return std::max(sum_ / count_ - K_, 0.0);
+                case OptionType::ASIAN_PUT:
+                    return std::max(K_ - sum_ / count_, 0.0);
+                case OptionType::BARRIER_CALL_KNOCKOUT:
+                    return min_ <= barrier_ ? 0.0 : std::max(last_ - K_, 0.0);
+                case OptionType::LOOKBACK_CALL:
+                    return std::max(max_ - K_, 0.0);
+                case OptionType::DIGITAL_CALL:
+                    return last_ > K_ ? payout_amount_ : 0.0;
+                default:
+                    return 0.0;
+            }
+        }
+        
+        /*
+         * VARIABLE DE CONTRÔLE (espérance connue en formule fermée)
+         * 0 si with_control = false
+         */
+        [[nodiscard]] double control() const noexcept {
+            if (!with_control_ || count_ == 0) return 0.0;
+            
+            switch (option_type_) {
+                case OptionType::EUROPEAN_CALL:
+                case OptionType::EUROPEAN_PUT:
+                    return last_;
+                case OptionType::ASIAN_CALL:
+                    return std::max(std::exp(log_sum_ / count_) - K_, 0.0);
+                case OptionType::ASIAN_PUT:
+                    return std::max(K_ - std::exp(log_sum_ / count_), 0.0);
+                default:
+                    return std::max(last_ - K_, 0.0);  // Call vanille
+            }
+        }
+    };
+
 private:
     /*
      * FONCTIONS PRIVÉES POUR PAYOFFS COMPLEXES
@@ -170,4 +273,11 @@ private:
  *     1000.0  // payout_amount
  * );
  * // Résultat: 1000.0 (car 110 > 105)
+ * 
+ * // Même payoff, en flux (sans stocker la trajectoire)
+ * PayoffModel::PayoffAccumulator acc(OptionType::ASIAN_CALL, 105.0);
+ * acc.reset(100);
+ * for (double S : {105, 110, 108, 112}) acc.add(S);
+ * double asian_stream = acc.value();
+ * // Résultat: 2.0 (identique à calculate_payoff)
  */
\ No newline at end of file
@@ -0,0 +1,413 @@
+/*
+ * portfolio_book.hpp - Portefeuille "compilé" en structure de tableaux
+ *
+ * Une Position porte deux std::string (instrument_id, underlying) : pratique
+ * pour l'utilisateur, mais chaque accès aux données de marché passe alors par
+ * un hachage de chaîne (unordered_map<std::string, ...>::at()).
+ * Dans une boucle de 10,000 scénarios × N positions, ce hachage coûte plus
+ * cher que le pricing lui-même.
+ *
+ * On "compile" donc une fois le portefeuille + les données de marché en
+ * un book dense :
+ * - chaque sous-jacent reçoit un identifiant entier (0, 1, 2...)
+ * - strike, maturité, notional, type : un tableau contigu chacun
+ * - spot, vol, corrélations : déjà résolus par identifiant
+ *
+ * Les boucles de risque ne voient plus que des entiers et des doubles.
+ */
+
+#pragma once
+
+#include "types.hpp"       // Position
+#include "math_utils.hpp"  // FastMath::fast_log, fast_norm_cdf (réévaluation)
+#include <string>          // Noms des sous-jacents (une seule fois par sous-jacent)
+#include <vector>          // Tableaux du book
+#include <span>            // Positions en entrée
+#include <set>             // Sous-jacents uniques et triés
+#include <algorithm>       // lower_bound, ranges::copy
+#include <cstdint>         // uint32_t, uint8_t
+#include <cmath>           // log, exp, sqrt
+#include <numeric>         // accumulate
+
+// ===== PORTEFEUILLE COMPILÉ (STRUCTURE DE TABLEAUX) =====
+/*
+ * Deux familles de tableaux, indexés différemment :
+ *
+ * PAR SOUS-JACENT (id = 0 .. n_underlyings() - 1, noms triés) :
+ *     underlyings[id], spots[id], vols[id], correlation[id_a × n + id_b]
+ *
+ * PAR POSITION (i = 0 .. size() - 1, positions valides seulement) :
+ *     underlying_ids[i], strikes[i], maturities[i], notionals[i], is_call[i]
+ *     position_index[i] = rang de la position dans le span d'origine
+ */
+struct CompiledBook {
+    // Sous-jacents
+    std::vector<std::string> underlyings;  // id → nom ("BRENT", "NATGAS", "WTI")
+    std::vector<double> spots;             // id → prix spot
+    std::vector<double> vols;              // id → volatilité
+    std::vector<double> correlation;       // n × n, ligne par ligne
+    double risk_free_rate{0.0};
+
+    // Positions
+    std::vector<uint32_t> underlying_ids;  // i → id du sous-jacent
+    std::vector<double> strikes;
+    std::vector<double> maturities;
+    std::vector<double> notionals;
+    std::vector<uint8_t> is_call;          // uint8_t plutôt que vector<bool> (accès direct)
+    std::vector<size_t> position_index;    // i → rang dans les positions d'origine
+
+    [[nodiscard]] size_t size() const noexcept { return strikes.size(); }
+    [[nodiscard]] bool empty() const noexcept { return strikes.empty(); }
+    [[nodiscard]] size_t n_underlyings() const noexcept { return underlyings.size(); }
+
+    // Données de marché déjà résolues pour la position i (aucun hachage)
+    [[nodiscard]] double spot(size_t i) const noexcept { return spots[underlying_ids[i]]; }
+    [[nodiscard]] double vol(size_t i) const noexcept { return vols[underlying_ids[i]]; }
+
+    /*
+     * COMPILATION : Positions + données de marché → book dense
+     * ========================================================
+     * Garde les positions valides dont les données de marché sont complètes
+     * (même filtre que PortfolioRiskCalculator), dans leur ordre d'origine.
+     * MarketData : PortfolioRiskCalculator::MarketData (spot_prices,
+     * volatilities, risk_free_rate, correlation(a, b)).
+     *
+     * all_market_underlyings = true : ids pour TOUS les sous-jacents ayant
+     * spot et vol, même sans position (RiskSession : un trade ajouté plus tard
+     * peut porter sur un sous-jacent encore absent du book).
+     *
+     * Seul endroit où les noms de sous-jacents sont hachés.
+     */
+    template<typename MarketData>
+    [[nodiscard]] static CompiledBook compile(std::span<const Position> positions,
+                                              const MarketData& market_data,
+                                              bool all_market_underlyings = false) {
+        CompiledBook book;
+        book.risk_free_rate = market_data.risk_free_rate;
+
+        const auto is_usable = [&](const Position& pos) {
+            return pos.is_valid() && market_data.is_complete_for_position(pos);
+        };
+
+        /*
+         * IDENTIFIANTS DES SOUS-JACENTS
+         * Ordre alphabétique (std::set) → ids stables d'un calcul à l'autre
+         */
+        std::set<std::string> names;
+        for (const auto& pos : positions) {
+            if (is_usable(pos)) names.insert(pos.underlying);
+        }
+        if (all_market_underlyings) {
+            for (const auto& [name, spot] : market_data.spot_prices) {
+                if (market_data.volatilities.contains(name)) names.insert(name);
+            }
+        }
+        book.underlyings.assign(names.begin(), names.end());
+
+        const size_t n = book.underlyings.size();
+        book.spots.resize(n);
+        book.vols.resize(n);
+        book.correlation.resize(n * n);
+        for (size_t a = 0; a < n; ++a) {
+            book.spots[a] = market_data.spot_prices.at(book.underlyings[a]);
+            book.vols[a] = market_data.volatilities.at(book.underlyings[a]);
+            for (size_t b = 0; b < n; ++b) {
+                book.correlation[a * n + b] = market_data.correlation(book.underlyings[a], book.underlyings[b]);
+            }
+        }
+
+        /*
+         * COLONNES DES POSITIONS
+         */
+        book.reserve(positions.size());
+        for (size_t p = 0; p < positions.size(); ++p) {
+            if (is_usable(positions[p])) book.append_position(positions[p], p);
+        }
+
+        return book;
+    }
+
+    /*
+     * MISE À JOUR INCRÉMENTALE DES COLONNES (RiskSession)
+     * ===================================================
+     * Le sous-jacent doit déjà avoir un id (find_underlying() < n_underlyings()).
+     * - append_position : ajoute en fin (index = rang d'origine, informatif)
+     * - assign_position : remplace la position i sur place
+     * - swap_remove : retire la position i en y déplaçant la dernière, O(1)
+     *   (l'ordre des positions n'est donc pas conservé)
+     */
+    void append_position(const Position& pos, size_t index) {
+        underlying_ids.push_back(static_cast<uint32_t>(find_underlying(pos.underlying)));
+        strikes.push_back(pos.strike);
+        maturities.push_back(pos.maturity);
+        notionals.push_back(pos.notional);
+        is_call.push_back(pos.is_call ? 1 : 0);
+        position_index.push_back(index);
+    }
+
+    void assign_position(size_t i, const Position& pos) noexcept {
+        underlying_ids[i] = static_cast<uint32_t>(find_underlying(pos.underlying));
+        strikes[i] = pos.strike;
+        maturities[i] = pos.maturity;
+        notionals[i] = pos.notional;
+        is_call[i] = pos.is_call ? 1 : 0;
+    }
+
+    void swap_remove(size_t i) noexcept {
+        const size_t last = size() - 1;
+        underlying_ids[i] = underlying_ids[last]; underlying_ids.pop_back();
+        strikes[i] = strikes[last];               strikes.pop_back();
+        maturities[i] = maturities[last];         maturities.pop_back();
+        notionals[i] = notionals[last];           notionals.pop_back();
+        is_call[i] = is_call[last];               is_call.pop_back();
+        position_index[i] = position_index[last]; position_index.pop_back();
+    }
+
+    /*
+     * ID D'UN SOUS-JACENT PAR SON NOM (recherche dichotomique, hors boucles chaudes)
+     * n_underlyings() si absent
+     */
+    [[nodiscard]] size_t find_underlying(const std::string& name) const noexcept {
+        const auto it = std::lower_bound(underlyings.begin(), underlyings.end(), name);
+        return (it != underlyings.end() && *it == name)
+            ? static_cast<size_t>(it - underlyings.begin()) : underlyings.size();
+    }
+
+private:
+    void reserve(size_t n) {
+        underlying_ids.reserve(n);
+        strikes.reserve(n);
+        maturities.reserve(n);
+        notionals.reserve(n);
+        is_call.reserve(n);
+        position_index.reserve(n);
+    }
+};
+
+// ===== INVARIANTS DE RÉÉVALUATION (PAR POSITION) =====
+/*
+ * Dans une VaR "full revaluation", seul le spot change d'un scénario à
+ * l'autre : strike, maturité, taux et vol sont fixes. Tout ce qui n'en
+ * dépend pas est calculé UNE fois par calcul de risque :
+ *     d1 = (ln S - ln K + (r + σ²/2)T) / (σ√T),   d2 = d1 - σ√T
+ *     call = S N(d1) - K e^{-rT} N(d2),           put = K e^{-rT} N(-d2) - S N(-d1)
+ * Par scénario il ne reste qu'un log et deux N(x) par position, calculés
+ * avec les noyaux sans branchement de FastMath : la boucle sur une bande de
+ * scénarios (scenario_pnl) est vectorisée par le compilateur.
+ *
+ * Même formule que BlackScholesModel::price, sans validation, sans
+ * expected<> et sans cache ; les positions que price() refuserait
+ * (vol ≤ 0) valent 0, comme lorsque l'appelant ignorait l'erreur.
+ */
+struct RevaluationInvariants {
+    std::vector<double> log_strikes;        // ln K
+    std::vector<double> drifts;             // (r + σ²/2) × T
+    std::vector<double> vol_sqrt_t;         // σ√T
+    std::vector<double> discounted_strikes; // K × e^{-rT}
+    std::vector<uint8_t> priceable;         // 0 si vol ≤ 0 (prix ignoré)
+    std::vector<double> base_values;        // Notional × prix au spot de base
+    double base_value{0.0};                 // Σ base_values (valeur du portefeuille)
+
+    [[nodiscard]] static RevaluationInvariants compute(const CompiledBook& book) {
+        RevaluationInvariants inv;
+        inv.resize(book.size());
+        for (size_t i = 0; i < book.size(); ++i) {
+            inv.assign(book, i);
+        }
+        inv.base_value = std::accumulate(inv.base_values.begin(), inv.base_values.end(), 0.0);
+        return inv;
+    }
+
+    /*
+     * INVARIANTS DE LA SEULE POSITION i (tableaux déjà à la bonne taille)
+     * Utilisé par compute() et par les mises à jour incrémentales ;
+     * base_value (la somme) n'est PAS mis à jour ici.
+     */
+    void assign(const CompiledBook& book, size_t i) noexcept {
+        const double r = book.risk_free_rate;
+        const double vol = book.vol(i);
+        const double T = book.maturities[i];
+        log_strikes[i] = std::log(book.strikes[i]);
+        drifts[i] = (r + 0.5 * vol * vol) * T;
+        vol_sqrt_t[i] = vol * std::sqrt(T);
+        discounted_strikes[i] = book.strikes[i] * std::exp(-r * T);
+        priceable[i] = vol > 0.0 ? 1 : 0;
+
+        // Valeur de base avec le MÊME noyau que les scénarios → P&L nul sans choc
+        base_values[i] = value(book, i, book.spot(i));
+    }
+
+    void resize(size_t n) {
+        log_strikes.resize(n);
+        drifts.resize(n);
+        vol_sqrt_t.resize(n);
+        discounted_strikes.resize(n);
+        priceable.resize(n);
+        base_values.resize(n);
+    }
+
+    // Même permutation que CompiledBook::swap_remove
+    void swap_remove(size_t i) noexcept {
+        const size_t last = base_values.size() - 1;
+        log_strikes[i] = log_strikes[last];
+        drifts[i] = drifts[last];
+        vol_sqrt_t[i] = vol_sqrt_t[last];
+        discounted_strikes[i] = discounted_strikes[last];
+        priceable[i] = priceable[last];
+        base_values[i] = base_values[last];
+        resize(last);
+    }
+
+    /*
+     * VALEUR DE LA POSITION i POUR UN SPOT S (notional inclus)
+     */
+    [[nodiscard]] double value(const CompiledBook& book, size_t i, double S) const noexcept {
+        if (!priceable[i] || S <= 0.0) return 0.0;
+
+        const bool is_call = book.is_call[i] != 0;
+        if (book.maturities[i] == 0.0) {  // Expiration : valeur intrinsèque
+            const double K = book.strikes[i];
+            return book.notionals[i] * (is_call ? std::max(S - K, 0.0) : std::max(K - S, 0.0));
+        }
+
+        return book.notionals[i] * unit_price(S, log_strikes[i], drifts[i], vol_sqrt_t[i],
+                                              discounted_strikes[i], is_call ? 1.0 : -1.0);
+    }
+
+    /*
+     * P&L DE LA POSITION i SUR UNE BANDE DE SCÉNARIOS
+     * ===============================================
+     * pnl[k] = valeur(S × (1 + shocks[k])) - base_values[i]
+     *
+     * Les cas particuliers sont traités UNE fois par position (hors boucle) ;
+     * dans la boucle, S ≤ 0 est masqué par sélection → aucune branche,
+     * même noyau que value() donc P&L exactement nul sans choc.
+     */
+    void scenario_pnl(const CompiledBook& book, size_t i,
+                      std::span<const double> shocks, std::span<double> pnl) const noexcept {
+        const double S_base = book.spot(i);
+        const double base = base_values[i];
+
+        if (!priceable[i] || book.maturities[i] == 0.0) {  // Rare : pas de Black-Scholes
+            for (size_t k = 0; k < shocks.size(); ++k) {
+                pnl[k] = value(book, i, S_base * (1.0 + shocks[k])) - base;
+            }
+            return;
+        }
+
+        // Invariants de la position en registres
+        const double notional = book.notionals[i];
+        const double w = book.is_call[i] ? 1.0 : -1.0;
+        const double log_k = log_strikes[i];
+        const double drift = drifts[i];
+        const double vst = vol_sqrt_t[i];
+        const double discounted_k = discounted_strikes[i];
+
+        for (size_t k = 0; k < shocks.size(); ++k) {
+            const double S = S_base * (1.0 + shocks[k]);
+            const bool alive = S > 0.0;
+            const double price = notional * unit_price(alive ? S : 1.0, log_k, drift, vst, discounted_k, w);
+            pnl[k] = (alive ? price : 0.0) - base;
+        }
+    }
+
+private:
+    /*
+     * PRIX BLACK-SCHOLES UNITAIRE (S > 0, T > 0), w = +1 call / -1 put
+     * w × (S N(w d1) - K e^{-rT} N(w d2)) : call et put sans branchement
+     */
+    [[nodiscard]] static double unit_price(double S, double log_k, double drift, double vst,
+                                           double discounted_k, double w) noexcept {
+        const double d1 = (FastMath::fast_log(S) - log_k + drift) / vst;
+        const double d2 = d1 - vst;
+        return w * (S * FastMath::fast_norm_cdf(w * d1) - discounted_k * FastMath::fast_norm_cdf(w * d2));
+    }
+};
+
+// ===== MATRICE DES P&L PAR POSITION ET PAR SCÉNARIO =====
+/*
+ * pnl[position × n_scenarios + scénario] : une ligne contiguë par position
+ * (même disposition que les rendements simulés par sous-jacent).
+ * Conservée pour les analyses a posteriori : contribution de chaque
+ * position à la queue, mise à jour incrémentale, VaR d'un sous-book...
+ *
+ * Mémoire : n_positions × n_scenarios doubles (1,000 × 10,000 = 80 MB)
+ * → optionnelle, la VaR seule n'a besoin que des sommes par scénario.
+ */
+struct ScenarioPnLMatrix {
+    size_t n_positions{0};
+    size_t n_scenarios{0};
+    std::vector<double> pnl;
+
+    ScenarioPnLMatrix() = default;
+    ScenarioPnLMatrix(size_t positions, size_t scenarios)
+        : n_positions(positions), n_scenarios(scenarios), pnl(positions * scenarios, 0.0) {}
+
+    [[nodiscard]] std::span<double> row(size_t position) noexcept {
+        return {pnl.data() + position * n_scenarios, n_scenarios};
+    }
+    [[nodiscard]] std::span<const double> row(size_t position) const noexcept {
+        return {pnl.data() + position * n_scenarios, n_scenarios};
+    }
+    [[nodiscard]] double at(size_t position, size_t scenario) const noexcept {
+        return pnl[position * n_scenarios + scenario];
+    }
+
+    // Mises à jour incrémentales (mêmes permutations que CompiledBook)
+    void append_row() {
+        pnl.resize(pnl.size() + n_scenarios, 0.0);
+        ++n_positions;
+    }
+    void swap_remove(size_t position) noexcept {
+        const size_t last = n_positions - 1;
+        if (position != last) std::ranges::copy(row(last), row(position).begin());
+        pnl.resize(last * n_scenarios);
+        n_positions = last;
+    }
+
+    /*
+     * REGROUPEMENT DES LIGNES (ex: P&L par sous-jacent)
+     * groups[p] = groupe de la ligne p (< n_groups), lignes sommées dans l'ordre
+     * matrix.aggregate(book.underlying_ids, book.n_underlyings())
+     */
+    [[nodiscard]] ScenarioPnLMatrix aggregate(std::span<const uint32_t> groups, size_t n_groups) const {
+        ScenarioPnLMatrix grouped(n_groups, n_scenarios);
+        for (size_t p = 0; p < n_positions; ++p) {
+            const auto pnl_row = row(p);
+            const auto group_row = grouped.row(groups[p]);
+            for (size_t s = 0; s < n_scenarios; ++s) group_row[s] += pnl_row[s];
+        }
+        return grouped;
+    }
+
+    // P&L du portefeuille par scénario (somme des lignes, positions dans l'ordre)
+    [[nodiscard]] std::vector<double> portfolio_pnl() const {
+        std::vector<double> total(n_scenarios, 0.0);
+        for (size_t p = 0; p < n_positions; ++p) {
+            const auto pnl_row = row(p);
+            for (size_t s = 0; s < n_scenarios; ++s) total[s] += pnl_row[s];
+        }
+        return total;
+    }
+};
+
+/*
+ * USAGE TYPIQUE :
+ * ===============
+ *
+ * const auto book = CompiledBook::compile(positions, market_data);
+ *
+ * for (size_t i = 0; i < book.size(); ++i) {
+ *     const double S = book.spot(i);        // Pas de market_data.spot_prices.at(...)
+ *     const double vol = book.vol(i);
+ *     ... bs.price(S, book.strikes[i], book.maturities[i], book.risk_free_rate, vol, book.is_call[i]) ...
+ * }
+ *
+ * // Rendements simulés par sous-jacent : ligne underlying_ids[i]
+ * const double shock = returns[book.underlying_ids[i] * n_scenarios + s];
+ *
+ * // Réévaluation : invariants une fois, puis un spot par scénario
+ * const auto inv = RevaluationInvariants::compute(book);
+ * const double pnl = inv.value(book, i, book.spot(i) * (1.0 + shock)) - inv.base_values[i];
+ * inv.scenario_pnl(book, i, shock_strip, pnl_strip);  // Bande de scénarios (vectorisée)
+ */
@@ -12,17 +12,79 @@
 #pragma once
 
 #include "types.hpp"          // Types de base (Position, expected, etc.)
-#include "pricing_models.hpp" // BlackScholesModel pour le pricing
+#include "pricing_models.hpp" // BlackScholesModel : greeks par lots (ExtendedGreeks)
 #include "monte_carlo.hpp"    // MonteCarloEngine pour les simulations VaR
+#include "portfolio_book.hpp" // CompiledBook : portefeuille en structure de tableaux
+#include "risk_attribution.hpp" // Contributions VaR/ES par position ou sous-jacent
+#include "pricing_proxy.hpp"    // Réévaluation par proxy de Chebyshev
+#include "historical_simulation.hpp" // Historiques de rendements (VaR historique)
+#include "stress_testing.hpp"  // Scénarios de stress multi-facteurs
+#include "parallel_utils.hpp" // Découpage scénarios × positions sur plusieurs threads
 #include <unordered_map>      // Pour grouper par sous-jacent
 #include <vector>             // Pour listes de positions
+#include <array>              // Tampons de bande (noyaux vectorisés)
 #include <future>             // Pour calculs asynchrones
 #include <set>                // Pour collections uniques (sous-jacents)
 #include <span>               // Pour manipulation sûre de tableaux
+#include <optional>           // Erreur éventuelle du calcul de VaR
 #include <algorithm>          // Pour filtrage, copie, etc.
-#include <execution>          // Pour parallélisation (pas utilisé)
 #include <ranges>             // Pour manipulation moderne des données
 
+// ===== CONFIGURATION DU CALCUL DE RISQUE =====
+/*
+ * MÉTHODE DE CALCUL DE LA VaR
+ * - FULL_REVALUATION : chaque position repricée (Black-Scholes) dans chaque scénario
+ *   → exacte, coût positions × scénarios
+ * - DELTA_GAMMA : P&L ≈ Δ × dS + ½ Γ × dS², avec Δ et Γ agrégés par sous-jacent
+ *   (déjà calculés par les Greeks) → quelques FMA par sous-jacent et par scénario,
+ *   VaR intraday en millisecondes ; approximation valable pour de petits chocs
+ * - CHEBYSHEV_PROXY : P&L de chaque sous-jacent interpolé sur une quinzaine de
+ *   spots (nœuds de Chebyshev sur la plage des chocs), puis évalué dans chaque
+ *   scénario → quelques prix par position, erreur contrôlée (proxy_tolerance)
+ *   et rapportée (ProxyFitReport), y compris pour de grands chocs
+ * 
+ * Les scénarios ne choquent que les spots (vol, taux et maturités fixes) :
+ * termes vega et theta nuls, comme dans la réévaluation complète.
+ */
+enum class VarMethod {
+    FULL_REVALUATION,
+    DELTA_GAMMA,
+    CHEBYSHEV_PROXY
+};
+
+/*
+ * PARAMÈTRES DU CALCUL (paramètre optionnel de calculate_portfolio_risk)
+ */
+struct RiskConfig {
+    VarMethod var_method{VarMethod::FULL_REVALUATION};
+    size_t n_simulations{10'000};    // Nombre de scénarios simulés
+    double horizon{1.0 / 252.0};     // Horizon de la VaR (1 jour de trading)
+    size_t error_sample_size{0};     // DELTA_GAMMA / CHEBYSHEV_PROXY : scénarios aussi réévalués
+                                     // complètement pour mesurer l'erreur d'approximation (0 = aucun)
+    double proxy_tolerance{1e-6};    // CHEBYSHEV_PROXY : écart max du proxy de chaque sous-jacent,
+                                     // en fraction de l'exposition brute Σ |notional| × spot
+                                     // (au-dessus du bruit de fast_norm_cdf, cf. ChebyshevProxy)
+    AttributionLevel attribution{AttributionLevel::NONE};  // Contributions VaR/ES par ligne
+    double attribution_confidence{0.99};                   // Niveau de la VaR/ES décomposée
+    bool keep_scenario_pnl{false};   // Conserver dans RiskMetrics les lignes de P&L
+                                     // de l'attribution (ex: VaR d'un sous-book ensuite)
+};
+
+/*
+ * ERREUR DE L'APPROXIMATION (DELTA-GAMMA OU PROXY)
+ * ================================================
+ * Comparaison, sur un échantillon de scénarios, du rendement approché et du
+ * rendement en réévaluation complète (mêmes unités que la VaR : fraction de
+ * la valeur du portefeuille)
+ */
+struct VarApproximationError {
+    size_t n_sampled{0};             // Scénarios comparés (0 = pas de comparaison)
+    double mean_error{0.0};          // Biais moyen (approché - exact)
+    double rms_error{0.0};           // Erreur quadratique moyenne
+    double max_abs_error{0.0};       // Pire écart
+    double tail_max_abs_error{0.0};  // Pire écart dans la queue à 99% (selon l'exact)
+};
+
 // ===== CALCULATEUR DE RISQUE PORTEFEUILLE =====
 /*
  * Cette classe est le "cerveau central" qui coordonne tous les calculs
@@ -35,13 +97,28 @@ private:
      * ===========================
      * La classe contient les outils spécialisés nécessaires
      */
-    BlackScholesModel bs_model_;  // Pour pricer chaque position individuelle
     MonteCarloEngine mc_engine_;  // Pour simuler les scénarios de risque
     /*
      * Approche "composition" : au lieu d'hériter, on contient les outils
      * Plus flexible et évite les problèmes d'héritage multiple
      */
     
+    /*
+     * PARALLÉLISATION DE LA RÉÉVALUATION
+     * ==================================
+     * La matrice scénarios × positions est découpée en tuiles
+     * (SCENARIOS_PER_BLOCK × POSITIONS_PER_BLOCK) réparties sur n_threads_.
+     * Le découpage ne dépend que de la taille du problème : chaque tuile
+     * accumule dans sa propre zone, puis les zones sont sommées dans l'ordre
+     * des blocs de positions → résultat identique avec 1 ou 64 threads.
+     * 
+     * 4096 scénarios × 8 octets = 32 Ko : la ligne de chocs d'un sous-jacent
+     * et l'accumulateur de la tuile tiennent dans le cache L1/L2.
+     */
+    static constexpr size_t SCENARIOS_PER_BLOCK = 4096;
+    static constexpr size_t POSITIONS_PER_BLOCK = 256;
+    size_t n_threads_{parallel::default_thread_count()};
+    
 public:
     /*
      * STRUCTURE POUR TOUTES LES MÉTRIQUES DE RISQUE
@@ -69,6 +146,11 @@ public:
         std::unordered_map<std::string, double> gamma_by_underlying;
         std::unordered_map<std::string, double> vega_by_underlying;
         std::unordered_map<std::string, double> theta_by_underlying;
+        std::unordered_map<std::string, double> rho_by_underlying;    // Pour +1% de taux
+        std::unordered_map<std::string, double> vanna_by_underlying;  // dDelta pour +1% de vol
+        std::unordered_map<std::string, double> volga_by_underlying;  // dVega pour +1% de vol
+        std::unordered_map<std::string, double> charm_by_underlying;  // dDelta par jour
+        std::unordered_map<std::string, double> speed_by_underlying;  // dGamma pour +1$
         /*
          * EXEMPLE de delta_by_underlying :
          * {
@@ -81,8 +163,39 @@ public:
          * - Risk manager voit l'exposition par marché
          * - Facilite les décisions de hedging
          * - Surveillance des limites par sous-jacent
+         * 
+         * ORDRE SUPÉRIEUR (vanna, volga, charm, speed) :
+         * - Vanna/volga : comment le delta et le vega bougent avec la vol
+         *   (risque de smile, coût de re-hedge d'un choc de vol)
+         * - Charm : dérive du delta d'ici demain sans mouvement de marché
+         * - Speed : le gamma lui-même change avec le spot (gros mouvements)
          */
         
+        // Publie / retire les Greeks (notional inclus) d'un sous-jacent dans toutes les maps
+        void set_greeks(const std::string& underlying, const BlackScholesModel::ExtendedGreeks& g) {
+            delta_by_underlying[underlying] = g.delta;
+            gamma_by_underlying[underlying] = g.gamma;
+            vega_by_underlying[underlying] = g.vega;
+            theta_by_underlying[underlying] = g.theta;
+            rho_by_underlying[underlying] = g.rho;
+            vanna_by_underlying[underlying] = g.vanna;
+            volga_by_underlying[underlying] = g.volga;
+            charm_by_underlying[underlying] = g.charm;
+            speed_by_underlying[underlying] = g.speed;
+        }
+        
+        void erase_greeks(const std::string& underlying) {
+            delta_by_underlying.erase(underlying);
+            gamma_by_underlying.erase(underlying);
+            vega_by_underlying.erase(underlying);
+            theta_by_underlying.erase(underlying);
+            rho_by_underlying.erase(underlying);
+            vanna_by_underlying.erase(underlying);
+            volga_by_underlying.erase(underlying);
+            charm_by_underlying.erase(underlying);
+            speed_by_underlying.erase(underlying);
+        }
+        
         /*
          * VAR/ES À DIFFÉRENTS NIVEAUX DE CONFIANCE
          * =========================================
@@ -107,6 +220,12 @@ public:
          */
         size_t calculation_time_us{0};      // Temps de calcul en microsecondes
         size_t monte_carlo_simulations{0};  // Nombre de simulations utilisées
+        VarMethod var_method{VarMethod::FULL_REVALUATION};  // Méthode utilisée pour la VaR
+        std::optional<RiskError> var_error;  // INVALID_CORRELATION : VaR/ES non calculées (restent à 0)
+        VarApproximationError var_approximation_error;     // Rempli en DELTA_GAMMA / CHEBYSHEV_PROXY si demandé
+        ProxyFitReport proxy_fit;      // CHEBYSHEV_PROXY (holdout_error en fraction de l'exposition brute)
+        RiskAttribution attribution;   // Rempli si config.attribution != NONE
+        ScenarioPnLMatrix scenario_pnl; // Lignes de l'attribution, si config.keep_scenario_pnl
         /*
          * UTILITÉ :
          * - Monitoring de performance du système
@@ -124,6 +243,12 @@ public:
         std::unordered_map<std::string, double> spot_prices;  // Prix actuels par sous-jacent
         std::unordered_map<std::string, double> volatilities; // Volatilités par sous-jacent
         double risk_free_rate{0.05};  // Taux sans risque (5% par défaut)
+        std::unordered_map<std::string, std::unordered_map<std::string, double>> correlations;
+        /*
+         * correlations["WTI"]["BRENT"] = 0.92 : corrélation des rendements quotidiens
+         * Une seule des deux entrées (WTI→BRENT ou BRENT→WTI) suffit ;
+         * paire absente = corrélation nulle (sous-jacents indépendants)
+         */
         /*
          * EXEMPLE de contenu :
          * spot_prices = {
@@ -156,8 +281,36 @@ public:
              * Si l'un des deux manque → position invalide
              */
         }
+        
+        /*
+         * CORRÉLATION ENTRE DEUX SOUS-JACENTS
+         * ===================================
+         * Symétrique, 1 sur la diagonale, 0 si la paire n'est pas renseignée
+         */
+        [[nodiscard]] double correlation(const std::string& a, const std::string& b) const noexcept {
+            if (a == b) return 1.0;
+            if (const auto row = correlations.find(a); row != correlations.end()) {
+                if (const auto it = row->second.find(b); it != row->second.end()) return it->second;
+            }
+            if (const auto row = correlations.find(b); row != correlations.end()) {
+                if (const auto it = row->second.find(a); it != row->second.end()) return it->second;
+            }
+            return 0.0;
+        }
     };
     
+    /*
+     * MODE D'EXÉCUTION
+     * ================
+     * Nombre de threads pour les Greeks, la réévaluation et la simulation
+     * (transmis au moteur Monte Carlo). Résultats identiques quel que soit ce réglage.
+     */
+    void set_thread_count(size_t n_threads) noexcept {
+        n_threads_ = std::max<size_t>(n_threads, 1);
+        mc_engine_.set_thread_count(n_threads_);
+    }
+    [[nodiscard]] size_t thread_count() const noexcept { return n_threads_; }
+    
     /*
      * CALCUL DE RISQUE ASYNCHRONE
      * ===========================
@@ -165,14 +318,15 @@ public:
      */
     [[nodiscard]] std::future<RiskMetrics> calculate_portfolio_risk_async(
         std::span<const Position> positions,
-        const MarketData& market_data) const {
+        const MarketData& market_data,
+        const RiskConfig& config = {}) const {
         /*
          * std::future<RiskMetrics> = "promesse" d'un résultat futur
          * Comme commander une pizza : on reçoit un ticket, la pizza arrive plus tard
          */
         
         return std::async(std::launch::async, [=, this]() {
-            return calculate_portfolio_risk(positions, market_data);
+            return calculate_portfolio_risk(positions, market_data, config);
         });
         /*
          * std::async = lance une fonction dans un thread séparé
@@ -193,7 +347,8 @@ public:
      */
     [[nodiscard]] RiskMetrics calculate_portfolio_risk(
         std::span<const Position> positions,     // Toutes les positions du portefeuille
-        const MarketData& market_data) const {   // Données de marché actuelles
+        const MarketData& market_data,           // Données de marché actuelles
+        const RiskConfig& config = {}) const {   // Méthode VaR, nombre de scénarios, horizon
         
         /*
          * CHRONOMÉTRAGE DE PERFORMANCE
@@ -209,12 +364,13 @@ public:
         RiskMetrics metrics;  // Structure de résultats à remplir
         
         /*
-         * ÉTAPE 1 : VALIDATION ET FILTRAGE
-         * =================================
-         * On ne garde que les positions qu'on peut calculer
+         * ÉTAPE 1 : VALIDATION, FILTRAGE ET COMPILATION DU BOOK
+         * ======================================================
+         * On ne garde que les positions qu'on peut calculer, et on résout
+         * une fois pour toutes les données de marché de chaque position
          */
-        const auto valid_positions = filter_valid_positions(positions, market_data);
-        if (valid_positions.empty()) {
+        const auto book = CompiledBook::compile(positions, market_data);
+        if (book.empty()) {
             return metrics; // Retourne des métriques vides si rien à calculer
         }
         /*
@@ -224,21 +380,30 @@ public:
          * - Position invalide (strike négatif) → skip
          * 
          * Évite que tout le calcul plante à cause d'une mauvaise position
+         * 
+         * POURQUOI COMPILER ?
+         * Les étapes suivantes bouclent sur des tableaux de doubles indexés
+         * par entiers : plus aucun hachage de std::string dans les boucles
          */
         
         /*
-         * ÉTAPE 2 : CALCUL DES GREEKS DU PORTEFEUILLE
-         * ============================================
-         * Sensibilités agrégées aux paramètres de marché
+         * ÉTAPE 2 : VALEUR ET GREEKS DU PORTEFEUILLE
+         * ==========================================
+         * Valeurs de base et invariants Black-Scholes calculés une seule fois,
+         * partagés par la valorisation et la réévaluation des scénarios ;
+         * sensibilités agrégées aux paramètres de marché
          */
-        calculate_portfolio_greeks(valid_positions, market_data, metrics);
+        const auto invariants = RevaluationInvariants::compute(book);
+        metrics.portfolio_value = invariants.base_value;
+        calculate_portfolio_greeks(book, metrics);
         
         /*
          * ÉTAPE 3 : CALCUL DU VAR MONTE CARLO
          * ====================================
          * Simulation de milliers de scénarios pour estimer le risque
+         * (réévaluation complète, ou approximation delta-gamma sur les Greeks de l'étape 2)
          */
-        calculate_monte_carlo_var(valid_positions, market_data, metrics);
+        calculate_monte_carlo_var(book, invariants, positions, config, metrics);
         
         /*
          * ÉTAPE 4 : ENREGISTREMENT DES MÉTRIQUES DE PERFORMANCE
@@ -257,6 +422,123 @@ public:
         return metrics;  // Retourne tous les résultats
     }
     
+    /*
+     * VAR HISTORIQUE (SIMPLE OU FILTRÉE)
+     * ==================================
+     * Mêmes étapes que calculate_portfolio_risk, mais les scénarios sont les
+     * rendements observés de history (un scénario par date) au lieu de
+     * rendements GBM simulés : même book compilé, même réévaluation complète
+     * (revalue_scenarios), mêmes quantiles (store_var_es).
+     * 
+     * L'historique est lu par blocs de config.block_dates dates : chaque bloc
+     * est réévalué puis oublié, seul le P&L par date est conservé.
+     * FILTERED_HISTORICAL lit l'historique deux fois : un premier passage
+     * pour la volatilité EWMA courante, un second pour les résidus.
+     * 
+     * ERREUR : MISSING_MARKET_DATA si un sous-jacent du book n'a pas d'historique
+     * (monte_carlo_simulations = nombre de dates rejouées ; l'horizon de la
+     * VaR est celui des rendements de l'historique, 1 jour pour des données quotidiennes)
+     */
+    template<ReturnSource Source>
+    [[nodiscard]] expected<RiskMetrics, RiskError> calculate_historical_risk(
+        std::span<const Position> positions,
+        const MarketData& market_data,
+        Source& history,
+        const HistoricalConfig& config = {}) const {
+        
+        const auto start_time = std::chrono::high_resolution_clock::now();
+        RiskMetrics metrics;
+        
+        const auto book = CompiledBook::compile(positions, market_data);
+        if (book.empty()) return metrics;
+        
+        // Colonne de l'historique de chaque sous-jacent du book
+        const auto names = history.underlyings();
+        std::vector<size_t> columns(book.n_underlyings());
+        for (size_t id = 0; id < book.n_underlyings(); ++id) {
+            const auto it = std::ranges::find(names, book.underlyings[id]);
+            if (it == names.end()) return RiskError::MISSING_MARKET_DATA;
+            columns[id] = static_cast<size_t>(it - names.begin());
+        }
+        
+        const auto invariants = RevaluationInvariants::compute(book);
+        metrics.portfolio_value = invariants.base_value;
+        calculate_portfolio_greeks(book, metrics);
+        
+        const size_t n_columns = names.size();
+        const size_t n_assets = book.n_underlyings();
+        const size_t block_dates = std::max<size_t>(config.block_dates, 1);
+        std::vector<double> block(block_dates * n_columns);    // Dates × colonnes (lecture)
+        std::vector<double> returns(n_assets * block_dates);  // Sous-jacent × dates (book)
+        
+        /*
+         * FILTRE EWMA (SIMULATION FILTRÉE)
+         * ================================
+         * Variance initiale = volatilité implicite du marché, ramenée à 1 jour
+         */
+        const bool filtered = config.method == HistoricalMethod::FILTERED_HISTORICAL;
+        std::vector<double> initial_variances(n_assets);
+        for (size_t id = 0; id < n_assets; ++id) initial_variances[id] = book.vols[id] * book.vols[id] / 252.0;
+        EwmaVolatilityFilter filter(initial_variances, config.ewma_lambda);
+        
+        std::vector<double> current_vols(n_assets);
+        if (filtered) {
+            history.rewind();
+            while (const size_t n_dates = history.read(block)) {
+                for (size_t d = 0; d < n_dates; ++d) {
+                    for (size_t id = 0; id < n_assets; ++id) filter.update(id, block[d * n_columns + columns[id]]);
+                }
+            }
+            for (size_t id = 0; id < n_assets; ++id) current_vols[id] = filter.volatility(id);
+            filter = EwmaVolatilityFilter(initial_variances, config.ewma_lambda);
+        }
+        
+        /*
+         * RÉÉVALUATION BLOC PAR BLOC
+         * ==========================
+         * Bloc transposé dans la disposition du book (returns[id × n_dates + d]),
+         * puis P&L de ses dates à la suite de portfolio_pnl
+         */
+        std::vector<double> portfolio_pnl;
+        history.rewind();
+        while (const size_t n_dates = history.read(block)) {
+            for (size_t id = 0; id < n_assets; ++id) {
+                for (size_t d = 0; d < n_dates; ++d) {
+                    const double r = block[d * n_columns + columns[id]];
+                    returns[id * n_dates + d] = filtered ? filter.standardize(id, r) * current_vols[id] : r;
+                }
+            }
+            const size_t done = portfolio_pnl.size();
+            portfolio_pnl.resize(done + n_dates, 0.0);
+            revalue_scenarios(book, invariants, std::span<const double>(returns).first(n_assets * n_dates),
+                              n_dates, std::span<double>(portfolio_pnl).subspan(done, n_dates));
+        }
+        
+        metrics.monte_carlo_simulations = portfolio_pnl.size();
+        if (!portfolio_pnl.empty()) store_var_es(portfolio_pnl, invariants.base_value, metrics);
+        
+        metrics.calculation_time_us = std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::high_resolution_clock::now() - start_time).count();
+        return metrics;
+    }
+    /*
+     * STRESS TESTING MULTI-FACTEURS
+     * =============================
+     * Rejoue des scénarios nommés (chocs spot / vol / taux par sous-jacent,
+     * relatifs ou absolus) sur le marché de base, sans le copier.
+     * Scénarios répartis sur n_threads, seuls les sous-jacents touchés
+     * sont repricés (StressTestEngine, stress_testing.hpp).
+     *
+     * RETOUR : matrice P&L scénario × sous-jacent (total par scénario : total(s))
+     */
+    [[nodiscard]] StressPnLMatrix run_stress_scenarios(
+        std::span<const Position> positions,
+        const MarketData& base_market_data,
+        std::span<const StressScenario> scenarios) const {
+        const auto book = CompiledBook::compile(positions, base_market_data);
+        return StressTestEngine::run(book, scenarios, n_threads_);
+    }
+    
     /*
      * STRESS TESTING DU PORTEFEUILLE
      * ===============================
@@ -277,52 +559,27 @@ public:
          */
         
         /*
-         * VALEUR DE BASE DU PORTEFEUILLE
-         * ==============================
-         * Point de référence pour mesurer les impacts
-         */
-        const double base_pv = calculate_portfolio_value(positions, base_market_data);
-        std::vector<std::pair<std::string, double>> results;
-        
-        /*
-         * TEST DE CHAQUE SCÉNARIO DE STRESS
-         * ==================================
+         * CHOC UNIFORME = SCÉNARIO À UN SEUL CHOC
+         * =======================================
+         * Tous les prix spot multipliés par (1 + choc), vol et taux inchangés
+         * 
+         * EXEMPLE de "Market Crash" avec shock_size = -0.30 :
+         * - WTI : 75$ → 75$ × (1 - 0.30) = 52.5$
+         * - BRENT : 78$ → 78$ × (1 - 0.30) = 54.6$
+         * - NATGAS : 3.45$ → 3.45$ × (1 - 0.30) = 2.415$
          */
+        std::vector<StressScenario> scenarios;
+        scenarios.reserve(stress_scenarios.size());
         for (const auto& [scenario_name, shock_size] : stress_scenarios) {
-            /*
-             * Structured binding C++17 : [scenario_name, shock_size]
-             * Équivaut à :
-             * string scenario_name = pair.first;
-             * double shock_size = pair.second;
-             */
-            
-            /*
-             * APPLICATION DU CHOC À TOUS LES PRIX SPOT
-             * ========================================
-             * On modifie tous les prix simultanément
-             */
-            MarketData stressed_data = base_market_data;  // Copie des données de base
-            for (auto& [underlying, price] : stressed_data.spot_prices) {
-                price *= (1.0 + shock_size);
-                /*
-                 * EXEMPLE de "Market Crash" avec shock_size = -0.30 :
-                 * - WTI : 75$ → 75$ × (1 - 0.30) = 52.5$
-                 * - BRENT : 78$ → 78$ × (1 - 0.30) = 54.6$
-                 * - NATGAS : 3.45$ → 3.45$ × (1 - 0.30) = 2.415$
-                 */
-            }
-            
-            /*
-             * CALCUL DE LA VALEUR SOUS STRESS
-             * ================================
-             */
-            const double stressed_pv = calculate_portfolio_value(positions, stressed_data);
-            
-            /*
-             * STOCKAGE DE L'IMPACT P&L
-             * =========================
-             */
-            results.emplace_back(scenario_name, stressed_pv - base_pv);
+            scenarios.push_back({scenario_name, {{"", StressFactor::SPOT, ShockType::RELATIVE, shock_size}}});
+        }
+        
+        const auto stress = run_stress_scenarios(positions, base_market_data, scenarios);
+        
+        std::vector<std::pair<std::string, double>> results;
+        results.reserve(stress.n_scenarios());
+        for (size_t s = 0; s < stress.n_scenarios(); ++s) {
+            results.emplace_back(stress.scenario_names[s], stress.total(s));
             /*
              * EXEMPLE de résultat :
              * - Scénario "Market Crash" → Impact = -15,000,000$ (perte de 15M$)
@@ -333,52 +590,84 @@ public:
         return results;
     }
     
-private:
     /*
-     * FONCTIONS PRIVÉES UTILITAIRES
-     * ==============================
-     * Fonctions internes qui décomposent les calculs complexes
+     * P&L PAR POSITION ET PAR SCÉNARIO
+     * ================================
+     * Même simulation et même réévaluation que la VaR Monte Carlo, mais en
+     * conservant la ligne de P&L de chaque position (matrice positions × scénarios),
+     * pour analyse ultérieure (qui porte la queue ? que coûte un nouveau trade ?).
+     * Les lignes suivent l'ordre des positions valides (book.position_index).
      */
+    [[nodiscard]] expected<ScenarioPnLMatrix, RiskError> calculate_scenario_pnl(
+        std::span<const Position> positions,
+        const MarketData& market_data,
+        size_t n_scenarios = 10'000,
+        double horizon = 1.0 / 252.0) const {
+        
+        const auto book = CompiledBook::compile(positions, market_data);
+        ScenarioPnLMatrix matrix(book.size(), n_scenarios);
+        if (book.empty()) return expected<ScenarioPnLMatrix, RiskError>{std::move(matrix)};
+        
+        const auto returns = simulate_book_returns(book, n_scenarios, horizon);
+        if (!returns.has_value()) return expected<ScenarioPnLMatrix, RiskError>{returns.error()};
+        
+        const auto invariants = RevaluationInvariants::compute(book);
+        std::vector<double> portfolio_pnl(n_scenarios, 0.0);
+        revalue_scenarios(book, invariants, returns.value(), n_scenarios, portfolio_pnl, &matrix);
+        return expected<ScenarioPnLMatrix, RiskError>{std::move(matrix)};
+    }
     
     /*
-     * FILTRAGE DES POSITIONS VALIDES
-     * ===============================
-     * Sépare le bon grain de l'ivraie dans le portefeuille
+     * SIMULATION JOINTE DES RENDEMENTS (CORRÉLÉS)
+     * ===========================================
+     * Tous les marchés sont simulés ENSEMBLE : WTI et BRENT montent et
+     * baissent de concert (ρ ≈ 0.9), ce qui compte énormément pour un
+     * book de spreads. Simuler chaque marché séparément sous-estimerait
+     * le VaR d'une position directionnelle et surestimerait celui d'un spread.
+     * 
+     * RÉSULTAT (structure de tableaux, une ligne par sous-jacent du book) :
+     * returns = [ BRENT: 0.015, -0.018, ... (n_scenarios) |
+     *             NATGAS: 0.045, -0.067, ... |
+     *             WTI: 0.012, -0.023, ... ]
+     * Rendement du sous-jacent a au scénario s : returns[a × n_scenarios + s]
+     * 
+     * Publique : RiskSession simule une fois les scénarios de tout l'univers
+     * de sous-jacents, puis réévalue les trades au fil de l'eau.
+     * 
+     * Corrélations semi-définies acceptées (ρ = 1 entre deux contrats) ;
+     * matrice indéfinie → INVALID_CORRELATION, jamais de repli silencieux
+     * sur des marchés indépendants (le VaR d'un spread serait faux d'un
+     * facteur 20).
      */
-    [[nodiscard]] std::vector<Position> filter_valid_positions(
-        std::span<const Position> positions,
-        const MarketData& market_data) const {
+    [[nodiscard]] expected<std::vector<double>, RiskError> simulate_book_returns(
+        const CompiledBook& book, size_t n_scenarios, double horizon) const {
         
-        std::vector<Position> valid_positions;
-        /*
-         * std::copy_if = algorithme STL qui copie seulement les éléments
-         * qui satisfont une condition (le prédicat lambda)
-         */
-        std::copy_if(positions.begin(), positions.end(), 
-                    std::back_inserter(valid_positions),
-                    [&](const Position& pos) {
-                        return pos.is_valid() && market_data.is_complete_for_position(pos);
-                    });
-        /*
-         * CONDITION DE VALIDITÉ :
-         * 1. pos.is_valid() : position bien formée (strike > 0, etc.)
-         * 2. market_data.is_complete_for_position(pos) : données dispo
-         * 
-         * [&] = capture par référence (accès à market_data)
-         * std::back_inserter = ajoute à la fin du vector automatiquement
-         */
+        const size_t n_assets = book.n_underlyings();
+        const std::vector<double> drifts(n_assets, book.risk_free_rate);
+        
+        const auto model = CorrelatedAssets::from_correlation(drifts, book.vols, book.correlation);
+        if (!model.has_value()) return expected<std::vector<double>, RiskError>{model.error()};
         
-        return valid_positions;
+        std::vector<double> returns(n_assets * n_scenarios);
+        mc_engine_.simulate_correlated_returns(returns, model.value(), horizon);
+        return expected<std::vector<double>, RiskError>{std::move(returns)};
     }
     
+private:
+    /*
+     * FONCTIONS PRIVÉES UTILITAIRES
+     * ==============================
+     * Fonctions internes qui décomposent les calculs complexes
+     */
+    
     /*
      * CALCUL DES GREEKS DU PORTEFEUILLE
      * ==================================
      * Agrège les sensibilités de toutes les positions par sous-jacent
+     * (la valeur du portefeuille vient des RevaluationInvariants)
      */
     void calculate_portfolio_greeks(
-        const std::vector<Position>& positions,
-        const MarketData& market_data,
+        const CompiledBook& book,
         RiskMetrics& metrics) const {  // Modifié par référence
         
         /*
@@ -386,116 +675,105 @@ private:
          * ===========================
          * On alloue la mémoire une seule fois pour éviter les réallocations
          */
-        std::vector<double> position_values(positions.size());
-        std::vector<double> position_deltas(positions.size());
-        std::vector<double> position_gammas(positions.size());
-        std::vector<double> position_vegas(positions.size());
-        std::vector<double> position_thetas(positions.size());
+        std::vector<BlackScholesModel::ExtendedGreeks> position_greeks(book.size());
         /*
          * OPTIMISATION MÉMOIRE :
          * - Taille fixe connue à l'avance
          * - Évite les push_back() répétés qui peuvent réallouer
-         * - Meilleure localité cache (données contiguës)
+         * - Chaque bloc de positions écrit dans sa propre zone (pas de verrou)
          */
         
         /*
-         * CALCUL POUR CHAQUE POSITION INDIVIDUELLE
-         * =========================================
-         * Boucle séquentielle (fallback pour compatibilité)
+         * CALCUL POUR CHAQUE BLOC DE POSITIONS
+         * ====================================
+         * Blocs répartis sur les threads ; le noyau par lots est sans état
+         * (pas de cache partagé) donc sûr en parallèle
          */
-        for (size_t i = 0; i < positions.size(); ++i) {
-            const auto& pos = positions[i];  // Référence vers la position actuelle
+        parallel::for_each_block(book.size(), POSITIONS_PER_BLOCK, n_threads_,
+            [&](size_t, size_t begin, size_t end) {
+            const size_t n = end - begin;
             
             /*
              * RÉCUPÉRATION DES DONNÉES DE MARCHÉ
              * ===================================
+             * Déjà résolues à la compilation du book ; spot et vol sont par
+             * sous-jacent → rassemblés en tableaux contigus pour le noyau
              */
-            const double S = market_data.spot_prices.at(pos.underlying);
-            const double vol = market_data.volatilities.at(pos.underlying);
-            /*
-             * .at() vs [] :
-             * - .at() lance exception si clé manquante
-             * - [] crée une entrée vide si clé manquante
-             * Ici on veut une exception si données manquantes
-             */
-            
-            /*
-             * CALCUL DU PRIX DE LA POSITION
-             * =============================
-             */
-            if (auto price_result = bs_model_.price(S, pos.strike, pos.maturity, 
-                                                   market_data.risk_free_rate, vol, pos.is_call);
-                price_result.has_value()) {
-                position_values[i] = price_result.value() * pos.notional;
-                /*
-                 * LOGIQUE :
-                 * - bs_model_.price() retourne expected<double, RiskError>
-                 * - Si succès → .has_value() == true
-                 * - .value() extrait le prix unitaire
-                 * - × pos.notional = valeur totale de la position
-                 * 
-                 * EXEMPLE :
-                 * - Prix unitaire option = 2.48$
-                 * - Notional = 1,000,000 (1M de contrats)
-                 * - Valeur position = 2,480,000$
-                 */
+            std::array<double, POSITIONS_PER_BLOCK> spots, rates, vols;
+            for (size_t k = 0; k < n; ++k) {
+                spots[k] = book.spot(begin + k);
+                vols[k] = book.vol(begin + k);
+                rates[k] = book.risk_free_rate;
             }
             
             /*
-             * CALCUL DE TOUS LES GREEKS EN UNE FOIS
-             * ======================================
-             * Plus efficace que 4 appels séparés
+             * CALCUL DE TOUS LES GREEKS DU BLOC EN UNE FOIS
+             * =============================================
+             * Une boucle vectorisée au lieu de n appels scalaires : d1, d2,
+             * φ(d1), N(d1), N(d2) évalués une fois par position pour les
+             * Greeks d'ordre 1, 2 et speed
+             * (prix non utilisé : la valeur vient des RevaluationInvariants)
              */
-            const auto greeks = bs_model_.calculate_all_greeks(S, pos.strike, pos.maturity,
-                                                              market_data.risk_free_rate, vol, pos.is_call);
+            std::array<double, POSITIONS_PER_BLOCK> prices, deltas, gammas, vegas, thetas;
+            std::array<double, POSITIONS_PER_BLOCK> rhos, vannas, volgas, charms, speeds;
+            const BlackScholesModel::ExtendedGreeksBatch unit{
+                .price = std::span<double>(prices.data(), n),
+                .delta = std::span<double>(deltas.data(), n),
+                .gamma = std::span<double>(gammas.data(), n),
+                .vega = std::span<double>(vegas.data(), n),
+                .theta = std::span<double>(thetas.data(), n),
+                .rho = std::span<double>(rhos.data(), n),
+                .vanna = std::span<double>(vannas.data(), n),
+                .volga = std::span<double>(volgas.data(), n),
+                .charm = std::span<double>(charms.data(), n),
+                .speed = std::span<double>(speeds.data(), n)};
+            BlackScholesModel::extended_greeks_batch(
+                std::span<const double>(spots.data(), n),
+                std::span<const double>(book.strikes).subspan(begin, n),
+                std::span<const double>(book.maturities).subspan(begin, n),
+                std::span<const double>(rates.data(), n),
+                std::span<const double>(vols.data(), n),
+                std::span<const uint8_t>(book.is_call).subspan(begin, n),
+                unit);
             
             /*
              * MISE À L'ÉCHELLE PAR LE NOTIONAL
              * =================================
              * Les Greeks unitaires × taille de la position
              */
-            position_deltas[i] = greeks.delta * pos.notional;
-            position_gammas[i] = greeks.gamma * pos.notional;
-            position_vegas[i] = greeks.vega * pos.notional;
-            position_thetas[i] = greeks.theta * pos.notional;
+            for (size_t k = 0; k < n; ++k) {
+                position_greeks[begin + k] = unit.at(k).scaled(book.notionals[begin + k]);
+            }
             /*
              * EXEMPLE :
              * - Delta unitaire = 0.35 (35 cents par dollar du sous-jacent)
              * - Notional = 1,000,000
              * - Delta position = 350,000 (position équivalente 350K$ spot)
              */
-        }
-        
-        /*
-         * AGRÉGATION DE LA VALEUR TOTALE DU PORTEFEUILLE
-         * ===============================================
-         */
-        metrics.portfolio_value = std::accumulate(position_values.begin(), position_values.end(), 0.0);
-        /*
-         * std::accumulate = somme tous les éléments
-         * Plus lisible qu'une boucle for manuelle
-         */
+        });
         
         /*
          * AGRÉGATION DES GREEKS PAR SOUS-JACENT
          * ======================================
-         * On groupe toutes les expositions au même underlying
-         */
-        for (size_t i = 0; const auto& pos : positions) {
-            metrics.delta_by_underlying[pos.underlying] += position_deltas[i];
-            metrics.gamma_by_underlying[pos.underlying] += position_gammas[i];
-            metrics.vega_by_underlying[pos.underlying] += position_vegas[i];
-            metrics.theta_by_underlying[pos.underlying] += position_thetas[i];
-            ++i;
+         * On groupe toutes les expositions au même underlying :
+         * d'abord par identifiant entier, puis une seule écriture
+         * dans les maps par sous-jacent (et non par position).
+         * Somme séquentielle dans l'ordre des positions → reproductible
+         */
+        std::vector<BlackScholesModel::ExtendedGreeks> greeks_by_id(book.n_underlyings());
+        for (size_t i = 0; i < book.size(); ++i) {
+            greeks_by_id[book.underlying_ids[i]].add(position_greeks[i]);
             /*
              * LOGIQUE D'AGRÉGATION :
              * Si on a 3 positions WTI avec deltas [100K, -50K, 200K]
              * → delta_by_underlying["WTI"] = 100K - 50K + 200K = 250K
-             * 
-             * C++20 range-based for avec index manuel
-             * Plus moderne : structured binding mais plus complexe ici
+             * (idem pour chaque Greek : tous sont linéaires en notional)
              */
         }
+        
+        for (size_t id = 0; id < book.n_underlyings(); ++id) {
+            metrics.set_greeks(book.underlyings[id], greeks_by_id[id]);
+        }
     }
     
     /*
@@ -504,18 +782,19 @@ private:
      * Simule des milliers de scénarios pour estimer le risque de queue
      */
     void calculate_monte_carlo_var(
-        const std::vector<Position>& positions,
-        const MarketData& market_data,
+        const CompiledBook& book,
+        const RevaluationInvariants& invariants,
+        std::span<const Position> positions,  // Noms des lignes (attribution par position)
+        const RiskConfig& config,
         RiskMetrics& metrics) const {
         
         /*
          * PARAMÈTRES DE SIMULATION
          * ========================
          */
-        constexpr size_t n_simulations = 10'000;  // Nombre de scénarios simulés
-        constexpr double T = 1.0 / 252.0;         // Horizon = 1 jour de trading
+        const size_t n_simulations = config.n_simulations;  // Nombre de scénarios simulés (10K par défaut)
+        const double T = config.horizon;                    // Horizon (1 jour de trading par défaut)
         /*
-         * constexpr = calculé à la compilation
          * 252 = nombre de jours de trading par an (365 - weekends - jours fériés)
          * 
          * COMPROMIS n_simulations :
@@ -525,123 +804,131 @@ private:
          */
         
         metrics.monte_carlo_simulations = n_simulations;  // Pour traçabilité
+        metrics.var_method = config.var_method;
         
         /*
-         * IDENTIFICATION DES SOUS-JACENTS UNIQUES
-         * ========================================
-         * On doit simuler chaque marché indépendamment
+         * SCÉNARIOS DE MARCHÉ
+         * ===================
+         * Corrélations indéfinies : VaR/ES non calculées, erreur signalée
          */
-        std::set<std::string> underlyings;
-        for (const auto& pos : positions) {
-            underlyings.insert(pos.underlying);
+        const auto simulation = simulate_book_returns(book, n_simulations, T);
+        if (!simulation.has_value()) {
+            metrics.var_error = simulation.error();
+            return;
         }
+        const std::vector<double>& simulated_returns = simulation.value();
+        
         /*
-         * std::set = collection unique automatiquement
-         * Si portefeuille a 10 positions WTI + 5 BRENT + 3 NATGAS
-         * → underlyings = {"WTI", "BRENT", "NATGAS"} (3 éléments)
+         * P&L DU PORTEFEUILLE PAR SCÉNARIO
+         * ================================
          */
+        std::vector<double> portfolio_returns(n_simulations, 0.0);
         
         /*
-         * SIMULATION DES RENDEMENTS PAR SOUS-JACENT
-         * ==========================================
-         * Pour chaque marché, on génère N scénarios de rendements quotidiens
+         * LIGNES DE P&L POUR L'ATTRIBUTION (OPTIONNELLES)
+         * ===============================================
+         * Réévaluation complète : une ligne par position, regroupées ensuite par
+         * sous-jacent si demandé. Delta-gamma et proxy : le P&L n'existe que par
+         * sous-jacent → attribution par sous-jacent quel que soit le niveau demandé.
          */
-        std::unordered_map<std::string, std::vector<double>> simulated_returns;
+        const bool attribute = config.attribution != AttributionLevel::NONE;
+        const bool by_position = config.attribution == AttributionLevel::POSITION &&
+                                 config.var_method == VarMethod::FULL_REVALUATION;
+        ScenarioPnLMatrix rows;
         
-        for (const auto& underlying : underlyings) {
-            const double vol = market_data.volatilities.at(underlying);
-            
-            std::vector<double> returns(n_simulations);
-            mc_engine_.simulate_single_step_returns(returns, market_data.risk_free_rate, vol, T);
-            simulated_returns[underlying] = std::move(returns);
+        if (config.var_method == VarMethod::DELTA_GAMMA) {
+            if (attribute) rows = ScenarioPnLMatrix(book.n_underlyings(), n_simulations);
+            approximate_scenarios(book, metrics, simulated_returns, n_simulations, portfolio_returns,
+                                  attribute ? &rows : nullptr);
+        } else if (config.var_method == VarMethod::CHEBYSHEV_PROXY) {
             /*
-             * RÉSULTAT :
-             * simulated_returns = {
-             *   "WTI": [0.012, -0.023, 0.008, ...],      // 10K rendements WTI
-             *   "BRENT": [0.015, -0.018, 0.011, ...],    // 10K rendements Brent
-             *   "NATGAS": [0.045, -0.067, 0.023, ...]    // 10K rendements gaz
-             * }
-             * 
-             * std::move() = transfert de propriété (évite la copie)
+             * PROXY DE CHEBYSHEV
+             * ==================
+             * Ajusté une fois par sous-jacent sur la plage de SES chocs simulés,
+             * puis évalué dans chaque scénario à la place de Black-Scholes
+             * Tolérance à l'échelle de l'exposition BRUTE Σ |notional| × spot :
+             * un book couvert (valeur ≈ 0) garde une tolérance utile au lieu
+             * de tout réévaluer complètement
              */
+            double gross_exposure = 0.0;
+            for (size_t i = 0; i < book.size(); ++i) gross_exposure += std::abs(book.notionals[i]) * book.spot(i);
+            const auto proxy = ChebyshevProxy::fit(book, invariants, simulated_returns, n_simulations,
+                                                   config.proxy_tolerance * gross_exposure, n_threads_);
+            if (attribute) rows = ScenarioPnLMatrix(book.n_underlyings(), n_simulations);
+            proxy.revalue(book, invariants, simulated_returns, n_simulations, portfolio_returns,
+                          attribute ? &rows : nullptr, n_threads_);
+            metrics.proxy_fit = proxy.report();
+            // Mêmes unités que proxy_tolerance (book vide : erreur nulle, pas 0/0)
+            if (gross_exposure > 0.0) metrics.proxy_fit.holdout_error /= gross_exposure;
+        } else {
+            /*
+             * RÉÉVALUATION COMPLÈTE AVEC LES INVARIANTS (CALCULÉS UNE FOIS)
+             * =============================================================
+             * Valeur de base de chaque position, ln K, σ√T, K e^{-rT}...
+             * Avant : base_pv recalculée pour chaque position dans CHACUN des
+             * 10,000 scénarios → moitié des appels Black-Scholes identiques
+             * Ici uniquement les prix choqués : P&L = valeur choquée - valeur de base
+             */
+            if (attribute) rows = ScenarioPnLMatrix(book.size(), n_simulations);
+            revalue_scenarios(book, invariants, simulated_returns, n_simulations, portfolio_returns,
+                              attribute ? &rows : nullptr);
+            if (attribute && !by_position) rows = rows.aggregate(book.underlying_ids, book.n_underlyings());
+        }
+        
+        if (config.var_method != VarMethod::FULL_REVALUATION && config.error_sample_size > 0) {
+            metrics.var_approximation_error = measure_approximation_error(
+                book, invariants, simulated_returns, n_simulations, portfolio_returns,
+                config.error_sample_size);
         }
         
+        /*
+         * ATTRIBUTION : sur les P&L en $ (avant la sélection sur place ci-dessous,
+         * qui réordonne portfolio_returns)
+         */
+        if (attribute) {
+            attribute_risk(book, invariants, positions, by_position, rows, portfolio_returns,
+                           config.attribution_confidence, metrics);
+            if (config.keep_scenario_pnl) metrics.scenario_pnl = std::move(rows);
+        }
+        
+        /*
+         * RENDEMENTS DU PORTEFEUILLE ET MÉTRIQUES VAR/ES
+         * ==============================================
+         * (portfolio_returns n'est plus utilisé ensuite : sélection sur place, sans copie)
+         */
+        store_var_es(portfolio_returns, invariants.base_value, metrics);
+    }
+    
+    /*
+     * VAR/ES À PARTIR DES P&L PAR SCÉNARIO (EN $)
+     * ===========================================
+     * Partagé par la VaR Monte Carlo et la simulation historique
+     * portfolio_pnl est converti en rendements puis réordonné sur place
+     */
+    static void store_var_es(std::span<double> portfolio_pnl, double base_value, RiskMetrics& metrics) {
         /*
          * CALCUL DES RENDEMENTS DU PORTEFEUILLE
          * =====================================
-         * Pour chaque scénario, on recalcule la valeur du portefeuille
          */
-        std::vector<double> portfolio_returns(n_simulations);
-        
-        for (size_t sim = 0; sim < n_simulations; ++sim) {
-            double base_pv = 0.0;     // Valeur actuelle
-            double shocked_pv = 0.0;  // Valeur après choc
-            
-            /*
-             * RÉÉVALUATION DE CHAQUE POSITION DANS CE SCÉNARIO
-             * =================================================
-             */
-            for (const auto& pos : positions) {
-                /*
-                 * PRIX ACTUELS ET CHOQUÉS
-                 * =======================
-                 */
-                const double S_base = market_data.spot_prices.at(pos.underlying);
-                const double return_shock = simulated_returns.at(pos.underlying)[sim];
-                const double S_shocked = S_base * (1.0 + return_shock);
-                const double vol = market_data.volatilities.at(pos.underlying);
-                /*
-                 * EXEMPLE scénario #1000 :
-                 * - WTI return_shock = -0.023 (-2.3%)
-                 * - S_base = 75$, S_shocked = 75$ × (1 - 0.023) = 73.275$
-                 */
-                
-                /*
-                 * PRICING DANS LES DEUX ÉTATS
-                 * ============================
-                 * Valeur avant et après le choc
-                 */
-                if (auto base_price = bs_model_.price(S_base, pos.strike, pos.maturity, 
-                                                     market_data.risk_free_rate, vol, pos.is_call);
-                    base_price.has_value()) {
-                    base_pv += base_price.value() * pos.notional;
-                }
-                
-                if (auto shocked_price = bs_model_.price(S_shocked, pos.strike, pos.maturity, 
-                                                         market_data.risk_free_rate, vol, pos.is_call);
-                    shocked_price.has_value()) {
-                    shocked_pv += shocked_price.value() * pos.notional;
-                }
-                /*
-                 * LOGIQUE :
-                 * - On price la même option avec prix spot différent
-                 * - Différence = impact du mouvement de marché
-                 * - Répété pour toutes les positions du portefeuille
-                 */
-            }
-            
-            /*
-             * CALCUL DU RENDEMENT DU PORTEFEUILLE
-             * ===================================
-             */
-            portfolio_returns[sim] = (shocked_pv - base_pv) / std::abs(base_pv);
-            /*
-             * FORMULE : Rendement = (Valeur_finale - Valeur_initiale) / |Valeur_initiale|
-             * 
-             * EXEMPLE :
-             * - base_pv = 10,000,000$ (10M$)
-             * - shocked_pv = 9,500,000$ (9.5M$)
-             * - Rendement = (9.5M - 10M) / 10M = -5% (perte de 5%)
-             */
-        }
+        const double scale = 1.0 / std::abs(base_value);
+        for (double& r : portfolio_pnl) r *= scale;
+        /*
+         * FORMULE : Rendement = (Valeur_finale - Valeur_initiale) / |Valeur_initiale|
+         * 
+         * EXEMPLE :
+         * - base_pv = 10,000,000$ (10M$)
+         * - shocked_pv = 9,500,000$ (9.5M$)
+         * - Rendement = (9.5M - 10M) / 10M = -5% (perte de 5%)
+         */
         
         /*
          * CALCUL DES MÉTRIQUES VAR/ES
          * ============================
          * Transformation des rendements simulés en mesures de risque
+         * (sélection sur place, sans copie)
          */
         const std::array confidence_levels = {0.95, 0.99, 0.999};
-        const auto var_es_results = mc_engine_.calculate_var_es_batch(portfolio_returns, confidence_levels);
+        const auto var_es_results = MonteCarloEngine::calculate_var_es_in_place(portfolio_pnl, confidence_levels);
         
         /*
          * STOCKAGE DANS LA STRUCTURE DE RÉSULTATS
@@ -662,42 +949,222 @@ private:
     }
     
     /*
-     * FONCTION UTILITAIRE : VALEUR DU PORTEFEUILLE
-     * =============================================
-     * Calcule la valeur totale sans les Greeks (plus rapide)
+     * APPROXIMATION DELTA-GAMMA DES SCÉNARIOS
+     * =======================================
+     * portfolio_pnl[s] += Σ_u (Δ_u × dS + ½ Γ_u × dS²),  dS = S_u × r_u,s
+     * 
+     * Toutes les options d'un même sous-jacent voient le même choc : leurs
+     * Greeks s'additionnent (delta_by_underlying, gamma_by_underlying) et le
+     * coût devient sous-jacents × scénarios au lieu de positions × scénarios.
      */
-    [[nodiscard]] double calculate_portfolio_value(
+    void approximate_scenarios(
+        const CompiledBook& book,
+        const RiskMetrics& metrics,
+        std::span<const double> returns,
+        size_t n_scenarios,
+        std::span<double> portfolio_pnl,
+        ScenarioPnLMatrix* underlying_pnl = nullptr) const {  // Ligne de P&L par sous-jacent (optionnel)
+        
+        for (size_t id = 0; id < book.n_underlyings(); ++id) {
+            const double S = book.spots[id];
+            const double delta = metrics.delta_by_underlying.at(book.underlyings[id]);
+            const double half_gamma = 0.5 * metrics.gamma_by_underlying.at(book.underlyings[id]);
+            const auto shocks = returns.subspan(id * n_scenarios, n_scenarios);
+            
+            for (size_t sim = 0; sim < n_scenarios; ++sim) {
+                const double dS = S * shocks[sim];
+                portfolio_pnl[sim] += dS * (delta + half_gamma * dS);
+            }
+            if (underlying_pnl) {
+                const auto row = underlying_pnl->row(id);
+                for (size_t sim = 0; sim < n_scenarios; ++sim) {
+                    const double dS = S * shocks[sim];
+                    row[sim] = dS * (delta + half_gamma * dS);
+                }
+            }
+        }
+    }
+    
+    /*
+     * ATTRIBUTION DE LA VaR/ES
+     * ========================
+     * Noms et expositions des lignes, puis décomposition (risk_attribution.hpp)
+     * by_position : lignes = positions du book, sinon lignes = sous-jacents
+     */
+    void attribute_risk(
+        const CompiledBook& book,
+        const RevaluationInvariants& invariants,
         std::span<const Position> positions,
-        const MarketData& market_data) const {
+        bool by_position,
+        const ScenarioPnLMatrix& rows,
+        std::span<const double> portfolio_pnl,
+        double confidence,
+        RiskMetrics& metrics) const {
         
-        double total_value = 0.0;
+        std::vector<std::string> names;
+        std::vector<double> exposures;
+        if (by_position) {
+            names.reserve(book.size());
+            for (size_t i = 0; i < book.size(); ++i) {
+                names.push_back(positions[book.position_index[i]].instrument_id);
+            }
+            exposures = invariants.base_values;
+        } else {
+            names = book.underlyings;
+            exposures.assign(book.n_underlyings(), 0.0);
+            for (size_t i = 0; i < book.size(); ++i) {
+                exposures[book.underlying_ids[i]] += invariants.base_values[i];
+            }
+        }
         
-        for (const auto& pos : positions) {
-            // Vérification rapide de données disponibles
-            if (!market_data.is_complete_for_position(pos)) continue;
+        metrics.attribution = RiskAttribution::compute(rows, portfolio_pnl, names, exposures,
+                                                       invariants.base_value, confidence, n_threads_);
+    }
+    
+    /*
+     * MESURE DE L'ERREUR D'APPROXIMATION
+     * ==================================
+     * sample_size scénarios régulièrement espacés (pas fixe → reproductible)
+     * sont réévalués complètement et comparés à l'approximation.
+     * approx_pnl : P&L approchés (en $, avant division par la valeur du portefeuille)
+     */
+    [[nodiscard]] VarApproximationError measure_approximation_error(
+        const CompiledBook& book,
+        const RevaluationInvariants& invariants,
+        std::span<const double> returns,
+        size_t n_scenarios,
+        std::span<const double> approx_pnl,
+        size_t sample_size) const {
+        
+        VarApproximationError report;
+        const size_t n_sampled = std::min(sample_size, n_scenarios);
+        if (n_sampled == 0) return report;
+        
+        const double scale = 1.0 / std::abs(invariants.base_value);
+        const size_t stride = n_scenarios / n_sampled;
+        
+        // Chaque scénario échantillonné est indépendant : blocs répartis sur les threads
+        std::vector<double> exact(n_sampled), approx(n_sampled);
+        parallel::for_each_block(n_sampled, 64, n_threads_, [&](size_t, size_t begin, size_t end) {
+            for (size_t k = begin; k < end; ++k) {
+                const size_t sim = k * stride;
+                double pnl = 0.0;
+                for (size_t i = 0; i < book.size(); ++i) {
+                    const double S_shocked = book.spot(i) * (1.0 + returns[book.underlying_ids[i] * n_scenarios + sim]);
+                    pnl += invariants.value(book, i, S_shocked) - invariants.base_values[i];
+                }
+                exact[k] = pnl * scale;
+                approx[k] = approx_pnl[sim] * scale;
+            }
+        });
+        
+        // Seuil de la queue à 99% de l'échantillon exact (copie : exact reste dans l'ordre)
+        std::vector<double> scratch(exact);
+        const double tail_threshold = -MonteCarloEngine::calculate_var_es_in_place(scratch, 0.99).first;
+        
+        double sum = 0.0, sum_sq = 0.0;
+        for (size_t k = 0; k < n_sampled; ++k) {
+            const double error = approx[k] - exact[k];
+            sum += error;
+            sum_sq += error * error;
+            report.max_abs_error = std::max(report.max_abs_error, std::abs(error));
+            if (exact[k] <= tail_threshold) {
+                report.tail_max_abs_error = std::max(report.tail_max_abs_error, std::abs(error));
+            }
+        }
+        report.n_sampled = n_sampled;
+        report.mean_error = sum / n_sampled;
+        report.rms_error = std::sqrt(sum_sq / n_sampled);
+        return report;
+    }
+    
+    /*
+     * RÉÉVALUATION COMPLÈTE DES SCÉNARIOS
+     * ===================================
+     * portfolio_pnl[s] += Σ_i (valeur_i(S_i × (1 + r_s)) - base_i)
+     * 
+     * PARALLÉLISATION PAR TUILES (bloc de scénarios × bloc de positions) :
+     * - Chaque tuile a son accumulateur : partial[bloc_positions][scénario]
+     *   (un seul bloc de positions → écriture directe dans portfolio_pnl)
+     * - Réduction ensuite, scénario par scénario, dans l'ordre fixe des blocs
+     *   de positions → même résultat quel que soit le nombre de threads
+     * - Dans une tuile, boucle position par position : les invariants de la
+     *   position restent en registres, sa ligne de chocs est lue avec un pas de 1
+     * 
+     * position_pnl (optionnel) reçoit aussi le P&L de chaque position
+     * (cellules disjointes entre tuiles, pas de synchronisation).
+     */
+    void revalue_scenarios(
+        const CompiledBook& book,
+        const RevaluationInvariants& invariants,
+        std::span<const double> returns,
+        size_t n_scenarios,
+        std::span<double> portfolio_pnl,
+        ScenarioPnLMatrix* position_pnl = nullptr) const {
+        
+        const size_t n_scenario_blocks = parallel::block_count(n_scenarios, SCENARIOS_PER_BLOCK);
+        const size_t n_position_blocks = parallel::block_count(book.size(), POSITIONS_PER_BLOCK);
+        if (n_scenario_blocks == 0 || n_position_blocks == 0) return;
+        
+        const bool needs_reduction = n_position_blocks > 1;
+        std::vector<double> partial(needs_reduction ? n_position_blocks * n_scenarios : 0, 0.0);
+        /*
+         * MÉMOIRE : n_position_blocks × n_scenarios doubles
+         * 10k positions × 100k scénarios → 40 × 100k × 8 octets = 32 Mo
+         */
+        
+        parallel::for_each_block(n_scenario_blocks * n_position_blocks, 1, n_threads_,
+            [&](size_t tile, size_t, size_t) {
+            const size_t position_block = tile / n_scenario_blocks;
+            const size_t scenario_block = tile % n_scenario_blocks;
+            
+            const size_t s_begin = scenario_block * SCENARIOS_PER_BLOCK;
+            const size_t s_end = std::min(s_begin + SCENARIOS_PER_BLOCK, n_scenarios);
+            const size_t p_begin = position_block * POSITIONS_PER_BLOCK;
+            const size_t p_end = std::min(p_begin + POSITIONS_PER_BLOCK, book.size());
             
-            // Récupération des paramètres de marché
-            const double S = market_data.spot_prices.at(pos.underlying);
-            const double vol = market_data.volatilities.at(pos.underlying);
+            double* accumulator = needs_reduction
+                ? partial.data() + position_block * n_scenarios
+                : portfolio_pnl.data();
             
-            // Pricing et accumulation
-            if (auto price_result = bs_model_.price(S, pos.strike, pos.maturity, 
-                                                   market_data.risk_free_rate, vol, pos.is_call);
-                price_result.has_value()) {
-                total_value += price_result.value() * pos.notional;
+            std::array<double, SCENARIOS_PER_BLOCK> strip;  // P&L d'une position sur la bande
+            const size_t n_strip = s_end - s_begin;
+            
+            for (size_t i = p_begin; i < p_end; ++i) {
+                /*
+                 * EXEMPLE scénario #1000 :
+                 * - WTI return_shock = -0.023 (-2.3%)
+                 * - S_base = 75$, S_shocked = 75$ × (1 - 0.023) = 73.275$
+                 * Noyau vectorisé : toute la bande de scénarios d'un coup
+                 */
+                const auto shocks = returns.subspan(book.underlying_ids[i] * n_scenarios + s_begin, n_strip);
+                const std::span<double> pnl = position_pnl
+                    ? position_pnl->row(i).subspan(s_begin, n_strip)
+                    : std::span<double>(strip.data(), n_strip);
+                invariants.scenario_pnl(book, i, shocks, pnl);
+                
+                for (size_t k = 0; k < n_strip; ++k) {
+                    accumulator[s_begin + k] += pnl[k];
+                }
             }
-            /*
-             * DIFFÉRENCE avec calculate_portfolio_greeks :
-             * - Ici : seulement le prix total (rapide)
-             * - Là-bas : prix + tous les Greeks (complet mais plus lent)
-             * 
-             * USAGE :
-             * - Stress testing : on veut juste la valeur
-             * - Analyse complète : on veut prix + sensibilités
-             */
-        }
+        });
         
-        return total_value;
+        /*
+         * RÉDUCTION DÉTERMINISTE
+         * ======================
+         * Blocs de scénarios en parallèle, blocs de positions toujours sommés
+         * dans l'ordre 0, 1, 2... (l'addition flottante n'est pas associative)
+         */
+        if (!needs_reduction) return;
+        parallel::for_each_block(n_scenarios, SCENARIOS_PER_BLOCK, n_threads_,
+            [&](size_t, size_t begin, size_t end) {
+            for (size_t position_block = 0; position_block < n_position_blocks; ++position_block) {
+                const double* block_pnl = partial.data() + position_block * n_scenarios;
+                for (size_t sim = begin; sim < end; ++sim) {
+                    portfolio_pnl[sim] += block_pnl[sim];
+                }
+            }
+        });
     }
 };
 
@@ -708,17 +1175,24 @@ private:
  * CLASSE PortfolioRiskCalculator :
  * 1. CALCULATE_PORTFOLIO_RISK() : Analyse complète du risque portefeuille
  * 2. CALCULATE_PORTFOLIO_RISK_ASYNC() : Version asynchrone non-bloquante
+ *    CALCULATE_HISTORICAL_RISK() : VaR historique / historique filtrée (même réévaluation)
  * 3. STRESS_TEST_PORTFOLIO() : Tests de résistance aux chocs de marché
- * 4. Fonctions privées pour décomposer les calculs complexes
+ *    RUN_STRESS_SCENARIOS() : Scénarios multi-facteurs, P&L scénario × sous-jacent
+ *    CALCULATE_SCENARIO_PNL() : Matrice des P&L par position et par scénario
+ * 4. Fonctions privées pour décomposer les calculs complexes,
+ *    toutes sur le CompiledBook (portfolio_book.hpp)
  * 
  * STRUCTURES DE DONNÉES :
  * - RiskMetrics : Tous les résultats d'analyse (valeur, Greeks, VaR/ES)
+ * - RiskConfig : Méthode VaR (réévaluation complète / delta-gamma / proxy de Chebyshev),
+ *   scénarios, horizon,
+ *   attribution de la VaR/ES (par position ou sous-jacent)
  * - MarketData : Données de marché centralisées (prix, volatilités, taux)
  * 
  * FLUX DE CALCUL PRINCIPAL :
  * Input: Positions + MarketData
  * ↓
- * 1. Filtrage des positions valides
+ * 1. Filtrage des positions valides + compilation du book (ids entiers)
  * ↓  
  * 2. Calcul des Greeks agrégés par sous-jacent
  * ↓
@@ -728,7 +1202,15 @@ private:
  * 
  * OPTIMISATIONS CLÉS :
  * - Validation préalable (évite les plantages)
- * - Calcul groupé des Greeks (évite les appels répétés)
+ * - Book compilé en structure de tableaux (aucun hachage de chaîne dans les boucles)
+ * - Valeurs de base et invariants Black-Scholes calculés une fois par calcul :
+ *   la boucle de scénarios ne fait que les prix choqués
+ * - Greeks et réévaluation répartis sur tous les cœurs (tuiles scénarios ×
+ *   positions, réduction dans un ordre fixe → résultats reproductibles)
+ * - Greeks et réévaluation par noyaux Black-Scholes vectorisés (bandes SoA,
+ *   cas particuliers masqués, pas de validation ni de cache par option)
+ * - Mode proxy : un polynôme de Chebyshev par sous-jacent remplace
+ *   positions × scénarios appels Black-Scholes (pricing_proxy.hpp)
  * - Pré-allocation mémoire (évite les réallocations)
  * - Agrégation par sous-jacent (vue métier)
  * - Chronométrage intégré (monitoring performance)
@@ -740,7 +1222,8 @@ private:
  * MarketData market_data{
  *     .spot_prices = {{"WTI", 75.0}, {"BRENT", 78.0}},
  *     .volatilities = {{"WTI", 0.35}, {"BRENT", 0.33}},
- *     .risk_free_rate = 0.05
+ *     .risk_free_rate = 0.05,
+ *     .correlations = {{"WTI", {{"BRENT", 0.92}}}}
  * };
  * 
  * vector<Position> positions = load_trading_book();
@@ -748,6 +1231,18 @@ private:
  * // 2. Analyse de risque quotidienne
  * auto risk_metrics = calculator.calculate_portfolio_risk(positions, market_data);
  * 
+ * // 2bis. VaR intraday rapide (delta-gamma), contrôlée sur 500 scénarios
+ * auto intraday = calculator.calculate_portfolio_risk(positions, market_data,
+ *     RiskConfig{.var_method = VarMethod::DELTA_GAMMA, .error_sample_size = 500});
+ * 
+ * // 2ter. Qui porte la queue ? Component ES / Marginal / Incremental VaR par trade
+ * auto attributed = calculator.calculate_portfolio_risk(positions, market_data,
+ *     RiskConfig{.attribution = AttributionLevel::POSITION});
+ * 
+ * // 2quater. Précision de la réévaluation complète pour quelques prix par position
+ * auto proxied = calculator.calculate_portfolio_risk(positions, market_data,
+ *     RiskConfig{.var_method = VarMethod::CHEBYSHEV_PROXY, .error_sample_size = 500});
+ * 
  * // 3. Vérification des limites
  * if (risk_metrics.var_99 > daily_var_limit) {
  *     alert_risk_manager("VaR limit exceeded!");
@@ -771,6 +1266,14 @@ private:
  *     cout << scenario << ": $" << impact << " P&L impact" << endl;
  * }
  * 
+ * // 5bis. Scénarios multi-facteurs (spot / vol / taux par sous-jacent)
+ * const vector<StressScenario> scenarios = {
+ *     {"Hormuz closure", {{"BRENT", StressFactor::SPOT, ShockType::RELATIVE, 0.40},
+ *                         {"BRENT", StressFactor::VOL, ShockType::ABSOLUTE, 0.15}}}
+ * };
+ * auto stress = calculator.run_stress_scenarios(positions, market_data, scenarios);
+ * cout << stress.scenario_names[0] << ": $" << stress.total(0) << endl;
+ * 
  * IMPORTANCE MÉTIER :
  * ===================
  * Ce fichier est le "tableau de bord" du risk manager chez Vitol.
@@ -781,6 +1284,7 @@ private:
  * 3. "Quel est notre risque maximum quotidien ?" → var_99
  * 4. "Comment résistons-nous aux crises ?" → stress_test_portfolio
  * 5. "Sommes-nous dans les limites réglementaires ?" → var_95, es_95
+ * 6. "Quel trade porte le risque ?" → attribution.contributions
  * 
  * CONFORMITÉ RÉGLEMENTAIRE :
  * - VaR 99% : Reporting Bâle III pour les banques
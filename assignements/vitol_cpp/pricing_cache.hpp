@@ -0,0 +1,304 @@
+/*
+ * pricing_cache.hpp - Cache borné des prix Black-Scholes
+ *
+ * L'ancien cache de BlackScholesModel construisait une clé texte à chaque
+ * appel (5 std::to_string + 4 concaténations = plusieurs allocations, plus
+ * cher que la formule fermée elle-même), oubliait le type d'option (un put
+ * et un call de mêmes paramètres partageaient la même entrée) et grossissait
+ * sans limite.
+ *
+ * Ici :
+ * - clé = bits bruts des 5 paramètres + type d'option (aucune allocation)
+ * - capacité fixe, éviction CLOCK (approximation de LRU à 1 bit par entrée)
+ * - aucun verrou : chaque entrée est un seqlock, lecteurs et écrivains
+ *   concurrents ne s'attendent jamais (pricing multi-thread sûr)
+ * - compteurs hits / misses / évictions
+ */
+
+#pragma once
+
+#include <array>      // Voies d'un ensemble
+#include <bit>        // bit_cast (bits bruts des doubles)
+#include <cstdint>    // uint64_t
+#include <memory>     // unique_ptr<Shard[]>, unique_ptr<Set[]>
+#include <atomic>     // Séquences et champs des entrées (seqlock)
+#include <optional>   // Résultat de find()
+#include <algorithm>  // max
+
+// ===== CLÉ DU CACHE =====
+/*
+ * Comparaison bit à bit : 0.1 calculé de deux façons différentes donne deux
+ * clés différentes (un miss de plus, jamais un faux hit)
+ */
+struct PricingKey {
+    double spot{0.0};
+    double strike{0.0};
+    double maturity{0.0};
+    double rate{0.0};
+    double vol{0.0};
+    bool is_call{true};
+
+    [[nodiscard]] friend bool operator==(const PricingKey& a, const PricingKey& b) noexcept {
+        return std::bit_cast<uint64_t>(a.spot) == std::bit_cast<uint64_t>(b.spot)
+            && std::bit_cast<uint64_t>(a.strike) == std::bit_cast<uint64_t>(b.strike)
+            && std::bit_cast<uint64_t>(a.maturity) == std::bit_cast<uint64_t>(b.maturity)
+            && std::bit_cast<uint64_t>(a.rate) == std::bit_cast<uint64_t>(b.rate)
+            && std::bit_cast<uint64_t>(a.vol) == std::bit_cast<uint64_t>(b.vol)
+            && a.is_call == b.is_call;
+    }
+
+    // Mélange multiplicatif des 5 mots de 64 bits (finaliseur de splitmix64)
+    [[nodiscard]] uint64_t hash() const noexcept {
+        uint64_t h = is_call ? 0x9E3779B97F4A7C15ULL : 0x7F4A7C159E3779B9ULL;
+        for (const double x : {spot, strike, maturity, rate, vol}) {
+            h ^= std::bit_cast<uint64_t>(x);
+            h ^= h >> 30;
+            h *= 0xBF58476D1CE4E5B9ULL;
+            h ^= h >> 27;
+            h *= 0x94D049BB133111EBULL;
+            h ^= h >> 31;
+        }
+        return h;
+    }
+};
+
+// ===== STATISTIQUES =====
+struct CacheStats {
+    uint64_t hits{0};
+    uint64_t misses{0};
+    uint64_t evictions{0};
+    size_t size{0};      // Entrées occupées
+    size_t capacity{0};  // Entrées au total
+
+    [[nodiscard]] double hit_rate() const noexcept {
+        const uint64_t lookups = hits + misses;
+        return lookups > 0 ? static_cast<double>(hits) / static_cast<double>(lookups) : 0.0;
+    }
+};
+
+// ===== CACHE BORNÉ, SANS VERROU, ÉVICTION CLOCK =====
+/*
+ * ORGANISATION :
+ *     clé → hash → shard (bits hauts) → ensemble de WAYS entrées (bits bas)
+ * Une clé ne peut se trouver que dans son ensemble : recherche = WAYS
+ * comparaisons, pas de chaînage ni de réhachage, mémoire fixée à la construction.
+ *
+ * CONCURRENCE (aucun verrou) :
+ * Chaque entrée porte un numéro de séquence (seqlock) : impair = écriture
+ * en cours. Un lecteur relit la séquence après avoir copié l'entrée et
+ * ignore l'entrée si elle a changé. Un écrivain prend l'entrée par CAS
+ * pair → impair ; si elle est déjà prise, il abandonne l'insertion au lieu
+ * d'attendre (un cache peut toujours oublier un prix). Aucun thread n'attend
+ * donc jamais un autre ; les shards ne servent plus qu'à répartir les
+ * compteurs sur des lignes de cache distinctes.
+ *
+ * CLOCK (par ensemble) : chaque hit marque l'entrée ; à l'insertion dans un
+ * ensemble plein, l'aiguille saute les entrées marquées (en les démarquant)
+ * et remplace la première non marquée → les entrées relues survivent.
+ *
+ * capacity = 0 : cache désactivé (find() ne trouve rien, insert() ne fait rien,
+ * aucun compteur).
+ *
+ * Copie : nouveau cache VIDE de même capacité (le contenu d'un cache n'est pas
+ * une donnée du modèle qui le possède).
+ */
+class PricingCache {
+public:
+    static constexpr size_t DEFAULT_CAPACITY = 4096;
+    static constexpr size_t DEFAULT_SHARDS = 16;
+    static constexpr size_t WAYS = 8;  // Entrées par ensemble
+
+    explicit PricingCache(size_t capacity = DEFAULT_CAPACITY, size_t n_shards = DEFAULT_SHARDS) {
+        if (capacity == 0) return;
+        n_shards_ = std::max<size_t>(n_shards, 1);
+        const size_t per_shard = (capacity + n_shards_ - 1) / n_shards_;
+        sets_per_shard_ = std::max<size_t>((per_shard + WAYS - 1) / WAYS, 1);
+        shards_ = std::make_unique<Shard[]>(n_shards_);
+        sets_ = std::make_unique<Set[]>(n_shards_ * sets_per_shard_);
+    }
+
+    PricingCache(const PricingCache& other) : PricingCache(other.capacity(), other.n_shards_) {}
+    PricingCache& operator=(const PricingCache& other) {
+        if (this != &other) *this = PricingCache(other.capacity(), other.n_shards_);
+        return *this;
+    }
+    PricingCache(PricingCache&&) noexcept = default;
+    PricingCache& operator=(PricingCache&&) noexcept = default;
+
+    [[nodiscard]] bool enabled() const noexcept { return shards_ != nullptr; }
+    [[nodiscard]] size_t capacity() const noexcept { return n_shards_ * sets_per_shard_ * WAYS; }
+
+    [[nodiscard]] std::optional<double> find(const PricingKey& key) const noexcept {
+        if (!enabled()) return std::nullopt;
+        const uint64_t h = key.hash();
+        Shard& shard = shard_for(h);
+        for (Entry& entry : set_for(h).entries) {
+            if (const auto value = entry.read_if(key)) {
+                entry.referenced.store(true, std::memory_order_relaxed);
+                shard.hits.fetch_add(1, std::memory_order_relaxed);
+                return value;
+            }
+        }
+        shard.misses.fetch_add(1, std::memory_order_relaxed);
+        return std::nullopt;
+    }
+
+    void insert(const PricingKey& key, double value) noexcept {
+        if (!enabled()) return;
+        const uint64_t h = key.hash();
+        Set& set = set_for(h);
+
+        Entry* empty = nullptr;
+        for (Entry& entry : set.entries) {
+            if (entry.read_if(key)) return;  // Déjà insérée par un autre thread
+            if (empty == nullptr && !entry.occupied.load(std::memory_order_relaxed)) empty = &entry;
+        }
+        if (empty != nullptr) {
+            empty->try_write(key, value);
+            return;
+        }
+
+        /*
+         * ENSEMBLE PLEIN : victime choisie par l'aiguille
+         * Au plus deux tours (le premier démarque tout) ; entrée en cours
+         * d'écriture par un autre thread → insertion abandonnée
+         */
+        for (size_t step = 0; step < 2 * WAYS; ++step) {
+            Entry& entry = set.entries[set.hand.fetch_add(1, std::memory_order_relaxed) % WAYS];
+            if (entry.referenced.exchange(false, std::memory_order_relaxed)) continue;
+            if (entry.try_write(key, value)) shard_for(h).evictions.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+    }
+
+    // Vide le cache (attend seulement les écritures en cours, entrée par entrée)
+    void clear() noexcept {
+        for (size_t s = 0; s < n_shards_ * sets_per_shard_; ++s) {
+            for (Entry& entry : sets_[s].entries) entry.erase();
+        }
+    }
+
+    // Somme des compteurs (instantané approximatif si d'autres threads pricent)
+    [[nodiscard]] CacheStats stats() const noexcept {
+        CacheStats stats;
+        stats.capacity = capacity();
+        for (size_t s = 0; s < n_shards_; ++s) {
+            stats.hits += shards_[s].hits.load(std::memory_order_relaxed);
+            stats.misses += shards_[s].misses.load(std::memory_order_relaxed);
+            stats.evictions += shards_[s].evictions.load(std::memory_order_relaxed);
+        }
+        for (size_t s = 0; s < n_shards_ * sets_per_shard_; ++s) {
+            for (const Entry& entry : sets_[s].entries) {
+                stats.size += entry.occupied.load(std::memory_order_relaxed) ? 1 : 0;
+            }
+        }
+        return stats;
+    }
+
+private:
+    /*
+     * ENTRÉE PROTÉGÉE PAR SEQLOCK (une ligne de cache)
+     * Tous les champs sont atomiques (accès relaxed) : une lecture
+     * concurrente d'une écriture est détectée par la séquence, jamais
+     * un comportement indéfini
+     */
+    struct alignas(64) Entry {
+        std::atomic<uint64_t> sequence{0};          // Impair = écriture en cours
+        std::array<std::atomic<uint64_t>, 5> key{};  // Bits de S, K, T, r, vol
+        std::atomic<uint64_t> value{0};              // Bits du prix
+        std::atomic<uint8_t> is_call{0};
+        std::atomic<bool> occupied{false};
+        std::atomic<bool> referenced{false};        // Bit CLOCK : relue depuis le dernier passage de l'aiguille
+
+        // Prix si l'entrée contient key (copie cohérente), sinon nullopt
+        [[nodiscard]] std::optional<double> read_if(const PricingKey& wanted) const noexcept {
+            const uint64_t before = sequence.load(std::memory_order_acquire);
+            if (before & 1) return std::nullopt;
+            const bool match = occupied.load(std::memory_order_relaxed)
+                && key[0].load(std::memory_order_relaxed) == std::bit_cast<uint64_t>(wanted.spot)
+                && key[1].load(std::memory_order_relaxed) == std::bit_cast<uint64_t>(wanted.strike)
+                && key[2].load(std::memory_order_relaxed) == std::bit_cast<uint64_t>(wanted.maturity)
+                && key[3].load(std::memory_order_relaxed) == std::bit_cast<uint64_t>(wanted.rate)
+                && key[4].load(std::memory_order_relaxed) == std::bit_cast<uint64_t>(wanted.vol)
+                && is_call.load(std::memory_order_relaxed) == static_cast<uint8_t>(wanted.is_call);
+            const uint64_t bits = value.load(std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (!match || sequence.load(std::memory_order_relaxed) != before) return std::nullopt;
+            return std::bit_cast<double>(bits);
+        }
+
+        // Écrit (key, price) si aucune autre écriture n'est en cours
+        bool try_write(const PricingKey& k, double price) noexcept {
+            uint64_t before = sequence.load(std::memory_order_relaxed);
+            if ((before & 1) || !sequence.compare_exchange_strong(before, before + 1, std::memory_order_relaxed)) {
+                return false;
+            }
+            std::atomic_thread_fence(std::memory_order_release);
+            key[0].store(std::bit_cast<uint64_t>(k.spot), std::memory_order_relaxed);
+            key[1].store(std::bit_cast<uint64_t>(k.strike), std::memory_order_relaxed);
+            key[2].store(std::bit_cast<uint64_t>(k.maturity), std::memory_order_relaxed);
+            key[3].store(std::bit_cast<uint64_t>(k.rate), std::memory_order_relaxed);
+            key[4].store(std::bit_cast<uint64_t>(k.vol), std::memory_order_relaxed);
+            value.store(std::bit_cast<uint64_t>(price), std::memory_order_relaxed);
+            is_call.store(k.is_call, std::memory_order_relaxed);
+            occupied.store(true, std::memory_order_relaxed);
+            referenced.store(false, std::memory_order_relaxed);
+            sequence.store(before + 2, std::memory_order_release);
+            return true;
+        }
+
+        void erase() noexcept {
+            uint64_t before = sequence.load(std::memory_order_relaxed);
+            while ((before & 1) || !sequence.compare_exchange_weak(before, before + 1, std::memory_order_relaxed)) {
+                before = sequence.load(std::memory_order_relaxed);
+            }
+            std::atomic_thread_fence(std::memory_order_release);
+            occupied.store(false, std::memory_order_relaxed);
+            referenced.store(false, std::memory_order_relaxed);
+            sequence.store(before + 2, std::memory_order_release);
+        }
+    };
+
+    struct Set {
+        std::array<Entry, WAYS> entries{};
+        std::atomic<size_t> hand{0};  // Aiguille CLOCK
+    };
+
+    // Compteurs d'un shard sur leur propre ligne de cache (pas de faux partage entre shards)
+    struct alignas(64) Shard {
+        std::atomic<uint64_t> hits{0};
+        std::atomic<uint64_t> misses{0};
+        std::atomic<uint64_t> evictions{0};
+    };
+
+    std::unique_ptr<Shard[]> shards_;
+    std::unique_ptr<Set[]> sets_;  // Shard s : ensembles [s × sets_per_shard_, (s + 1) × sets_per_shard_)
+    size_t n_shards_{0};
+    size_t sets_per_shard_{0};
+
+    [[nodiscard]] size_t shard_index(uint64_t h) const noexcept { return (h >> 32) % n_shards_; }
+    [[nodiscard]] Shard& shard_for(uint64_t h) const noexcept { return shards_[shard_index(h)]; }
+    [[nodiscard]] Set& set_for(uint64_t h) const noexcept {
+        return sets_[shard_index(h) * sets_per_shard_ + (h & 0xFFFFFFFFULL) % sets_per_shard_];
+    }
+};
+
+/*
+ * RÉSUMÉ DE CE FICHIER :
+ * ======================
+ *
+ * 1. PricingKey : 5 paramètres (bits bruts) + call/put, hash sans allocation
+ * 2. CacheStats : hits, misses, évictions, taux de succès
+ * 3. PricingCache : capacité fixe, ensembles de 8 entrées à éviction CLOCK,
+ *    sans verrou (seqlock par entrée, insertion abandonnée si l'entrée est prise)
+ *
+ * MÉMOIRE : 64 octets par entrée → 4,096 entrées par défaut = 256 Ko
+ *
+ * USAGE TYPIQUE :
+ * PricingCache cache(10'000);
+ * const PricingKey key{100.0, 105.0, 0.25, 0.05, 0.20, true};
+ * if (auto hit = cache.find(key)) return *hit;
+ * const double price = ...;  // Formule fermée
+ * cache.insert(key, price);
+ * std::cout << "Hit rate: " << cache.stats().hit_rate() << "\n";
+ */
@@ -7,17 +7,70 @@
 #include "types.hpp"
 #include "payoff_model.hpp"
 #include "monte_carlo.hpp"
+#include "pricing_models.hpp"
 #include <chrono>
+#include <tuple>
+
+/*
+ * MÉTHODE D'ÉCHANTILLONNAGE
+ * - PSEUDO_RANDOM : Monte Carlo classique (Philox), erreur en O(1/√N)
+ * - SOBOL : quasi-Monte Carlo (Sobol brouillé + pont brownien), erreur proche
+ *   de O(1/N) → même précision avec beaucoup moins de simulations
+ */
+enum class SamplingMethod {
+    PSEUDO_RANDOM,
+    SOBOL
+};
+
+/*
+ * OPTIONS DE PRICING (paramètre optionnel de calculate_option_price)
+ * 
+ * RÉDUCTION DE VARIANCE (combinables) :
+ * - antithetic : chaque tirage Z est accompagné de -Z (paires compensées) ;
+ *   n_simulations impair → n/2 paires + un tirage simple (jamais n + 1)
+ * - control_variate : correction par une variable d'espérance connue
+ *     européennes → S_T ; asiatiques → payoff sur moyenne géométrique ;
+ *     barrière / lookback / digitale → call vanille Black-Scholes
+ * - moment_matching : les prix finaux simulés sont recalés pour que leur
+ *   moyenne soit exactement le forward S × e^{rT} (européennes uniquement).
+ *   Recalage UNIQUE sur tout l'échantillon : ignoré en mode adaptatif (un
+ *   recalage par lot biaise fortement le prix sur de petits lots, et fige
+ *   S_T = forward sur un lot d'un seul tirage) et jamais appliqué au tirage
+ *   impair de l'antithétique
+ */
+struct PricingOptions {
+    SamplingMethod sampling{SamplingMethod::PSEUDO_RANDOM};
+    bool antithetic{false};
+    bool control_variate{false};
+    bool moment_matching{false};
+    
+    /*
+     * ARRÊT ADAPTATIF (0 = désactivé ; n_simulations devient alors un plafond)
+     * Simulation par lots de batch_size, arrêt dès que :
+     * - erreur standard ≤ target_standard_error, ou
+     * - demi-intervalle 95% (1.96 × SE) ≤ relative_tolerance × |prix|
+     * Avec SOBOL, l'erreur standard d'échantillon surestime l'erreur réelle :
+     * le critère est prudent (on s'arrête un peu plus tard que nécessaire)
+     * Critère testé à partir de 1,000 échantillons seulement : sur quelques
+     * tirages tous hors de la monnaie, l'erreur standard vaut 0
+     */
+    double target_standard_error{0.0};
+    double relative_tolerance{0.0};
+    size_t batch_size{10'000};
+};
 
 struct PricingMetrics {
     double option_value{0.0};
     size_t calculation_time_us{0};
     size_t monte_carlo_simulations{0};
+    double standard_error{0.0};  // Erreur standard de option_value (intervalle 95% ≈ ± 1.96 × SE)
+    bool target_reached{false};  // Mode adaptatif : précision demandée atteinte avant le plafond
 };
 
 class PricingCalculator {
 private:
     MonteCarloEngine mc_engine_;
+    BlackScholesModel bs_model_;  // Formules fermées des variables de contrôle
     
 public:
     explicit PricingCalculator(uint64_t seed = std::random_device{}()) 
@@ -33,7 +86,8 @@ public:
         double T,
         double r,
         double vol,
-        size_t n_simulations = 100'000
+        size_t n_simulations = 100'000,
+        const PricingOptions& options = {}
     ) const {
         
         auto start_time = std::chrono::high_resolution_clock::now();
@@ -56,9 +110,9 @@ public:
         
         // Simulation selon type d'option
         if (option_type == OptionType::EUROPEAN_CALL || option_type == OptionType::EUROPEAN_PUT) {
-            calculate_european_option(S, K, T, r, vol, option_type, n_simulations, metrics);
+            calculate_european_option(S, K, T, r, vol, option_type, n_simulations, options, metrics);
         } else {
-            calculate_path_dependent_option(S, K, T, r, vol, option_type, n_simulations, metrics);
+            calculate_path_dependent_option(S, K, T, r, vol, option_type, n_simulations, options, metrics);
         }
         
         auto end_time = std::chrono::high_resolution_clock::now();
@@ -68,48 +122,256 @@ public:
     }    
 
 private:
+    static constexpr double CONFIDENCE_Z_95 = 1.959963984540054;  // Quantile 97.5% de N(0,1)
+    static constexpr size_t MIN_ADAPTIVE_SAMPLES = 1'000;          // Avant tout test d'arrêt (SE fiable)
+    
+    /*
+     * BOUCLE DE SIMULATION PAR LOTS
+     * =============================
+     * run_batch(stats, first_sample, n_samples) ajoute n_samples échantillons
+     * (trajectoires, ou paires antithétiques) à stats.
+     * 
+     * Tous les lots tirent dans le MÊME flux aléatoire, à la suite
+     * (first_sample = 0, batch, 2×batch...) : s'arrêter après k lots donne
+     * exactement les k premiers lots d'un calcul sans arrêt.
+     * La variance est suivie en ligne (Welford) : moyenne et M2 de PathStatistics.
+     */
+    template<typename BatchFn>
+    [[nodiscard]] PathStatistics run_batches(
+        size_t n_samples, const PricingOptions& options, double control_mean, double discount,
+        PricingMetrics& metrics, BatchFn&& run_batch) const {
+        
+        const bool adaptive = is_adaptive(options);
+        const size_t batch = adaptive ? std::max<size_t>(options.batch_size, 2) : n_samples;
+        
+        PathStatistics stats;
+        for (size_t first = 0; first < n_samples; ) {
+            const size_t n = std::min(batch, n_samples - first);
+            run_batch(stats, first, n);
+            first += n;
+            
+            if (!adaptive || stats.count < MIN_ADAPTIVE_SAMPLES) continue;
+            
+            const auto [value, error] = estimate(stats, options, control_mean, discount);
+            if ((options.target_standard_error > 0.0 && error <= options.target_standard_error) ||
+                (options.relative_tolerance > 0.0 && CONFIDENCE_Z_95 * error <= options.relative_tolerance * std::abs(value))) {
+                metrics.target_reached = true;
+                break;
+            }
+        }
+        return stats;
+    }
+    
+    [[nodiscard]] static bool is_adaptive(const PricingOptions& options) noexcept {
+        return options.target_standard_error > 0.0 || options.relative_tolerance > 0.0;
+    }
+    
+    /*
+     * PRIX ACTUALISÉ ET ERREUR STANDARD À PARTIR DES STATISTIQUES
+     */
+    [[nodiscard]] static std::pair<double, double> estimate(
+        const PathStatistics& stats, const PricingOptions& options, double control_mean, double discount) noexcept {
+        if (options.control_variate) {
+            return {discount * stats.controlled_mean(control_mean), discount * stats.controlled_standard_error()};
+        }
+        return {discount * stats.mean(), discount * stats.standard_error()};
+    }
+    
+    /*
+     * plain_draws = échantillons simples ajoutés aux paires antithétiques
+     * (0 ou 1, cf. odd_draw) : une paire compte pour deux trajectoires
+     */
+    static void finalize(const PathStatistics& stats, const PricingOptions& options,
+                         double control_mean, double discount, size_t plain_draws, PricingMetrics& metrics) noexcept {
+        std::tie(metrics.option_value, metrics.standard_error) = estimate(stats, options, control_mean, discount);
+        metrics.monte_carlo_simulations = options.antithetic ? 2 * (stats.count - plain_draws) + plain_draws
+                                                             : stats.count;
+    }
+    
+    /*
+     * TIRAGE IMPAIR EN ANTITHÉTIQUE
+     * =============================
+     * n_simulations impair : n/2 paires ne font que n - 1 trajectoires.
+     * La dernière est un tirage simple, d'indice n/2 dans le flux (jamais
+     * utilisé par les paires), ajouté si l'arrêt adaptatif n'a pas déjà
+     * conclu. Retourne le nombre de tirages simples (0 ou 1) pour finalize.
+     * Son poids dans la moyenne est celui d'une paire : écart négligeable
+     * (un échantillon sur n/2), et aucun dépassement du budget demandé.
+     */
+    template<typename BatchFn>
+    [[nodiscard]] static size_t odd_draw(size_t n_simulations, const PricingOptions& options,
+                                         const PricingMetrics& metrics, PathStatistics& stats,
+                                         BatchFn&& run_plain) {
+        if (!options.antithetic || n_simulations % 2 == 0 || metrics.target_reached) return 0;
+        run_plain(stats, n_simulations / 2, 1);
+        return 1;
+    }
+    
     void calculate_european_option(
         double S, double K, double T, double r, double vol,
         OptionType option_type, size_t n_simulations,
-        PricingMetrics& metrics) const {
+        const PricingOptions& options, PricingMetrics& metrics) const {
         
-        // Simulation prix finaux seulement
-        std::vector<double> final_prices(n_simulations);
+        // Antithétique : n/2 tirages, chacun complété par son miroir (+ odd_draw si n impair)
+        const size_t n_draws = options.antithetic ? n_simulations / 2 : n_simulations;
         
-        // Pour chaque simulation, on utilise la formule fermée GBM
-        mc_engine_.simulate_final_prices(final_prices, S, r, vol, T);
+        const double forward = S * std::exp(r * T);
+        const double discount = std::exp(-r * T);
+        const double median_price = S * std::exp((r - 0.5 * vol * vol) * T);
+        const double mirror_factor = median_price * median_price;
+        const uint64_t stream = mc_engine_.reserve_stream();
         
-        // Calcul payoffs
-        double sum_payoffs = 0.0;
-        for (const auto& S_final : final_prices) {
-            sum_payoffs += PayoffModel::calculate_payoff(option_type, S_final, K);
-        }
+        std::vector<double> final_prices;
+        
+        // Hors mode adaptatif, run_batches fait un seul lot : l'échantillon entier
+        const bool match_moments = options.moment_matching && !is_adaptive(options);
+        
+        auto simulate = [&](PathStatistics& batch_stats, size_t first_draw, size_t n, bool antithetic, bool match) {
+            // Simulation prix finaux seulement
+            final_prices.resize(n);
+            
+            // Pour chaque simulation, on utilise la formule fermée GBM
+            if (options.sampling == SamplingMethod::SOBOL) {
+                mc_engine_.simulate_qmc_final_prices(final_prices, S, r, vol, T, stream, first_draw);
+            } else {
+                mc_engine_.simulate_final_prices(std::span<double>(final_prices), S, r, vol, T, stream, first_draw);
+            }
+            
+            /*
+             * PRIX MIROIRS (ANTITHÉTIQUE)
+             * ===========================
+             * S⁺ = S × exp(d + vZ) et S⁻ = S × exp(d - vZ) → S⁻ = (S × e^d)² / S⁺
+             * Pas besoin de connaître Z : une seule division par tirage
+             */
+            if (antithetic) {
+                final_prices.resize(2 * n);
+                for (size_t i = 0; i < n; ++i) {
+                    final_prices[n + i] = mirror_factor / final_prices[i];
+                }
+            }
+            
+            /*
+             * MOMENT MATCHING
+             * ===============
+             * Sous la probabilité risque-neutre, E[S_T] = S × e^{rT} exactement.
+             * L'échantillon s'en écarte un peu : on le remet à l'échelle, une fois.
+             * (Les tirages ne sont plus indépendants : l'erreur standard
+             *  affichée devient une approximation, en général pessimiste)
+             */
+            if (match) {
+                const double sample_mean = std::accumulate(final_prices.begin(), final_prices.end(), 0.0)
+                                         / final_prices.size();
+                const double scale = forward / sample_mean;
+                for (double& S_final : final_prices) S_final *= scale;
+            }
+            
+            // Calcul payoffs (une paire antithétique = un échantillon)
+            for (size_t i = 0; i < n; ++i) {
+                double payoff = PayoffModel::calculate_payoff(option_type, final_prices[i], K);
+                double control = final_prices[i];
+                if (antithetic) {
+                    payoff = 0.5 * (payoff + PayoffModel::calculate_payoff(option_type, final_prices[n + i], K));
+                    control = 0.5 * (control + final_prices[n + i]);
+                }
+                batch_stats.add(payoff, control);
+            }
+        };
         
-        const double mean_payoff = sum_payoffs / n_simulations;
-        metrics.option_value = std::exp(-r * T) * mean_payoff;
+        PathStatistics stats = run_batches(n_draws, options, forward, discount, metrics,
+            [&](PathStatistics& batch_stats, size_t first_draw, size_t n) {
+            simulate(batch_stats, first_draw, n, options.antithetic, match_moments);
+        });
+        const size_t plain_draws = odd_draw(n_simulations, options, metrics, stats,
+            [&](PathStatistics& batch_stats, size_t first_draw, size_t n) {
+            simulate(batch_stats, first_draw, n, false, false);  // Un seul tirage : rien à recaler
+        });
+        
+        finalize(stats, options, forward, discount, plain_draws, metrics);
     }
     
     void calculate_path_dependent_option(
         double S, double K, double T, double r, double vol,
         OptionType option_type, size_t n_simulations,
-        PricingMetrics& metrics) const {
+        const PricingOptions& options, PricingMetrics& metrics) const {
         
-        // Simulation trajectoires complètes
+        // Trajectoires générées et repliées dans le payoff au fil de l'eau :
+        // pas de matrice n_simulations × (n_steps + 1) en mémoire
         const size_t n_steps = static_cast<size_t>(T * 252);
-        std::vector<double> paths(n_simulations * (n_steps + 1));
-        mc_engine_.simulate_gbm_paths(paths, S, r, vol, T, n_steps, n_simulations);
-        
-        // Calcul payoffs avec trajectoires
-        double sum_payoffs = 0.0;
-        for (size_t i = 0; i < n_simulations; ++i) {
-            const size_t start_idx = i * (n_steps + 1);
-            std::span<const double> path_i(paths.data() + start_idx, n_steps + 1);
-            const double S_final = paths[start_idx + n_steps];
-            
-            sum_payoffs += PayoffModel::calculate_payoff(option_type, S_final, K, path_i);
+        const PayoffModel::PayoffAccumulator payoff(option_type, K, 0.0, 1.0, options.control_variate);
+        
+        // Antithétique : n_paths = nombre de paires (+ odd_draw si n impair)
+        const size_t n_paths = options.antithetic ? n_simulations / 2 : n_simulations;
+        
+        const double discount = std::exp(-r * T);
+        const double control_mean = options.control_variate
+            ? control_expectation(option_type, S, K, T, r, vol, n_steps) : 0.0;
+        const uint64_t stream = mc_engine_.reserve_stream();
+        
+        auto simulate = [&](PathStatistics& batch_stats, size_t first_path, size_t n, bool antithetic) {
+            batch_stats.merge(options.sampling == SamplingMethod::SOBOL
+                ? mc_engine_.fold_qmc_paths(payoff, S, r, vol, T, n_steps, n, stream, first_path, antithetic)
+                : mc_engine_.fold_gbm_paths(payoff, S, r, vol, T, n_steps, n, stream, first_path, antithetic));
+        };
+        
+        PathStatistics stats = run_batches(n_paths, options, control_mean, discount, metrics,
+            [&](PathStatistics& batch_stats, size_t first_path, size_t n) {
+            simulate(batch_stats, first_path, n, options.antithetic);
+        });
+        const size_t plain_draws = odd_draw(n_simulations, options, metrics, stats,
+            [&](PathStatistics& batch_stats, size_t first_path, size_t n) {
+            simulate(batch_stats, first_path, n, false);
+        });
+        
+        finalize(stats, options, control_mean, discount, plain_draws, metrics);
+    }
+    
+    /*
+     * ESPÉRANCE EXACTE DE LA VARIABLE DE CONTRÔLE (non actualisée)
+     * ============================================================
+     * Cf. PayoffModel::PayoffAccumulator::control()
+     */
+    [[nodiscard]] double control_expectation(
+        OptionType option_type, double S, double K, double T, double r, double vol, size_t n_steps) const {
+        
+        switch (option_type) {
+            case OptionType::ASIAN_CALL:
+            case OptionType::ASIAN_PUT:
+                return geometric_asian_expectation(option_type == OptionType::ASIAN_CALL, S, K, T, r, vol, n_steps);
+            default: {
+                // Call vanille : prix Black-Scholes capitalisé
+                const auto vanilla = bs_model_.price(S, K, T, r, vol, true);
+                return vanilla.has_value() ? vanilla.value() * std::exp(r * T) : 0.0;
+            }
         }
+    }
+    
+    /*
+     * ASIATIQUE GÉOMÉTRIQUE DISCRÈTE (formule fermée)
+     * ===============================================
+     * G = (S_0 × S_1 × ... × S_n)^(1/(n+1)), dates t_i = i × T/n (S_0 inclus,
+     * comme la moyenne arithmétique de PayoffModel)
+     * ln G est gaussien :
+     *     μ_G = ln S + (r - σ²/2) × T/2
+     *     σ_G² = σ² × dt × n(2n+1) / (6(n+1))
+     * → E[(G - K)+] = e^{μ_G + σ_G²/2} N(d1) - K N(d2)  (Black sur G)
+     */
+    [[nodiscard]] static double geometric_asian_expectation(
+        bool is_call, double S, double K, double T, double r, double vol, size_t n_steps) noexcept {
+        
+        if (n_steps == 0) return is_call ? std::max(S - K, 0.0) : std::max(K - S, 0.0);
+        
+        const double n = static_cast<double>(n_steps);
+        const double dt = T / n;
+        const double mu_g = std::log(S) + (r - 0.5 * vol * vol) * 0.5 * T;
+        const double var_g = vol * vol * dt * n * (2.0 * n + 1.0) / (6.0 * (n + 1.0));
+        const double sigma_g = std::sqrt(var_g);
+        const double forward_g = std::exp(mu_g + 0.5 * var_g);  // E[G]
+        
+        const double d1 = (mu_g - std::log(K) + var_g) / sigma_g;
+        const double d2 = d1 - sigma_g;
         
-        const double mean_payoff = sum_payoffs / n_simulations;
-        metrics.option_value = std::exp(-r * T) * mean_payoff;
+        return is_call
+            ? forward_g * FastMath::norm_cdf(d1) - K * FastMath::norm_cdf(d2)
+            : K * FastMath::norm_cdf(-d2) - forward_g * FastMath::norm_cdf(-d1);
     }
 };
\ No newline at end of file
@@ -12,15 +12,28 @@
 
 #include "types.hpp"       // Pour expected<>, RiskError, etc.
 #include "math_utils.hpp"  // Pour FastMath::norm_cdf(), etc.
-#include <unordered_map>   // Pour le cache des résultats
-#include <string>          // Pour les clés du cache
+#include "pricing_cache.hpp" // Cache borné des prix (clé POD, éviction CLOCK)
+#include "implied_volatility.hpp" // Inversion prix → vol par lots
 #include <cmath>          // Pour exp(), sqrt(), etc.
+#include <cstdint>        // Pour uint8_t (type d'option dans les lots)
+#include <array>          // Pour les tranches locales du calcul par lots
+#include <span>           // Pour les entrées/sorties des calculs par lots
 
 // ===== MODÈLE DE PRICING BLACK-SCHOLES =====
 /*
  * Cette classe implémente le modèle Black-Scholes pour calculer :
  * 1. Le PRIX d'une option (combien elle vaut aujourd'hui)
  * 2. Les GREEKS (sensibilités aux différents paramètres)
+ * 
+ * DEUX COUCHES :
+ * - Noyau sans état : price_uncached, delta, gamma, vega, theta, implied_volatility,
+ *   calculate_all_greeks, calculate_extended_greeks, price_and_greeks_batch,
+ *   extended_greeks_batch sont static (aucune donnée partagée, réentrants,
+ *   appelables depuis n'importe quel thread)
+ * - Mémoïsation optionnelle : price() passe par cache_, table sans verrou
+ * → une même instance peut être partagée par tous les threads de pricing
+ *   (ex : PricingCalculator::bs_model_, lu par calculate_option_price const
+ *   depuis plusieurs threads) sans course de données ni contention
  */
 class BlackScholesModel {
 private:
@@ -30,57 +43,76 @@ private:
      * On stocke les résultats déjà calculés pour éviter de refaire
      * les mêmes calculs (très important en trading haute fréquence)
      */
-    mutable std::unordered_map<std::string, double> cache_;
+    mutable PricingCache cache_;
     /*
      * mutable = on peut modifier ce membre même dans une fonction const
-     * unordered_map = dictionnaire rapide (hash table)
-     * string = clé unique pour identifier chaque calcul
-     * double = prix/résultat calculé
+     * (sûr ici : PricingCache est sans verrou et thread-safe)
+     * PricingCache = table de capacité fixe (éviction CLOCK), clé = bits bruts
+     * des paramètres + call/put, une séquence par entrée (pricing_cache.hpp)
      */
     
+public:
     /*
-     * GÉNÉRATION DE CLÉ UNIQUE POUR LE CACHE
-     * ======================================
-     * Combine tous les paramètres en une seule chaîne unique
+     * CONSTRUCTION
+     * ============
+     * cache_capacity : nombre de prix mémorisés (0 = pas de cache)
      */
-    [[nodiscard]] std::string make_cache_key(double S, double K, double T, double r, double vol) const {
-        /*
-         * Paramètres :
-         * S = Prix spot (prix actuel de l'actif)
-         * K = Strike (prix d'exercice)
-         * T = Time to maturity (temps jusqu'à expiration)
-         * r = Risk-free rate (taux sans risque)
-         * vol = Volatility (volatilité)
-         */
-        
-        // Concatène tous les paramètres avec "_" comme séparateur
-        return std::to_string(S) + "_" + std::to_string(K) + "_" + 
-               std::to_string(T) + "_" + std::to_string(r) + "_" + std::to_string(vol);
-        /*
-         * Exemple de clé : "100.0_105.0_0.25_0.05_0.20"
-         * En production, on utiliserait un hash plus sophistiqué
-         */
-    }
+    explicit BlackScholesModel(size_t cache_capacity = PricingCache::DEFAULT_CAPACITY)
+        : cache_(cache_capacity) {}
     
-public:
     /*
      * NETTOYAGE DU CACHE
      * ==================
-     * Vide le cache pour éviter qu'il devienne trop gros en mémoire
+     * Vide le cache (capacité et compteurs inchangés)
      */
     void clear_cache() { cache_.clear(); }
     
+    // Hits, misses, évictions, taux de succès du cache
+    [[nodiscard]] CacheStats cache_stats() const { return cache_.stats(); }
+    
     /*
      * FONCTION PRINCIPALE : CALCUL DU PRIX D'UNE OPTION
      * =================================================
      * C'est LE calcul central du modèle Black-Scholes
+     * (même calcul que price_uncached(), mémorisé dans le cache)
      */
     [[nodiscard]] expected<double, RiskError> price(double S, double K, double T, double r, double vol, bool is_call = true ) const {
             /*
             * expected<double, RiskError> = retourne SOIT un prix SOIT une erreur
             * Plus sûr que de lancer des exceptions
             */
+            if (!cache_.enabled()) return price_uncached(S, K, T, r, vol, is_call);
+            
+            /*
+            * VÉRIFICATION DU CACHE
+            * =====================
+            * On regarde si on a déjà calculé ce prix avant
+            * (clé sans allocation : les 5 doubles et le type d'option)
+            */
+            const PricingKey key{S, K, T, r, vol, is_call};
+            if (const auto cached = cache_.find(key)) {
+                return expected<double, RiskError>{*cached};
+            }
             
+            /*
+            * CALCUL, STOCKAGE EN CACHE ET RETOUR
+            * ====================================
+            * Les erreurs de validation ne sont pas mémorisées
+            */
+            const auto result = price_uncached(S, K, T, r, vol, is_call);
+            if (!result.has_value()) return expected<double, RiskError>{result.error()};
+            cache_.insert(key, result.value());  // Sauvegarde pour la prochaine fois
+            return expected<double, RiskError>{result.value()};
+    }
+    
+    /*
+     * PRIX SANS CACHE
+     * ===============
+     * Validation + formule fermée, sans toucher au cache (ni verrou ni compteur) :
+     * pour les boucles chaudes dont les paramètres ne se répètent pas
+     * (scénarios Monte Carlo, courbes de prix, calibration)
+     */
+    [[nodiscard]] static expected<double, RiskError> price_uncached(double S, double K, double T, double r, double vol, bool is_call = true) noexcept {
             /*
             * VALIDATION DES PARAMÈTRES D'ENTRÉE
             * ===================================
@@ -116,22 +148,6 @@ public:
                 */
             }
             
-            /*
-            * VÉRIFICATION DU CACHE
-            * =====================
-            * On regarde si on a déjà calculé ce prix avant
-            */
-            const auto cache_key = make_cache_key(S, K, T, r, vol);
-            if (auto it = cache_.find(cache_key); it != cache_.end()) {
-                return expected<double, RiskError>{it->second};
-            }
-            /*
-            * auto it = itérateur sur le cache
-            * cache_.find() cherche la clé
-            * it != cache_.end() = "on a trouvé quelque chose"
-            * it->second = la valeur stockée (le prix calculé précédemment)
-            */
-            
             /*
             * CALCUL BLACK-SCHOLES PROPREMENT DIT
             * ====================================
@@ -165,11 +181,6 @@ public:
             * - Deuxième terme : coût d'exercice actualisé
             */
             
-            /*
-            * STOCKAGE EN CACHE ET RETOUR
-            * ============================
-            */
-            cache_[cache_key] = price;  // Sauvegarde pour la prochaine fois
             return expected<double, RiskError>{price};  // Retourne le résultat
     }
     
@@ -179,7 +190,7 @@ public:
      * Delta = sensibilité du prix de l'option au prix de l'actif sous-jacent
      * "Si le sous-jacent monte de 1$, l'option monte de Delta$"
      */
-    [[nodiscard]] double delta(double S, double K, double T, double r, double vol, bool is_call = true) const {
+    [[nodiscard]] static double delta(double S, double K, double T, double r, double vol, bool is_call = true) noexcept {
         // Cas dégénérés
         if (T <= 0 || vol <= 0) {
             return is_call ? (S > K ? 1.0 : 0.0) : (S < K ? -1.0 : 0.0);
@@ -215,7 +226,7 @@ public:
      * Gamma = sensibilité du Delta au prix du sous-jacent
      * "Comment le Delta change quand le prix change"
      */
-    [[nodiscard]] double gamma(double S, double K, double T, double r, double vol) const {
+    [[nodiscard]] static double gamma(double S, double K, double T, double r, double vol) noexcept {
         if (T <= 0 || vol <= 0) return 0.0;  // Pas de convexité à l'expiration
         
         const auto [d1, d2] = FastMath::black_scholes_d1_d2(S, K, T, r, vol);
@@ -239,7 +250,7 @@ public:
      * Vega = sensibilité du prix à la volatilité
      * "Si la volatilité monte de 1%, l'option monte de Vega$"
      */
-    [[nodiscard]] double vega(double S, double K, double T, double r, double vol) const {
+    [[nodiscard]] static double vega(double S, double K, double T, double r, double vol) noexcept {
         if (T <= 0 || vol <= 0) return 0.0;  // Pas de sensibilité vol à l'expiration
         
         const auto [d1, d2] = FastMath::black_scholes_d1_d2(S, K, T, r, vol);
@@ -263,7 +274,7 @@ public:
      * Theta = sensibilité du prix au passage du temps
      * "Combien l'option perd de valeur chaque jour"
      */
-    [[nodiscard]] double theta(double S, double K, double T, double r, double vol, bool is_call = true) const {
+    [[nodiscard]] static double theta(double S, double K, double T, double r, double vol, bool is_call = true) noexcept {
         if (T <= 0 || vol <= 0) return 0.0;  // Plus de décroissance temporelle
         
         const auto [d1, d2] = FastMath::black_scholes_d1_d2(S, K, T, r, vol);
@@ -310,7 +321,7 @@ public:
      * Calcule Delta, Gamma, Vega, Theta en une seule passe
      * Plus efficace car on réutilise d1, d2, norm_pdf(d1), etc.
      */
-    [[nodiscard]] Greeks calculate_all_greeks(double S, double K, double T, double r, double vol, bool is_call = true) const {
+    [[nodiscard]] static Greeks calculate_all_greeks(double S, double K, double T, double r, double vol, bool is_call = true) noexcept {
         // Cas dégénérés : expiration ou volatilité nulle
         if (T <= 0 || vol <= 0) {
             return {
@@ -365,6 +376,402 @@ public:
          */
     }
 
+    /*
+     * GREEKS ÉTENDUS (ORDRE 1, 2 ET SPEED)
+     * ====================================
+     * Toutes les sensibilités utiles au risk management, en unités "desk" :
+     * - vega, rho        : pour 1% de vol / de taux
+     * - theta, charm     : par jour calendaire (le temps qui passe)
+     * - vanna            : variation du delta pour +1% de vol (= dVega/dS)
+     * - volga (vomma)    : variation du vega (par 1%) pour +1% de vol
+     * - speed            : variation du gamma pour +1$ de sous-jacent
+     * Les champs s'additionnent : une position × notional, un sous-jacent
+     * = somme de ses positions (add).
+     */
+    struct ExtendedGreeks {
+        double price{0.0};
+        double delta{0.0};
+        double gamma{0.0};
+        double vega{0.0};
+        double theta{0.0};
+        double rho{0.0};    // dV/dr
+        double vanna{0.0};  // d²V/dS dσ
+        double volga{0.0};  // d²V/dσ²
+        double charm{0.0};  // dDelta/dt
+        double speed{0.0};  // d³V/dS³
+
+        // Accumulation pondérée (weight = notional, ou -1 pour retirer une position)
+        void add(const ExtendedGreeks& g, double weight = 1.0) noexcept {
+            price += weight * g.price;
+            delta += weight * g.delta;
+            gamma += weight * g.gamma;
+            vega += weight * g.vega;
+            theta += weight * g.theta;
+            rho += weight * g.rho;
+            vanna += weight * g.vanna;
+            volga += weight * g.volga;
+            charm += weight * g.charm;
+            speed += weight * g.speed;
+        }
+
+        [[nodiscard]] ExtendedGreeks scaled(double weight) const noexcept {
+            ExtendedGreeks result;
+            result.add(*this, weight);
+            return result;
+        }
+    };
+
+    /*
+     * CALCUL EN UNE PASSE DES GREEKS ÉTENDUS
+     * ======================================
+     * Une seule évaluation de d1, d2, φ(d1), N(±d1), N(±d2) et e^{-rT},
+     * dont on dérive le prix et les neuf sensibilités
+     */
+    [[nodiscard]] static ExtendedGreeks calculate_extended_greeks(double S, double K, double T, double r, double vol, bool is_call = true) noexcept {
+        const double w = is_call ? 1.0 : -1.0;
+
+        // Cas dégénérés : valeur intrinsèque, delta en marche d'escalier, le reste nul
+        if (T <= 0 || vol <= 0) {
+            return {
+                .price = std::max(w * (S - K), 0.0),
+                .delta = is_call ? (S > K ? 1.0 : 0.0) : (S < K ? -1.0 : 0.0)
+            };
+        }
+
+        /*
+         * INTERMÉDIAIRES PARTAGÉS
+         * =======================
+         */
+        const auto [d1, d2] = FastMath::black_scholes_d1_d2(S, K, T, r, vol);
+        const double sqrt_T = std::sqrt(T);
+        const double vol_sqrt_T = vol * sqrt_T;
+        const double pdf_d1 = FastMath::norm_pdf(d1);
+        const double n_d1 = FastMath::norm_cdf(w * d1);  // N(d1) ou N(-d1)
+        const double n_d2 = FastMath::norm_cdf(w * d2);  // N(d2) ou N(-d2)
+        const double discounted_K = K * std::exp(-r * T);
+
+        const double gamma_val = pdf_d1 / (S * vol_sqrt_T);
+        const double raw_vega = S * pdf_d1 * sqrt_T;  // dV/dσ (σ en fraction)
+
+        /*
+         * FORMULES (w = +1 call, -1 put ; pas de dividende)
+         * rho   = w K T e^{-rT} N(w d2)
+         * vanna = -φ(d1) d2 / σ
+         * volga = S φ(d1) √T d1 d2 / σ
+         * charm = -φ(d1) (2rT - d2 σ√T) / (2T σ√T)    (identique call/put)
+         * speed = -Γ / S × (1 + d1 / σ√T)
+         */
+        return {
+            .price = w * (S * n_d1 - discounted_K * n_d2),
+            .delta = w * n_d1,
+            .gamma = gamma_val,
+            .vega = raw_vega / 100.0,
+            .theta = (-S * pdf_d1 * vol / (2 * sqrt_T) - w * r * discounted_K * n_d2) / 365.0,
+            .rho = w * T * discounted_K * n_d2 / 100.0,
+            .vanna = -pdf_d1 * d2 / vol / 100.0,
+            .volga = raw_vega * d1 * d2 / vol / 10000.0,
+            .charm = -pdf_d1 * (2.0 * r * T - d2 * vol_sqrt_T) / (2.0 * T * vol_sqrt_T) / 365.0,
+            .speed = -gamma_val / S * (1.0 + d1 / vol_sqrt_T)
+        };
+    }
+
+    /*
+     * SORTIES DU CALCUL PAR LOTS
+     * ==========================
+     * Une span par grandeur, même taille que les entrées (mêmes unités que Greeks :
+     * vega pour 1% de vol, theta par jour calendaire)
+     */
+    struct GreeksBatch {
+        std::span<double> price;
+        std::span<double> delta;
+        std::span<double> gamma;
+        std::span<double> vega;
+        std::span<double> theta;
+    };
+    
+    /*
+     * PRIX ET GREEKS PAR LOTS (STRUCTURE DE TABLEAUX)
+     * ===============================================
+     * Option i = (S[i], K[i], T[i], r[i], vol[i], is_call[i]) → out.*[i]
+     * 
+     * Pas de validation par appel, pas d'expected<>, pas de cache :
+     * une seule boucle sans branchement (fast_log, fast_exp, fast_norm_cdf,
+     * sélections) que le compilateur vectorise (AVX2 / AVX-512 avec -O3 -march=native).
+     * 
+     * CAS PARTICULIERS (masques, calculés dans la boucle) :
+     * - T == 0 → valeur intrinsèque, delta 0/±1, autres Greeks nuls (comme price())
+     * - Entrées refusées par price() (vol ≤ 0, T < 0, S ≤ 0, K ≤ 0) → tout à 0,
+     *   et valid[i] = 0 si la span valid est fournie
+     * Les options masquées sont calculées avec des entrées neutres (1.0)
+     * puis écrasées : aucun NaN ni division par zéro dans la boucle.
+     */
+    static constexpr size_t BATCH_CHUNK = 64;  // Options par tranche (5 × 512 octets en pile)
+    
+    static void price_and_greeks_batch(
+        std::span<const double> S,
+        std::span<const double> K,
+        std::span<const double> T,
+        std::span<const double> r,
+        std::span<const double> vol,
+        std::span<const uint8_t> is_call,
+        const GreeksBatch& out,
+        std::span<uint8_t> valid = {}) noexcept {
+        
+        /*
+         * TRAITEMENT PAR TRANCHES DE BATCH_CHUNK OPTIONS
+         * ==============================================
+         * Les résultats d'une tranche vont d'abord dans des tableaux locaux :
+         * le compilateur sait qu'ils ne recouvrent aucune entrée, il n'a donc
+         * pas à tester à l'exécution le recouvrement des 11 spans (ce qui,
+         * au-delà de 10 tests, l'empêche de vectoriser la boucle)
+         */
+        const size_t n = S.size();
+        for (size_t begin = 0; begin < n; begin += BATCH_CHUNK) {
+            const size_t m = std::min(BATCH_CHUNK, n - begin);
+            std::array<double, BATCH_CHUNK> chunk_price, chunk_delta, chunk_gamma, chunk_vega, chunk_theta;
+            
+            // Call : +1, Put : -1 (converti à part : octets et doubles dans une même boucle
+            // n'ont pas la même largeur de vecteur, ce qui bloque la vectorisation)
+            std::array<double, BATCH_CHUNK> chunk_sign;
+            for (size_t lane = 0; lane < m; ++lane) chunk_sign[lane] = is_call[begin + lane] ? 1.0 : -1.0;
+            
+            for (size_t lane = 0; lane < m; ++lane) {
+                const size_t j = begin + lane;
+                // & et non && : pas d'évaluation paresseuse, donc pas de branche
+                const bool ok = (vol[j] > 0.0) & (T[j] >= 0.0) & (K[j] > 0.0) & (S[j] > 0.0);
+                const bool live = ok & (T[j] > 0.0);
+                
+                // Entrées neutres pour les options masquées
+                const double s = ok ? S[j] : 1.0;
+                const double k = ok ? K[j] : 1.0;
+                const double t = live ? T[j] : 1.0;
+                const double v = live ? vol[j] : 1.0;
+                const double rate = r[j];
+                const double w = chunk_sign[lane];
+                
+                const double sqrt_t = std::sqrt(t);
+                const double vol_sqrt_t = v * sqrt_t;
+                const double d1 = (FastMath::fast_log(s / k) + (rate + 0.5 * v * v) * t) / vol_sqrt_t;
+                const double d2 = d1 - vol_sqrt_t;
+                const double discounted_k = k * FastMath::fast_exp(-rate * t);
+                const double n_d1 = FastMath::fast_norm_cdf(w * d1);  // N(d1) ou N(-d1)
+                const double n_d2 = FastMath::fast_norm_cdf(w * d2);  // N(d2) ou N(-d2)
+                const double pdf_d1 = FastMath::INV_SQRT_2PI * FastMath::fast_exp(-0.5 * d1 * d1);
+                
+                /*
+                 * FORMULES UNIFIÉES CALL/PUT (w = ±1)
+                 * prix  = w × (S N(w d1) - K e^{-rT} N(w d2))
+                 * delta = w × N(w d1)                (put : N(d1) - 1 = -N(-d1))
+                 * theta = (-S φ(d1) σ / 2√T - w r K e^{-rT} N(w d2)) / 365
+                 */
+                const double price = w * (s * n_d1 - discounted_k * n_d2);
+                const double delta = w * n_d1;
+                const double gamma = pdf_d1 / (s * vol_sqrt_t);
+                const double vega = s * pdf_d1 * sqrt_t / 100.0;
+                const double theta = (-s * pdf_d1 * v / (2.0 * sqrt_t) - w * rate * discounted_k * n_d2) / 365.0;
+                
+                // Expiration : valeur intrinsèque et delta en marche d'escalier
+                const double moneyness = w * (s - k);
+                const double intrinsic = std::max(moneyness, 0.0);
+                const double step_delta = moneyness > 0.0 ? w : 0.0;
+                
+                chunk_price[lane] = live ? price : (ok ? intrinsic : 0.0);
+                chunk_delta[lane] = live ? delta : (ok ? step_delta : 0.0);
+                chunk_gamma[lane] = live ? gamma : 0.0;
+                chunk_vega[lane] = live ? vega : 0.0;
+                chunk_theta[lane] = live ? theta : 0.0;
+            }
+                
+            std::copy_n(chunk_price.begin(), m, out.price.begin() + begin);
+            std::copy_n(chunk_delta.begin(), m, out.delta.begin() + begin);
+            std::copy_n(chunk_gamma.begin(), m, out.gamma.begin() + begin);
+            std::copy_n(chunk_vega.begin(), m, out.vega.begin() + begin);
+            std::copy_n(chunk_theta.begin(), m, out.theta.begin() + begin);
+        }
+        
+        if (!valid.empty()) {
+            for (size_t i = 0; i < n; ++i) {
+                valid[i] = (vol[i] > 0.0) & (T[i] >= 0.0) & (K[i] > 0.0) & (S[i] > 0.0);
+            }
+        }
+    }
+
+    /*
+     * SORTIES DES GREEKS ÉTENDUS PAR LOTS
+     * ===================================
+     * Une span par champ d'ExtendedGreeks (mêmes unités), toutes requises
+     */
+    struct ExtendedGreeksBatch {
+        std::span<double> price;
+        std::span<double> delta;
+        std::span<double> gamma;
+        std::span<double> vega;
+        std::span<double> theta;
+        std::span<double> rho;
+        std::span<double> vanna;
+        std::span<double> volga;
+        std::span<double> charm;
+        std::span<double> speed;
+
+        // Option i rassemblée (pour l'agrégation par position)
+        [[nodiscard]] ExtendedGreeks at(size_t i) const noexcept {
+            return {.price = price[i], .delta = delta[i], .gamma = gamma[i], .vega = vega[i],
+                    .theta = theta[i], .rho = rho[i], .vanna = vanna[i], .volga = volga[i],
+                    .charm = charm[i], .speed = speed[i]};
+        }
+    };
+
+    /*
+     * GREEKS ÉTENDUS PAR LOTS (STRUCTURE DE TABLEAUX)
+     * ===============================================
+     * Même noyau que price_and_greeks_batch (même tranches, mêmes masques,
+     * mêmes cas particuliers) : d1, d2, φ(d1), N(w d1), N(w d2), e^{-rT}
+     * évalués une fois par option, les dix sorties en découlent par
+     * quelques multiplications. Identique à calculate_extended_greeks à la
+     * précision de fast_norm_cdf près (~1e-7).
+     */
+    static void extended_greeks_batch(
+        std::span<const double> S,
+        std::span<const double> K,
+        std::span<const double> T,
+        std::span<const double> r,
+        std::span<const double> vol,
+        std::span<const uint8_t> is_call,
+        const ExtendedGreeksBatch& out,
+        std::span<uint8_t> valid = {}) noexcept {
+
+        const size_t n = S.size();
+        for (size_t begin = 0; begin < n; begin += BATCH_CHUNK) {
+            const size_t m = std::min(BATCH_CHUNK, n - begin);
+            std::array<double, BATCH_CHUNK> chunk_price, chunk_delta, chunk_gamma, chunk_vega, chunk_theta;
+            std::array<double, BATCH_CHUNK> chunk_rho, chunk_vanna, chunk_volga, chunk_charm, chunk_speed;
+
+            std::array<double, BATCH_CHUNK> chunk_sign;
+            for (size_t lane = 0; lane < m; ++lane) chunk_sign[lane] = is_call[begin + lane] ? 1.0 : -1.0;
+
+            for (size_t lane = 0; lane < m; ++lane) {
+                const size_t j = begin + lane;
+                const bool ok = (vol[j] > 0.0) & (T[j] >= 0.0) & (K[j] > 0.0) & (S[j] > 0.0);
+                const bool live = ok & (T[j] > 0.0);
+
+                const double s = ok ? S[j] : 1.0;
+                const double k = ok ? K[j] : 1.0;
+                const double t = live ? T[j] : 1.0;
+                const double v = live ? vol[j] : 1.0;
+                const double rate = r[j];
+                const double w = chunk_sign[lane];
+
+                // Intermédiaires partagés par toutes les sorties
+                const double sqrt_t = std::sqrt(t);
+                const double vol_sqrt_t = v * sqrt_t;
+                const double d1 = (FastMath::fast_log(s / k) + (rate + 0.5 * v * v) * t) / vol_sqrt_t;
+                const double d2 = d1 - vol_sqrt_t;
+                const double discounted_k = k * FastMath::fast_exp(-rate * t);
+                const double n_d1 = FastMath::fast_norm_cdf(w * d1);
+                const double n_d2 = FastMath::fast_norm_cdf(w * d2);
+                const double pdf_d1 = FastMath::INV_SQRT_2PI * FastMath::fast_exp(-0.5 * d1 * d1);
+                const double raw_vega = s * pdf_d1 * sqrt_t;
+                const double gamma = pdf_d1 / (s * vol_sqrt_t);
+
+                // Formules : voir calculate_extended_greeks
+                const double price = w * (s * n_d1 - discounted_k * n_d2);
+                const double delta = w * n_d1;
+                const double vega = raw_vega / 100.0;
+                const double theta = (-s * pdf_d1 * v / (2.0 * sqrt_t) - w * rate * discounted_k * n_d2) / 365.0;
+                const double rho = w * t * discounted_k * n_d2 / 100.0;
+                const double vanna = -pdf_d1 * d2 / v / 100.0;
+                const double volga = raw_vega * d1 * d2 / v / 10000.0;
+                const double charm = -pdf_d1 * (2.0 * rate * t - d2 * vol_sqrt_t) / (2.0 * t * vol_sqrt_t) / 365.0;
+                const double speed = -gamma / s * (1.0 + d1 / vol_sqrt_t);
+
+                const double moneyness = w * (s - k);
+                const double intrinsic = std::max(moneyness, 0.0);
+                const double step_delta = moneyness > 0.0 ? w : 0.0;
+
+                chunk_price[lane] = live ? price : (ok ? intrinsic : 0.0);
+                chunk_delta[lane] = live ? delta : (ok ? step_delta : 0.0);
+                chunk_gamma[lane] = live ? gamma : 0.0;
+                chunk_vega[lane] = live ? vega : 0.0;
+                chunk_theta[lane] = live ? theta : 0.0;
+                chunk_rho[lane] = live ? rho : 0.0;
+                chunk_vanna[lane] = live ? vanna : 0.0;
+                chunk_volga[lane] = live ? volga : 0.0;
+                chunk_charm[lane] = live ? charm : 0.0;
+                chunk_speed[lane] = live ? speed : 0.0;
+            }
+
+            std::copy_n(chunk_price.begin(), m, out.price.begin() + begin);
+            std::copy_n(chunk_delta.begin(), m, out.delta.begin() + begin);
+            std::copy_n(chunk_gamma.begin(), m, out.gamma.begin() + begin);
+            std::copy_n(chunk_vega.begin(), m, out.vega.begin() + begin);
+            std::copy_n(chunk_theta.begin(), m, out.theta.begin() + begin);
+            std::copy_n(chunk_rho.begin(), m, out.rho.begin() + begin);
+            std::copy_n(chunk_vanna.begin(), m, out.vanna.begin() + begin);
+            std::copy_n(chunk_volga.begin(), m, out.volga.begin() + begin);
+            std::copy_n(chunk_charm.begin(), m, out.charm.begin() + begin);
+            std::copy_n(chunk_speed.begin(), m, out.speed.begin() + begin);
+        }
+
+        if (!valid.empty()) {
+            for (size_t i = 0; i < n; ++i) {
+                valid[i] = (vol[i] > 0.0) & (T[i] >= 0.0) & (K[i] > 0.0) & (S[i] > 0.0);
+            }
+        }
+    }
+
+    /*
+     * VOLATILITÉ IMPLICITE PAR LOTS
+     * =============================
+     * Option i = (S[i], K[i], T[i], r[i], price[i], is_call[i]) → vol[i]
+     * telle que price_and_greeks_batch redonne price[i] (même CDF).
+     * Ramené au modèle de Black sur le forward : F = S e^{rT}, D = e^{-rT}
+     * (ImpliedVolatility::black_batch, implied_volatility.hpp)
+     */
+    static void implied_volatility_batch(
+        std::span<const double> S,
+        std::span<const double> K,
+        std::span<const double> T,
+        std::span<const double> r,
+        std::span<const double> price,
+        std::span<const uint8_t> is_call,
+        std::span<double> vol,
+        std::span<ImpliedVolStatus> status = {}) noexcept {
+        
+        const size_t n = S.size();
+        for (size_t begin = 0; begin < n; begin += BATCH_CHUNK) {
+            const size_t m = std::min(BATCH_CHUNK, n - begin);
+            std::array<double, BATCH_CHUNK> forward, discount;
+            for (size_t lane = 0; lane < m; ++lane) {
+                const size_t j = begin + lane;
+                discount[lane] = FastMath::fast_exp(-r[j] * T[j]);
+                forward[lane] = S[j] / discount[lane];
+            }
+            ImpliedVolatility::black_batch(
+                std::span<const double>(forward.data(), m), K.subspan(begin, m), T.subspan(begin, m),
+                std::span<const double>(discount.data(), m), price.subspan(begin, m), is_call.subspan(begin, m),
+                vol.subspan(begin, m), status.empty() ? status : status.subspan(begin, m));
+        }
+    }
+    
+    /*
+     * VOLATILITÉ IMPLICITE D'UNE OPTION
+     * Erreurs : INVALID_STRIKE (S ou K ≤ 0), NEGATIVE_TIME (T ≤ 0),
+     * COMPUTATION_FAILED (prix hors des bornes d'arbitrage, sans valeur temps
+     * mesurable, ou non convergé)
+     */
+    [[nodiscard]] static expected<double, RiskError> implied_volatility(
+        double price, double S, double K, double T, double r, bool is_call = true) noexcept {
+        if (T <= 0) return expected<double, RiskError>{RiskError::NEGATIVE_TIME};
+        if (K <= 0 || S <= 0) return expected<double, RiskError>{RiskError::INVALID_STRIKE};
+        
+        const uint8_t call = is_call;
+        double vol = 0.0;
+        ImpliedVolStatus status = ImpliedVolStatus::INVALID_INPUT;
+        implied_volatility_batch({&S, 1}, {&K, 1}, {&T, 1}, {&r, 1}, {&price, 1}, {&call, 1}, {&vol, 1}, {&status, 1});
+        if (status != ImpliedVolStatus::CONVERGED) return expected<double, RiskError>{RiskError::COMPUTATION_FAILED};
+        return expected<double, RiskError>{vol};
+    }
+
 };
 
 /*
@@ -372,15 +779,21 @@ public:
  * ======================
  * 
  * CLASSE BlackScholesModel :
- * 1. PRICE() : Calcule le prix d'une option (Call ou Put)
+ * 1. PRICE() : Calcule le prix d'une option (Call ou Put), mémorisé dans le cache
+ *    PRICE_UNCACHED() : Même calcul sans cache (boucles chaudes)
  * 2. DELTA() : Sensibilité au prix du sous-jacent
  * 3. GAMMA() : Sensibilité du Delta (convexité)
  * 4. VEGA() : Sensibilité à la volatilité
  * 5. THETA() : Décroissance temporelle
  * 6. CALCULATE_ALL_GREEKS() : Tous les Greeks en une fois
+ * 7. PRICE_AND_GREEKS_BATCH() : Prix + Greeks de milliers d'options (SoA, vectorisé)
+ * 8. CALCULATE_EXTENDED_GREEKS() / EXTENDED_GREEKS_BATCH() : + rho, vanna, volga,
+ *    charm, speed, en une passe sur les mêmes intermédiaires
+ * 9. IMPLIED_VOLATILITY_BATCH() / IMPLIED_VOLATILITY() : Prix de marché → vol implicite
  * 
  * OPTIMISATIONS :
- * - Cache des résultats (évite les recalculs)
+ * - Cache borné des résultats (clé POD, éviction CLOCK, sans verrou)
+ * - Noyau static sans état : une instance partagée entre threads sans course de données
  * - Validation robuste des entrées
  * - Gestion d'erreurs avec expected<>
  * - Calcul groupé des Greeks
@@ -393,4 +806,17 @@ public:
  *     auto greeks = model.calculate_all_greeks(100, 105, 0.25, 0.05, 0.20, true);
  *     std::cout << "Delta: " << greeks.delta << std::endl;
  * }
+ * std::cout << "Cache hit rate: " << model.cache_stats().hit_rate() << std::endl;
+ * 
+ * // Par lots : une span par paramètre, une span par résultat
+ * BlackScholesModel::price_and_greeks_batch(spots, strikes, maturities, rates, vols, is_call,
+ *     {.price = prices, .delta = deltas, .gamma = gammas, .vega = vegas, .theta = thetas});
+ * 
+ * // Greeks d'ordre supérieur d'une option (vanna/volga pour le risque de smile)
+ * auto ext = BlackScholesModel::calculate_extended_greeks(100, 105, 0.25, 0.05, 0.20, true);
+ * std::cout << "Vanna: " << ext.vanna << " Volga: " << ext.volga << std::endl;
+ * 
+ * // Chaîne cotée → vols implicites (statut par option)
+ * BlackScholesModel::implied_volatility_batch(spots, strikes, maturities, rates, market_prices,
+ *     is_call, implied_vols, statuses);
  */
\ No newline at end of file
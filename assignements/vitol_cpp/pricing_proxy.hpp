@@ -0,0 +1,376 @@
+/*
+ * pricing_proxy.hpp - Réévaluation par proxy de Chebyshev (échelle de spots)
+ *
+ * Pour une VaR à 1 jour, la valeur de chaque option est une fonction LISSE
+ * du spot choqué, sur une plage étroite (quelques écarts-types autour du
+ * spot). Recalculer Black-Scholes scénarios × positions fois revient à
+ * évaluer 10,000 fois une courbe qu'une quinzaine de points décrivent
+ * à la précision machine près.
+ *
+ * Principe :
+ * - toutes les positions d'un sous-jacent voient le même choc r : leur P&L
+ *   total f_u(r) est une seule fonction lisse de r
+ * - f_u est interpolée sur des nœuds de Chebyshev couvrant EXACTEMENT la
+ *   plage des chocs simulés (pas d'extrapolation)
+ * - chaque scénario est évalué par le polynôme (récurrence de Clenshaw) :
+ *   coût sous-jacents × scénarios × degré, au lieu de positions × scénarios
+ *   appels Black-Scholes
+ */
+
+#pragma once
+
+#include "portfolio_book.hpp"  // CompiledBook, RevaluationInvariants, ScenarioPnLMatrix
+#include "parallel_utils.hpp"  // Ajustement et évaluation sur plusieurs threads
+#include <vector>              // Coefficients, nœuds
+#include <span>                // Chocs et P&L
+#include <array>               // Bandes de scénarios
+#include <algorithm>           // minmax_element, max, fill
+#include <numbers>             // π
+#include <cmath>               // cos, abs
+
+// ===== RAPPORT D'AJUSTEMENT =====
+/*
+ * Erreur mesurée sur des points de contrôle qui ne servent PAS au polynôme
+ * retenu (hold-out) : estimation du pire écart proxy / Black-Scholes sur la
+ * plage des chocs (en $, Σ sur les sous-jacents). Estimation et non borne :
+ * l'écart entre deux points de contrôle n'est pas mesuré
+ */
+struct ProxyFitReport {
+    size_t n_fitted_underlyings{0};  // Sous-jacents évalués par le proxy
+    size_t n_exact_positions{0};     // Positions réévaluées complètement (maturité nulle,
+                                     // sous-jacent dont l'ajustement ne converge pas)
+    size_t pricer_calls{0};          // Prix Black-Scholes pour ajuster les proxys
+    size_t max_degree{0};            // Plus haut degré retenu
+    double holdout_error{0.0};       // Σ_u pire écart aux points de contrôle
+};
+
+// ===== PROXY DE CHEBYSHEV PAR SOUS-JACENT =====
+/*
+ * NŒUDS DE CHEBYSHEV-LOBATTO : t_j = cos(π j / n), j = 0..n, sur [-1, 1]
+ * ramenés à la plage des chocs [r_min, r_max] du sous-jacent.
+ * Les nœuds du degré 2n contiennent ceux du degré n : doubler le degré ne
+ * coûte que n nouveaux prix par position.
+ *
+ * AJUSTEMENT ADAPTATIF (par sous-jacent) :
+ * 1. degré n = MIN_DEGREE : n + 1 prix par position
+ * 2. n nouveaux prix (nœuds intermédiaires du degré 2n), comparés au
+ *    polynôme de degré n → écart maximal e_n sur des points hors ajustement
+ * 3. e_n ≤ tolérance → polynôme de degré n retenu, e_n est SON erreur de
+ *    contrôle ; sinon les 2n + 1 prix forment le degré 2n, contrôlé à son
+ *    tour par les nœuds du degré 4n, jusqu'à MAX_DEGREE ; au-delà le
+ *    sous-jacent est réévalué complètement (jamais d'erreur non contrôlée)
+ *
+ * TOLÉRANCE : au-dessus du bruit du pricer. scenario_pnl utilise
+ * fast_norm_cdf (~1.5e-7 en absolu) : le P&L d'un sous-jacent porte un bruit
+ * non lisse de l'ordre de 1e-7 × Σ|notional| × spot, qu'aucun degré ne suit.
+ * Une tolérance plus fine ne converge jamais (tout part en repli exact).
+ * D'où une tolérance à l'échelle de l'exposition BRUTE (RiskConfig), et non
+ * de la valeur nette : un book couvert, de valeur ≈ 0, a le même bruit.
+ *
+ * Positions de maturité nulle (payoff anguleux en K) : toujours réévaluées
+ * complètement, elles ne dégradent pas le proxy de leur sous-jacent.
+ *
+ * Avec la tolérance par défaut de RiskConfig (1e-6 de l'exposition brute) :
+ * typiquement 17 prix par position (degré 8 retenu, contrôlé par 8 points),
+ * à 1 comme à 10 jours ; au pire 65 avant le repli.
+ */
+class ChebyshevProxy {
+public:
+    static constexpr size_t MIN_DEGREE = 8;
+    static constexpr size_t MAX_DEGREE = 64;
+
+    /*
+     * AJUSTEMENT SUR LES SCÉNARIOS SIMULÉS
+     * ====================================
+     * returns[id × n_scenarios + s] : rendements simulés (simulate_book_returns)
+     * tolerance : écart maximal accepté par sous-jacent, en $
+     */
+    [[nodiscard]] static ChebyshevProxy fit(
+        const CompiledBook& book,
+        const RevaluationInvariants& invariants,
+        std::span<const double> returns,
+        size_t n_scenarios,
+        double tolerance,
+        size_t n_threads = 1) {
+
+        const size_t n_underlyings = book.n_underlyings();
+        ChebyshevProxy proxy;
+        proxy.ladders_.resize(n_underlyings);
+        proxy.exact_positions_.resize(n_underlyings);
+
+        /*
+         * PLAGE DES CHOCS ET POSITIONS À AJUSTER
+         * ======================================
+         */
+        std::vector<std::vector<size_t>> fitted_positions(n_underlyings);
+        for (size_t i = 0; i < book.size(); ++i) {
+            auto& group = book.maturities[i] > 0.0 ? fitted_positions : proxy.exact_positions_;
+            group[book.underlying_ids[i]].push_back(i);
+        }
+        for (size_t id = 0; id < n_underlyings; ++id) {
+            Ladder& ladder = proxy.ladders_[id];
+            if (n_scenarios > 0) {
+                const auto shocks = returns.subspan(id * n_scenarios, n_scenarios);
+                const auto [lo, hi] = std::minmax_element(shocks.begin(), shocks.end());
+                ladder.center = 0.5 * (*hi + *lo);
+                ladder.half_width = std::max(0.5 * (*hi - *lo), MIN_HALF_WIDTH);
+            }
+        }
+
+        /*
+         * DOUBLEMENTS SUCCESSIFS DU DEGRÉ
+         * ===============================
+         * À chaque tour, tous les sous-jacents encore actifs pricent leurs
+         * nouveaux nœuds ; les prix (positions indépendantes) sont répartis
+         * sur les threads, puis sommés par sous-jacent dans l'ordre des positions.
+         */
+        std::vector<std::vector<double>> node_values(n_underlyings);  // Σ P&L aux nœuds du degré courant
+        std::vector<size_t> degree(n_underlyings, 0);
+        std::vector<uint8_t> active(n_underlyings, 0);
+        for (size_t id = 0; id < n_underlyings; ++id) active[id] = !fitted_positions[id].empty();
+
+        while (std::ranges::any_of(active, [](uint8_t a) { return a != 0; })) {
+            // Nouveaux chocs à pricer : tous les nœuds au premier tour, les nœuds impairs ensuite
+            std::vector<std::vector<double>> new_shocks(n_underlyings);
+            for (size_t id = 0; id < n_underlyings; ++id) {
+                if (!active[id]) continue;
+                const Ladder& ladder = proxy.ladders_[id];
+                if (degree[id] == 0) {
+                    for (size_t j = 0; j <= MIN_DEGREE; ++j) {
+                        new_shocks[id].push_back(ladder.shock(lobatto_node(j, MIN_DEGREE)));
+                    }
+                } else {
+                    for (size_t j = 1; j < 2 * degree[id]; j += 2) {
+                        new_shocks[id].push_back(ladder.shock(lobatto_node(j, 2 * degree[id])));
+                    }
+                }
+            }
+
+            // P&L de chaque position aux nouveaux chocs (une ligne par position)
+            std::vector<size_t> jobs, offsets{0};
+            for (size_t id = 0; id < n_underlyings; ++id) {
+                if (!active[id]) continue;
+                for (size_t i : fitted_positions[id]) {
+                    jobs.push_back(i);
+                    offsets.push_back(offsets.back() + new_shocks[id].size());
+                }
+            }
+            std::vector<double> position_pnl(offsets.back());
+            parallel::for_each_block(jobs.size(), JOBS_PER_BLOCK, n_threads,
+                [&](size_t, size_t begin, size_t end) {
+                for (size_t job = begin; job < end; ++job) {
+                    const size_t i = jobs[job];
+                    invariants.scenario_pnl(book, i, new_shocks[book.underlying_ids[i]],
+                        std::span<double>(position_pnl).subspan(offsets[job], offsets[job + 1] - offsets[job]));
+                }
+            });
+            proxy.report_.pricer_calls += position_pnl.size();
+
+            // Somme par sous-jacent, contrôle et décision
+            size_t job = 0;
+            for (size_t id = 0; id < n_underlyings; ++id) {
+                if (!active[id]) continue;
+                std::vector<double> values(new_shocks[id].size(), 0.0);
+                for (size_t count = 0; count < fitted_positions[id].size(); ++count, ++job) {
+                    for (size_t j = 0; j < values.size(); ++j) values[j] += position_pnl[offsets[job] + j];
+                }
+
+                if (degree[id] == 0) {
+                    node_values[id] = std::move(values);
+                    degree[id] = MIN_DEGREE;
+                    continue;
+                }
+
+                const size_t n = degree[id];
+                auto coarse = coefficients(node_values[id]);
+                double error = 0.0;
+                for (size_t j = 0; j < n; ++j) {
+                    const double t = lobatto_node(2 * j + 1, 2 * n);
+                    error = std::max(error, std::abs(clenshaw(coarse, t) - values[j]));
+                }
+
+                // Nœuds du degré 2n : anciens aux rangs pairs, nouveaux aux rangs impairs
+                std::vector<double> merged(2 * n + 1);
+                for (size_t j = 0; j <= n; ++j) merged[2 * j] = node_values[id][j];
+                for (size_t j = 0; j < n; ++j) merged[2 * j + 1] = values[j];
+
+                Ladder& ladder = proxy.ladders_[id];
+                if (error <= tolerance) {
+                    // Degré n : les points de contrôle n'ont pas servi à l'ajustement
+                    ladder.coefficients = std::move(coarse);
+                    ladder.fit_error = error;
+                    active[id] = 0;
+                } else if (2 * n >= MAX_DEGREE) {
+                    // Pas de convergence : réévaluation complète de tout le sous-jacent
+                    auto& exact = proxy.exact_positions_[id];
+                    exact.insert(exact.end(), fitted_positions[id].begin(), fitted_positions[id].end());
+                    std::ranges::sort(exact);
+                    active[id] = 0;
+                } else {
+                    node_values[id] = std::move(merged);
+                    degree[id] = 2 * n;
+                }
+            }
+        }
+
+        for (const Ladder& ladder : proxy.ladders_) {
+            if (ladder.coefficients.empty()) continue;
+            ++proxy.report_.n_fitted_underlyings;
+            proxy.report_.max_degree = std::max(proxy.report_.max_degree, ladder.coefficients.size() - 1);
+            proxy.report_.holdout_error += ladder.fit_error;
+        }
+        for (const auto& exact : proxy.exact_positions_) proxy.report_.n_exact_positions += exact.size();
+        return proxy;
+    }
+
+    /*
+     * P&L DES SCÉNARIOS PAR LE PROXY
+     * ==============================
+     * portfolio_pnl[s] += Σ_u (f_u(r_u,s) + P&L exact des positions hors proxy de u)
+     * Blocs de scénarios en parallèle, sous-jacents toujours sommés dans le
+     * même ordre → résultat indépendant du nombre de threads.
+     * underlying_pnl (optionnel) reçoit la ligne de P&L de chaque sous-jacent.
+     */
+    void revalue(const CompiledBook& book,
+                 const RevaluationInvariants& invariants,
+                 std::span<const double> returns,
+                 size_t n_scenarios,
+                 std::span<double> portfolio_pnl,
+                 ScenarioPnLMatrix* underlying_pnl = nullptr,
+                 size_t n_threads = 1) const {
+
+        parallel::for_each_block(n_scenarios, SCENARIOS_PER_BLOCK, n_threads,
+            [&](size_t, size_t begin, size_t end) {
+            const size_t n_strip = end - begin;
+            std::array<double, SCENARIOS_PER_BLOCK> strip, exact_strip;
+            const std::span<double> pnl(strip.data(), n_strip);
+            const std::span<double> exact_pnl(exact_strip.data(), n_strip);
+
+            for (size_t id = 0; id < ladders_.size(); ++id) {
+                const auto shocks = returns.subspan(id * n_scenarios + begin, n_strip);
+                if (ladders_[id].coefficients.empty()) {
+                    std::ranges::fill(pnl, 0.0);
+                } else {
+                    ladders_[id].evaluate(shocks, pnl);
+                }
+                for (size_t i : exact_positions_[id]) {
+                    invariants.scenario_pnl(book, i, shocks, exact_pnl);
+                    for (size_t k = 0; k < n_strip; ++k) pnl[k] += exact_pnl[k];
+                }
+
+                for (size_t k = 0; k < n_strip; ++k) portfolio_pnl[begin + k] += pnl[k];
+                if (underlying_pnl) std::ranges::copy(pnl, underlying_pnl->row(id).begin() + begin);
+            }
+        });
+    }
+
+    [[nodiscard]] const ProxyFitReport& report() const noexcept { return report_; }
+
+private:
+    static constexpr size_t SCENARIOS_PER_BLOCK = 4096;
+    static constexpr size_t JOBS_PER_BLOCK = 64;
+    static constexpr size_t EVAL_CHUNK = 256;           // Scénarios par passe de Clenshaw
+    static constexpr double MIN_HALF_WIDTH = 1e-12;     // Plage dégénérée (un seul scénario)
+
+    /*
+     * ÉCHELLE D'UN SOUS-JACENT : f_u(r) = Σ_k c_k T_k(t), t = (r - center) / half_width
+     * coefficients vide = sous-jacent hors proxy
+     */
+    struct Ladder {
+        double center{0.0};
+        double half_width{MIN_HALF_WIDTH};
+        std::vector<double> coefficients;
+        double fit_error{0.0};
+
+        [[nodiscard]] double shock(double t) const noexcept { return center + half_width * t; }
+
+        /*
+         * Clenshaw sur une bande de scénarios : boucle sur les coefficients à
+         * l'extérieur, sur les scénarios à l'intérieur → vectorisée
+         */
+        void evaluate(std::span<const double> shocks, std::span<double> pnl) const noexcept {
+            const size_t degree = coefficients.size() - 1;
+            const double inv_half_width = 1.0 / half_width;
+            std::array<double, EVAL_CHUNK> t, b1, b2;
+
+            for (size_t begin = 0; begin < shocks.size(); begin += EVAL_CHUNK) {
+                const size_t n = std::min(EVAL_CHUNK, shocks.size() - begin);
+                for (size_t s = 0; s < n; ++s) {
+                    t[s] = (shocks[begin + s] - center) * inv_half_width;
+                    b1[s] = 0.0;
+                    b2[s] = 0.0;
+                }
+                for (size_t k = degree; k >= 1; --k) {
+                    const double c = coefficients[k];
+                    for (size_t s = 0; s < n; ++s) {
+                        const double b0 = 2.0 * t[s] * b1[s] - b2[s] + c;
+                        b2[s] = b1[s];
+                        b1[s] = b0;
+                    }
+                }
+                for (size_t s = 0; s < n; ++s) {
+                    pnl[begin + s] = t[s] * b1[s] - b2[s] + coefficients[0];
+                }
+            }
+        }
+    };
+
+    std::vector<Ladder> ladders_;                       // Par sous-jacent
+    std::vector<std::vector<size_t>> exact_positions_;  // Par sous-jacent, positions hors proxy
+    ProxyFitReport report_;
+
+    [[nodiscard]] static double lobatto_node(size_t j, size_t n) noexcept {
+        return std::cos(std::numbers::pi * static_cast<double>(j) / static_cast<double>(n));
+    }
+
+    /*
+     * COEFFICIENTS DE CHEBYSHEV (DCT-I) à partir des n + 1 valeurs aux nœuds t_j
+     * c_k = (2/n) Σ''_j f_j cos(π j k / n), premier et dernier termes pondérés ½
+     * (c_0 et c_n également divisés par 2)
+     */
+    [[nodiscard]] static std::vector<double> coefficients(std::span<const double> values) {
+        const size_t n = values.size() - 1;
+        std::vector<double> c(n + 1);
+        for (size_t k = 0; k <= n; ++k) {
+            double sum = 0.5 * (values[0] + (k % 2 == 0 ? values[n] : -values[n]));
+            for (size_t j = 1; j < n; ++j) {
+                sum += values[j] * std::cos(std::numbers::pi * static_cast<double>(j * k) / static_cast<double>(n));
+            }
+            c[k] = 2.0 / static_cast<double>(n) * sum;
+        }
+        c[0] *= 0.5;
+        c[n] *= 0.5;
+        return c;
+    }
+
+    [[nodiscard]] static double clenshaw(std::span<const double> c, double t) noexcept {
+        double b1 = 0.0, b2 = 0.0;
+        for (size_t k = c.size() - 1; k >= 1; --k) {
+            const double b0 = 2.0 * t * b1 - b2 + c[k];
+            b2 = b1;
+            b1 = b0;
+        }
+        return t * b1 - b2 + c[0];
+    }
+};
+
+/*
+ * RÉSUMÉ DE CE FICHIER :
+ * ======================
+ *
+ * 1. ProxyFitReport : sous-jacents ajustés, positions exactes, prix utilisés,
+ *    degré maximal, erreur aux points de contrôle (hold-out)
+ * 2. ChebyshevProxy::fit : un polynôme de Chebyshev par sous-jacent sur la
+ *    plage des chocs simulés, degré doublé jusqu'à la tolérance (ou repli
+ *    en réévaluation complète)
+ * 3. ChebyshevProxy::revalue : P&L de tous les scénarios par Clenshaw
+ *    (vectorisé), positions hors proxy réévaluées exactement
+ *
+ * COÛT (1,000 positions, 3 sous-jacents, 10,000 scénarios) :
+ * - Réévaluation complète : 10,000,000 prix Black-Scholes
+ * - Proxy : ~17,000 prix + 3 × 10,000 évaluations d'un polynôme de degré 8
+ *
+ * USAGE TYPIQUE :
+ * const auto proxy = ChebyshevProxy::fit(book, invariants, returns, n_scenarios, 1.0);  // 1$ max
+ * proxy.revalue(book, invariants, returns, n_scenarios, portfolio_pnl);
+ */
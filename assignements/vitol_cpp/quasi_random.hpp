@@ -0,0 +1,301 @@
+/*
+ * quasi_random.hpp - Séquences quasi-aléatoires (Sobol) et pont brownien
+ *
+ * Le Monte Carlo classique tire des points "au hasard" : ils forment des
+ * grappes et laissent des trous, d'où une erreur en O(1/√N).
+ * Une séquence de Sobol place les points de façon à remplir l'espace
+ * le plus régulièrement possible → erreur proche de O(1/N) pour des
+ * payoffs réguliers (européennes, asiatiques).
+ *
+ * EN PRATIQUE : pour la même précision, 10 à 100 fois moins de trajectoires.
+ *
+ * Deux ingrédients :
+ * 1. SobolSequence : points de [0,1)^d (nombres directeurs de Joe & Kuo)
+ *    brouillés par un décalage digital aléatoire (tiré d'un flux Philox)
+ * 2. BrownianBridge : construit la trajectoire "du grossier au fin"
+ *    (W(T) d'abord, puis W(T/2), W(T/4), W(3T/4)...) pour que les
+ *    premières dimensions, les meilleures de Sobol, portent l'essentiel
+ *    de la variance
+ *
+ * Références : Joe & Kuo, "Constructing Sobol sequences with better
+ * two-dimensional projections" (2008) ; Glasserman, "Monte Carlo Methods
+ * in Financial Engineering", §5.2 et §3.1
+ */
+
+#pragma once
+
+#include "random_streams.hpp"  // Pour le brouillage (décalage digital tiré d'un flux Philox)
+#include <algorithm>   // Pour std::min, std::max
+#include <array>       // Pour les nombres directeurs
+#include <bit>         // Pour std::countr_zero (code de Gray)
+#include <cmath>       // Pour sqrt
+#include <cstdint>     // Pour uint32_t, uint64_t
+#include <span>        // Pour les points et trajectoires
+#include <vector>      // Pour les tables par dimension
+
+// ===== SÉQUENCE DE SOBOL BROUILLÉE =====
+/*
+ * Point n de la séquence, dimension d (en entiers de 32 bits) :
+ *     x_n[d] = XOR des v_d[k] pour chaque bit k à 1 de gray(n) = n ^ (n >> 1)
+ * Deux points consécutifs ne diffèrent que d'un seul v_d[k] (code de Gray) :
+ *     x_{n+1}[d] = x_n[d] ^ v_d[countr_zero(n + 1)]
+ * → un XOR par dimension et par point, et saut direct à n'importe quel n
+ *   (chaque bloc de threads démarre à son propre indice).
+ */
+class SobolSequence {
+public:
+    static constexpr size_t MAX_DIMENSION = 32;  // Dimensions avec nombres directeurs tabulés
+    static constexpr unsigned BITS = 32;         // Précision : 2^32 points maximum
+
+private:
+    using DirectionNumbers = std::array<uint32_t, BITS>;
+
+    /*
+     * TABLE DE JOE & KUO (new-joe-kuo-6.21201), DIMENSIONS 2 À 32
+     * ===========================================================
+     * s = degré du polynôme primitif, a = ses coefficients intérieurs,
+     * m = nombres directeurs initiaux (impairs, m_k < 2^k)
+     * La dimension 1 est la suite de van der Corput (v_k = 2^(32-k))
+     */
+    struct PrimitivePolynomial {
+        unsigned s;
+        uint32_t a;
+        std::array<uint32_t, 7> m;
+    };
+
+    static constexpr std::array<PrimitivePolynomial, MAX_DIMENSION - 1> JOE_KUO = {{
+        {1,  0, {1}},
+        {2,  1, {1, 3}},
+        {3,  1, {1, 3, 1}},
+        {3,  2, {1, 1, 1}},
+        {4,  1, {1, 1, 3, 3}},
+        {4,  4, {1, 3, 5, 13}},
+        {5,  2, {1, 1, 5, 5, 17}},
+        {5,  4, {1, 1, 5, 5, 5}},
+        {5,  7, {1, 1, 7, 11, 19}},
+        {5, 11, {1, 1, 5, 1, 1}},
+        {5, 13, {1, 1, 1, 3, 11}},
+        {5, 14, {1, 3, 5, 5, 31}},
+        {6,  1, {1, 3, 3, 9, 7, 49}},
+        {6, 13, {1, 1, 1, 15, 21, 21}},
+        {6, 16, {1, 3, 1, 13, 27, 49}},
+        {6, 19, {1, 1, 1, 15, 7, 5}},
+        {6, 22, {1, 3, 1, 15, 13, 25}},
+        {6, 25, {1, 1, 5, 5, 19, 61}},
+        {7,  1, {1, 3, 7, 11, 23, 15, 103}},
+        {7,  4, {1, 3, 7, 13, 13, 15, 69}},
+        {7,  7, {1, 1, 3, 13, 7, 35, 63}},
+        {7,  8, {1, 3, 5, 9, 1, 25, 53}},
+        {7, 14, {1, 3, 1, 13, 9, 35, 107}},
+        {7, 19, {1, 3, 1, 5, 27, 61, 31}},
+        {7, 21, {1, 1, 5, 11, 19, 41, 61}},
+        {7, 28, {1, 3, 5, 3, 3, 13, 69}},
+        {7, 31, {1, 1, 7, 13, 1, 19, 1}},
+        {7, 32, {1, 3, 7, 5, 13, 19, 59}},
+        {7, 37, {1, 1, 3, 9, 25, 29, 41}},
+        {7, 41, {1, 3, 5, 13, 23, 1, 55}},
+        {7, 42, {1, 3, 7, 3, 13, 59, 17}},
+    }};
+
+    std::vector<DirectionNumbers> directions_;  // v_d[k] pour chaque dimension
+    std::vector<uint32_t> shift_;               // Décalage digital par dimension (0 = non brouillé)
+
+    /*
+     * NOMBRES DIRECTEURS D'UNE DIMENSION
+     * ==================================
+     * v_k = m_k × 2^(32-k) pour k ≤ s, puis récurrence de Bratley & Fox :
+     * v_k = v_{k-s} ^ (v_{k-s} >> s) ^ XOR_{j<s} (a_j × v_{k-j})
+     */
+    [[nodiscard]] static DirectionNumbers make_directions(size_t dim) noexcept {
+        DirectionNumbers v{};
+        if (dim == 0) {
+            for (unsigned k = 0; k < BITS; ++k) v[k] = uint32_t{1} << (BITS - 1 - k);
+            return v;
+        }
+
+        const auto& poly = JOE_KUO[dim - 1];
+        for (unsigned k = 0; k < poly.s; ++k) {
+            v[k] = poly.m[k] << (BITS - 1 - k);
+        }
+        for (unsigned k = poly.s; k < BITS; ++k) {
+            v[k] = v[k - poly.s] ^ (v[k - poly.s] >> poly.s);
+            for (unsigned j = 1; j < poly.s; ++j) {
+                if ((poly.a >> (poly.s - 1 - j)) & 1) v[k] ^= v[k - j];
+            }
+        }
+        return v;
+    }
+
+public:
+    /*
+     * CONSTRUCTEURS
+     * =============
+     * dimension est limitée à MAX_DIMENSION : au-delà, l'appelant complète
+     * avec des tirages pseudo-aléatoires (QMC "hybride", cf. simulate_qmc_paths)
+     * Avec un flux : chaque dimension est brouillée par un XOR aléatoire
+     * → estimateur sans biais, et des flux différents donnent des
+     *   réplications indépendantes (pour estimer l'erreur QMC)
+     */
+    explicit SobolSequence(size_t dimension)
+        : directions_(std::min(std::max<size_t>(dimension, 1), MAX_DIMENSION)),
+          shift_(directions_.size(), 0) {
+        for (size_t d = 0; d < directions_.size(); ++d) {
+            directions_[d] = make_directions(d);
+        }
+    }
+
+    SobolSequence(size_t dimension, const RandomStream& scramble)
+        : SobolSequence(dimension) {
+        for (size_t d = 0; d < shift_.size(); ++d) {
+            shift_[d] = scramble.raw_block(d, SCRAMBLE_PAIR)[0];
+        }
+    }
+
+    /*
+     * Adresse Philox réservée au brouillage : (dimension, SCRAMBLE_PAIR)
+     * Aucune trajectoire n'atteint cette paire de pas → pas de recouvrement
+     */
+    static constexpr uint64_t SCRAMBLE_PAIR = 0xFFFF'FFFFull;
+
+    [[nodiscard]] size_t dimension() const noexcept { return directions_.size(); }
+
+    /*
+     * POINT n CALCULÉ DIRECTEMENT
+     * ===========================
+     * out[d] = bits du point n (brouillé), out.size() == dimension()
+     * Coût : un XOR par bit à 1 de gray(n) → O(log n) par dimension
+     */
+    void point_bits(uint64_t index, std::span<uint32_t> out) const noexcept {
+        const uint64_t gray = index ^ (index >> 1);
+        for (size_t d = 0; d < directions_.size(); ++d) {
+            uint32_t x = shift_[d];
+            for (uint64_t g = gray; g != 0; g &= g - 1) {
+                x ^= directions_[d][std::countr_zero(g)];
+            }
+            out[d] = x;
+        }
+    }
+
+    /*
+     * PASSAGE DU POINT n-1 AU POINT n (CODE DE GRAY)
+     * ==============================================
+     * state contient le point index-1 ; il devient le point index
+     */
+    void advance(std::span<uint32_t> state, uint64_t index) const noexcept {
+        const auto bit = std::countr_zero(index);
+        for (size_t d = 0; d < directions_.size(); ++d) {
+            state[d] ^= directions_[d][bit];
+        }
+    }
+
+    /*
+     * BITS → UNIFORME DANS (0, 1)
+     * ===========================
+     * Milieu de la cellule de largeur 2^-32 : jamais 0 ni 1,
+     * donc norm_inv reste toujours fini
+     */
+    [[nodiscard]] static constexpr double to_uniform(uint32_t bits) noexcept {
+        return (static_cast<double>(bits) + 0.5) * 0x1.0p-32;
+    }
+};
+
+// ===== PONT BROWNIEN =====
+/*
+ * Construit W_1..W_N (mouvement brownien sur une grille de pas unité)
+ * à partir de N normales z, dans l'ordre :
+ *     z[0] → W_N (le point final)
+ *     z[1] → W_{N/2} sachant W_0 et W_N
+ *     z[2], z[3] → W_{N/4}, W_{3N/4} ...
+ * Chaque point est tiré conditionnellement à ses deux voisins connus :
+ *     W_l = wL × W_gauche + wR × W_droite + σ × z
+ *
+ * La loi des trajectoires est EXACTEMENT la même qu'avec des incréments
+ * successifs : seul l'ordre d'utilisation des dimensions change.
+ * N quelconque (pas seulement une puissance de 2).
+ */
+class BrownianBridge {
+private:
+    struct Node {
+        size_t target;        // Indice construit (1..N)
+        size_t left;          // Voisin gauche connu (0 = W_0 = 0)
+        size_t right;         // Voisin droit connu
+        double left_weight;
+        double right_weight;
+        double std_dev;       // Écart-type conditionnel (en unités de √dt)
+    };
+
+    std::vector<Node> nodes_;  // nodes_[i] consomme z[i]
+
+public:
+    explicit BrownianBridge(size_t n_steps) {
+        if (n_steps == 0) return;
+        nodes_.reserve(n_steps);
+
+        // Premier nœud : le point final, sans voisin droit
+        nodes_.push_back({n_steps, 0, 0, 0.0, 0.0, std::sqrt(static_cast<double>(n_steps))});
+
+        /*
+         * PARCOURS NIVEAU PAR NIVEAU
+         * ==========================
+         * On balaie la grille de gauche à droite : pour chaque plage de
+         * points inconnus [j, k-1] entre deux points connus (j-1 et k),
+         * on construit son milieu, puis on passe à la plage suivante.
+         */
+        std::vector<bool> known(n_steps + 1, false);
+        known[0] = known[n_steps] = true;
+
+        size_t j = 1;
+        for (size_t i = 1; i < n_steps; ++i) {
+            while (known[j]) j = (j % n_steps) + 1;  // Premier point inconnu (on reboucle en fin de grille)
+            size_t k = j;
+            while (!known[k]) ++k;                   // Prochain point connu
+
+            const size_t l = j + (k - 1 - j) / 2;    // Milieu de la plage
+            known[l] = true;
+
+            const double span_total = static_cast<double>(k - (j - 1));
+            const double span_left = static_cast<double>(l - (j - 1));
+            const double span_right = static_cast<double>(k - l);
+            nodes_.push_back({l, j - 1, k,
+                              span_right / span_total,
+                              span_left / span_total,
+                              std::sqrt(span_left * span_right / span_total)});
+
+            j = k + 1;
+            if (j > n_steps) j = 1;
+        }
+    }
+
+    [[nodiscard]] size_t size() const noexcept { return nodes_.size(); }
+
+    /*
+     * CONSTRUCTION D'UNE TRAJECTOIRE
+     * ==============================
+     * z : N normales (z[0] la plus importante)
+     * w : N positions W_1..W_N (w[s-1] = W_s), en unités de √dt
+     */
+    void build(std::span<const double> z, std::span<double> w) const noexcept {
+        auto at = [&](size_t idx) { return idx == 0 ? 0.0 : w[idx - 1]; };
+
+        for (size_t i = 0; i < nodes_.size(); ++i) {
+            const Node& node = nodes_[i];
+            w[node.target - 1] = node.left_weight * at(node.left)
+                               + node.right_weight * at(node.right)
+                               + node.std_dev * z[i];
+        }
+    }
+};
+
+/*
+ * USAGE TYPIQUE :
+ * SobolSequence sobol(4, RandomStream(123, 0));   // 4 dimensions, brouillée
+ * BrownianBridge bridge(4);
+ * std::array<uint32_t, 4> bits;
+ * std::array<double, 4> z, w;
+ * sobol.point_bits(0, bits);
+ * for (uint64_t n = 0; n < 1024; ++n) {
+ *     if (n > 0) sobol.advance(bits, n);
+ *     for (size_t d = 0; d < 4; ++d) z[d] = FastMath::norm_inv(SobolSequence::to_uniform(bits[d]));
+ *     bridge.build(z, w);   // w = W_1..W_4 de la trajectoire n
+ * }
+ */
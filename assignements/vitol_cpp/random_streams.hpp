@@ -0,0 +1,262 @@
+/*
+ * random_streams.hpp - Générateurs aléatoires "counter-based" (Philox4x32-10)
+ *
+ * Un générateur classique (Mersenne Twister) est une machine à états :
+ * pour obtenir le 1 000 000e nombre, il faut d'abord tirer les 999 999 premiers.
+ *
+ * Un générateur "counter-based" est une FONCTION PURE :
+ *     nombre = Philox(compteur, clé)
+ * On peut donc calculer directement le choc de la trajectoire n°742 315 au
+ * pas de temps n°17, sans rien tirer d'autre. C'est ce qui permet :
+ * - de rejouer une seule trajectoire (ex: le pire scénario d'un calcul de VaR)
+ * - de répartir les trajectoires entre threads/machines sans coordination
+ * - d'avoir un état minuscule (une clé de 64 bits au lieu de 2.5KB)
+ *
+ * Référence : Salmon et al., "Parallel Random Numbers: As Easy as 1, 2, 3" (SC11)
+ */
+
+#pragma once
+
+#include "math_utils.hpp"  // Pour FastMath::fast_log, fast_sincos_2pi
+#include <array>       // Pour les blocs compteur/clé/sortie
+#include <cstdint>     // Pour uint32_t, uint64_t
+#include <cmath>       // Pour sqrt
+#include <span>        // Pour les remplissages en bloc
+#include <algorithm>   // Pour std::min
+#include <bit>         // Pour std::bit_cast
+
+// ===== PHILOX 4x32-10 =====
+/*
+ * Transforme un compteur de 128 bits en 128 bits pseudo-aléatoires,
+ * paramétré par une clé de 64 bits. 10 tours de multiplications 32×32→64.
+ */
+class Philox4x32 {
+public:
+    using Counter = std::array<uint32_t, 4>;
+    using Key = std::array<uint32_t, 2>;
+
+private:
+    // Constantes de l'algorithme (multiplicateurs et "nombre d'or" pour la clé)
+    static constexpr uint32_t M0 = 0xD2511F53u;
+    static constexpr uint32_t M1 = 0xCD9E8D57u;
+    static constexpr uint32_t W0 = 0x9E3779B9u;
+    static constexpr uint32_t W1 = 0xBB67AE85u;
+
+    static constexpr void round(Counter& ctr, const Key& key) noexcept {
+        const uint64_t p0 = static_cast<uint64_t>(M0) * ctr[0];
+        const uint64_t p1 = static_cast<uint64_t>(M1) * ctr[2];
+        ctr = {
+            static_cast<uint32_t>(p1 >> 32) ^ ctr[1] ^ key[0],
+            static_cast<uint32_t>(p1),
+            static_cast<uint32_t>(p0 >> 32) ^ ctr[3] ^ key[1],
+            static_cast<uint32_t>(p0)
+        };
+    }
+
+public:
+    [[nodiscard]] static constexpr Counter generate(Counter ctr, Key key) noexcept {
+        for (int r = 0; r < 10; ++r) {
+            if (r > 0) {
+                key[0] += W0;  // "Key schedule" : la clé change à chaque tour
+                key[1] += W1;
+            }
+            round(ctr, key);
+        }
+        return ctr;
+    }
+};
+
+// ===== FLUX ALÉATOIRE ADRESSABLE =====
+/*
+ * Un RandomStream = (graine, identifiant de flux).
+ * Chaque variable aléatoire est adressée par (trajectoire, pas de temps) :
+ *
+ *     Z = stream.normal(path_idx, step)
+ *
+ * Même graine + même flux + même adresse → même nombre, toujours,
+ * quel que soit l'ordre ou le thread dans lequel on le demande.
+ */
+class RandomStream {
+private:
+    Philox4x32::Key key_;
+    uint32_t stream_id_;
+
+    /*
+     * SPLITMIX64 : MÉLANGE DE LA GRAINE
+     * =================================
+     * Des graines voisines (123, 124) donnent des clés sans rapport
+     */
+    [[nodiscard]] static constexpr uint64_t splitmix64(uint64_t x) noexcept {
+        x += 0x9E3779B97F4A7C15ull;
+        x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ull;
+        x = (x ^ (x >> 27)) * 0x94D049BB133111EBull;
+        return x ^ (x >> 31);
+    }
+
+public:
+    constexpr RandomStream(uint64_t seed, uint64_t stream_id) noexcept
+        : key_{}, stream_id_(static_cast<uint32_t>(stream_id)) {
+        const uint64_t mixed = splitmix64(seed);
+        key_ = {static_cast<uint32_t>(mixed), static_cast<uint32_t>(mixed >> 32)};
+    }
+
+    /*
+     * BLOC BRUT DE 128 BITS
+     * =====================
+     * Compteur = (paire de pas, flux, trajectoire[bas], trajectoire[haut])
+     * Un appel Philox fournit 2 normales → pas 2k et 2k+1 partagent le bloc
+     */
+    [[nodiscard]] constexpr Philox4x32::Counter raw_block(uint64_t path_idx, uint64_t step_pair) const noexcept {
+        return Philox4x32::generate(
+            {static_cast<uint32_t>(step_pair), stream_id_,
+             static_cast<uint32_t>(path_idx), static_cast<uint32_t>(path_idx >> 32)},
+            key_);
+    }
+
+    /*
+     * CONVERSION BITS → UNIFORMES
+     * ===========================
+     * 52 bits de poids fort placés dans la mantisse de 1.0 → double dans [1, 2)
+     * (que des opérations sur les bits : vectorisable, contrairement à uint64 → double)
+     * - open_zero : (0, 1]  (pour log(u), jamais log(0))
+     * - sinon     : [0, 1)
+     */
+    [[nodiscard]] static constexpr double to_unit_interval_1_2(uint32_t hi, uint32_t lo) noexcept {
+        const uint64_t bits = ((static_cast<uint64_t>(hi) << 32) | lo) >> 12;
+        return std::bit_cast<double>(bits | 0x3FF0000000000000ull);
+    }
+    [[nodiscard]] static constexpr double to_uniform_open_zero(uint32_t hi, uint32_t lo) noexcept {
+        return 2.0 - to_unit_interval_1_2(hi, lo);
+    }
+    [[nodiscard]] static constexpr double to_uniform(uint32_t hi, uint32_t lo) noexcept {
+        return to_unit_interval_1_2(hi, lo) - 1.0;
+    }
+    
+private:
+    /*
+     * NOYAU DE GÉNÉRATION EN BLOC
+     * ===========================
+     * Deux boucles simples sur des tableaux contigus, sans branchement :
+     * 1. Philox → deux uniformes par paire
+     * 2. Box-Muller avec FastMath::fast_log / fast_sincos_2pi
+     * Le compilateur vectorise chaque boucle (AVX2/AVX-512 avec -march=native,
+     * SSE2 ou scalaire sinon) : pas d'intrinsics, donc pas de #ifdef par CPU.
+     */
+    static constexpr size_t CHUNK_PAIRS = 64;  // Tableaux de travail sur la pile (4 × 512 octets)
+    
+    struct NormalPairs {
+        double z_cos[CHUNK_PAIRS];  // √(-2 ln U1) × cos(2π U2) → pas pairs
+        double z_sin[CHUNK_PAIRS];  // √(-2 ln U1) × sin(2π U2) → pas impairs
+    };
+    
+    static void box_muller(const double* u1, const double* u2, NormalPairs& out, size_t n_pairs) noexcept {
+        for (size_t p = 0; p < n_pairs; ++p) {
+            const double radius = std::sqrt(-2.0 * FastMath::fast_log(u1[p]));
+            double sin_a, cos_a;
+            FastMath::fast_sincos_2pi(u2[p], sin_a, cos_a);
+            out.z_cos[p] = radius * cos_a;
+            out.z_sin[p] = radius * sin_a;
+        }
+    }
+    
+    // Paires consécutives (path_idx, first_pair + p) — le long d'une trajectoire
+    void pairs_along_path(uint64_t path_idx, uint64_t first_pair, NormalPairs& out, size_t n_pairs) const noexcept {
+        double u1[CHUNK_PAIRS], u2[CHUNK_PAIRS];
+        for (size_t p = 0; p < n_pairs; ++p) {
+            const auto block = raw_block(path_idx, first_pair + p);
+            u1[p] = to_uniform_open_zero(block[0], block[1]);
+            u2[p] = to_uniform(block[2], block[3]);
+        }
+        box_muller(u1, u2, out, n_pairs);
+    }
+    
+    // Même paire pour des trajectoires consécutives (first_path + p, pair) — en travers
+    void pairs_across_paths(uint64_t first_path, uint64_t pair, NormalPairs& out, size_t n_pairs) const noexcept {
+        double u1[CHUNK_PAIRS], u2[CHUNK_PAIRS];
+        for (size_t p = 0; p < n_pairs; ++p) {
+            const auto block = raw_block(first_path + p, pair);
+            u1[p] = to_uniform_open_zero(block[0], block[1]);
+            u2[p] = to_uniform(block[2], block[3]);
+        }
+        box_muller(u1, u2, out, n_pairs);
+    }
+    
+public:
+    /*
+     * REMPLISSAGE EN BLOC LE LONG D'UNE TRAJECTOIRE
+     * =============================================
+     * out[k] = normal(path_idx, first_step + k)
+     * Usage : tous les chocs d'une trajectoire GBM d'un coup
+     */
+    void fill_normals_along_path(std::span<double> out, uint64_t path_idx, uint64_t first_step) const noexcept {
+        NormalPairs pairs;
+        size_t produced = 0;
+        uint64_t step = first_step;
+        
+        while (produced < out.size()) {
+            const size_t skip = static_cast<size_t>(step & 1);  // Démarrage sur un pas impair
+            const size_t n_pairs = std::min(CHUNK_PAIRS, (skip + (out.size() - produced) + 1) / 2);
+            pairs_along_path(path_idx, step >> 1, pairs, n_pairs);
+            
+            // Entrelacement : pas pair ← cos, pas impair ← sin
+            for (size_t k = skip; k < 2 * n_pairs && produced < out.size(); ++k) {
+                out[produced++] = (k & 1) ? pairs.z_sin[k >> 1] : pairs.z_cos[k >> 1];
+            }
+            step = ((step >> 1) + n_pairs) << 1;
+        }
+    }
+    
+    /*
+     * REMPLISSAGE EN BLOC EN TRAVERS DES TRAJECTOIRES
+     * ===============================================
+     * out[i] = normal(first_path + i, step)
+     * Usage : un seul choc par trajectoire (rendements 1 jour, prix finaux)
+     */
+    void fill_normals_across_paths(std::span<double> out, uint64_t first_path, uint64_t step) const noexcept {
+        NormalPairs pairs;
+        const bool odd_step = (step & 1) != 0;
+        
+        for (size_t done = 0; done < out.size(); ) {
+            const size_t n = std::min(CHUNK_PAIRS, out.size() - done);
+            pairs_across_paths(first_path + done, step >> 1, pairs, n);
+            const double* z = odd_step ? pairs.z_sin : pairs.z_cos;
+            std::copy(z, z + n, out.begin() + done);
+            done += n;
+        }
+    }
+    
+    /*
+     * VARIABLE NORMALE N(0,1) À UNE ADRESSE DONNÉE
+     * ============================================
+     * Box-Muller sur les deux uniformes du bloc :
+     *   Z0 = √(-2 ln U1) × cos(2π U2)   → pas pair
+     *   Z1 = √(-2 ln U1) × sin(2π U2)   → pas impair
+     * Passe par le même noyau que les remplissages en bloc → valeurs identiques
+     */
+    [[nodiscard]] double normal(uint64_t path_idx, uint64_t step) const noexcept {
+        double z;
+        fill_normals_along_path(std::span<double>(&z, 1), path_idx, step);
+        return z;
+    }
+
+    /*
+     * VARIABLE UNIFORME [0,1) À UNE ADRESSE DONNÉE
+     * ============================================
+     */
+    [[nodiscard]] constexpr double uniform(uint64_t path_idx, uint64_t step) const noexcept {
+        const auto block = raw_block(path_idx, step >> 1);
+        return (step & 1) ? to_uniform(block[2], block[3]) : to_uniform(block[0], block[1]);
+    }
+
+    [[nodiscard]] constexpr uint32_t stream_id() const noexcept { return stream_id_; }
+};
+
+/*
+ * USAGE TYPIQUE :
+ * RandomStream stream(123, 0);           // graine 123, flux 0
+ * double z = stream.normal(742315, 17);  // choc de la trajectoire 742315 au pas 17
+ * // → même valeur à chaque appel, sur n'importe quel thread
+ *
+ * std::vector<double> shocks(252);
+ * stream.fill_normals_along_path(shocks, 742315, 0);  // les 252 chocs d'un coup
+ */
@@ -0,0 +1,197 @@
+/*
+ * risk_attribution.hpp - Décomposition de la VaR/ES par position ou sous-jacent
+ *
+ * La VaR dit COMBIEN le portefeuille peut perdre ; le risk manager demande
+ * ensuite QUI porte cette perte : quel trade, quel marché ? Et que se
+ * passe-t-il si on coupe ce trade ?
+ *
+ * Tout se lit sur la matrice des P&L par ligne et par scénario
+ * (ScenarioPnLMatrix) : les scénarios de la queue sont identifiés UNE fois
+ * (sélection sur les indices, comme le quantile de la VaR), puis chaque
+ * ligne n'est lue que sur ces scénarios. Aucune nouvelle simulation.
+ */
+
+#pragma once
+
+#include "portfolio_book.hpp"  // ScenarioPnLMatrix
+#include "parallel_utils.hpp"  // Lignes réparties sur plusieurs threads
+#include <string>              // Nom de chaque ligne
+#include <vector>              // Contributions, indices de scénarios
+#include <span>                // Lignes, noms, expositions
+#include <algorithm>           // nth_element, sort
+#include <numeric>             // iota
+#include <cmath>               // abs
+
+// ===== NIVEAU D'ATTRIBUTION =====
+/*
+ * - NONE       : pas d'attribution (aucune matrice conservée)
+ * - POSITION   : une ligne par position valide (instrument_id)
+ * - UNDERLYING : une ligne par sous-jacent (somme de ses positions)
+ */
+enum class AttributionLevel {
+    NONE,
+    POSITION,
+    UNDERLYING
+};
+
+// ===== CONTRIBUTION D'UNE LIGNE =====
+/*
+ * Mêmes unités que la VaR du portefeuille (fraction de sa valeur), sauf
+ * marginal_var (sans dimension).
+ */
+struct RiskContribution {
+    std::string name;              // instrument_id ou sous-jacent
+    double component_var{0.0};     // Part de la VaR (Σ lignes ≈ VaR)
+    double component_es{0.0};      // Part de l'ES (Σ lignes = ES, exactement)
+    double marginal_var{0.0};      // $ de VaR par $ de taille ajouté à la ligne, dans son sens
+    double incremental_var{0.0};   // VaR - VaR du portefeuille sans la ligne
+};
+
+// ===== ATTRIBUTION DE LA VaR/ES =====
+/*
+ * DÉFINITIONS (x_i,s = P&L de la ligne i au scénario s, R_s = Σ_i x_i,s) :
+ * - Queue T = les k = ⌊(1 - α) × N⌋ pires scénarios de R, VaR = -R au rang k
+ *   (même convention que MonteCarloEngine::calculate_var_es_in_place)
+ * - Component ES_i = -moyenne de x_i,s sur T (décomposition d'Euler : l'ES
+ *   est homogène de degré 1 en la taille des lignes → Σ_i = ES)
+ * - Component VaR_i = -E[x_i | R = -VaR], estimée par la moyenne de x_i sur
+ *   une fenêtre de scénarios encadrant le rang k (un seul scénario serait
+ *   trop bruité) → Σ_i ≈ VaR
+ * - Marginal VaR_i = ∂VaR/∂λ_i / |exposition_i| (ligne i mise à l'échelle
+ *   λ_i × x_i) = Component VaR_i en $ / |exposition_i| : VaR par $ de
+ *   taille ajouté DANS LE SENS de la ligne (acheter plus pour une ligne
+ *   longue, vendre plus pour une courte). Même signe que Component VaR_i
+ *   (exposition = valeur de la ligne ; 0 si la valeur est nulle)
+ * - Incremental VaR_i = VaR(R) - VaR(R - x_i) : exacte, une sélection par ligne
+ *
+ * COÛT : une sélection sur les indices des N scénarios (partagée), puis
+ * O(k + fenêtre) lectures par ligne pour ES/VaR composantes ; la VaR
+ * incrémentale reste O(N) par ligne (nouveau quantile sans la ligne).
+ * Lignes indépendantes → blocs de lignes en parallèle, résultat identique
+ * quel que soit le nombre de threads.
+ */
+struct RiskAttribution {
+    double confidence{0.0};
+    double var{0.0};              // VaR du portefeuille à ce niveau
+    double es{0.0};               // ES du portefeuille à ce niveau
+    size_t n_tail{0};             // Scénarios de la queue (k)
+    size_t n_window{0};           // Scénarios autour du quantile (Component VaR)
+    std::vector<RiskContribution> contributions;  // Une par ligne, dans l'ordre des lignes
+
+    /*
+     * PARAMÈTRES :
+     * - rows : P&L par ligne et par scénario (en $)
+     * - portfolio_pnl : Σ des lignes par scénario (en $), déjà calculée par l'appelant
+     * - names, exposures : nom et valeur (en $) de chaque ligne
+     * - portfolio_value : rendements = P&L / |portfolio_value| (comme la VaR)
+     */
+    [[nodiscard]] static RiskAttribution compute(
+        const ScenarioPnLMatrix& rows,
+        std::span<const double> portfolio_pnl,
+        std::span<const std::string> names,
+        std::span<const double> exposures,
+        double portfolio_value,
+        double confidence,
+        size_t n_threads = 1) {
+
+        RiskAttribution result;
+        result.confidence = confidence;
+
+        const size_t n = rows.n_scenarios;
+        const size_t k = static_cast<size_t>((1.0 - confidence) * n);
+        if (rows.n_positions == 0 || k >= n || portfolio_value == 0.0) return result;
+        const double scale = 1.0 / std::abs(portfolio_value);
+
+        /*
+         * SCÉNARIOS DE LA QUEUE (UNE SEULE SÉLECTION)
+         * ===========================================
+         * nth_element sur les indices : order[0, k) = queue, order[k] = scénario
+         * de la VaR. Puis les h voisins de chaque côté du rang k, par deux
+         * sélections limitées à chaque moitié (la queue reste la queue).
+         */
+        std::vector<size_t> order(n);
+        std::iota(order.begin(), order.end(), size_t{0});
+        const auto by_pnl = [&](size_t a, size_t b) { return portfolio_pnl[a] < portfolio_pnl[b]; };
+        std::nth_element(order.begin(), order.begin() + k, order.end(), by_pnl);
+
+        const size_t h = std::max<size_t>(1, k / WINDOW_DIVISOR);
+        const size_t lo = k - std::min(h, k);
+        const size_t hi = std::min(k + h, n - 1);
+        if (lo < k) std::nth_element(order.begin(), order.begin() + lo, order.begin() + k, by_pnl);
+        if (hi > k) std::nth_element(order.begin() + k + 1, order.begin() + hi, order.end(), by_pnl);
+
+        // Indices croissants : lecture des lignes dans l'ordre de la mémoire
+        std::vector<size_t> tail(order.begin(), order.begin() + k);
+        std::vector<size_t> window(order.begin() + lo, order.begin() + hi + 1);
+        std::sort(tail.begin(), tail.end());
+        std::sort(window.begin(), window.end());
+
+        result.var = -portfolio_pnl[order[k]] * scale;
+        double tail_sum = 0.0;
+        for (size_t s : tail) tail_sum += portfolio_pnl[s];
+        result.es = k > 0 ? -tail_sum / k * scale : 0.0;
+        result.n_tail = k;
+        result.n_window = window.size();
+
+        /*
+         * CONTRIBUTIONS, LIGNE PAR LIGNE
+         * ==============================
+         * Chaque bloc a son tampon pour le portefeuille sans la ligne (VaR incrémentale)
+         */
+        result.contributions.resize(rows.n_positions);
+        parallel::for_each_block(rows.n_positions, ROWS_PER_BLOCK, n_threads,
+            [&](size_t, size_t begin, size_t end) {
+            std::vector<double> without(n);
+            for (size_t i = begin; i < end; ++i) {
+                const auto row = rows.row(i);
+                RiskContribution& c = result.contributions[i];
+                c.name = names[i];
+
+                double row_tail = 0.0, row_window = 0.0;
+                for (size_t s : tail) row_tail += row[s];
+                for (size_t s : window) row_window += row[s];
+                c.component_es = k > 0 ? -row_tail / k * scale : 0.0;
+                c.component_var = -row_window / window.size() * scale;
+                c.marginal_var = exposures[i] != 0.0 ? -row_window / window.size() / std::abs(exposures[i]) : 0.0;
+
+                for (size_t s = 0; s < n; ++s) without[s] = portfolio_pnl[s] - row[s];
+                std::nth_element(without.begin(), without.begin() + k, without.end());
+                c.incremental_var = result.var + without[k] * scale;
+            }
+        });
+
+        return result;
+    }
+
+private:
+    static constexpr size_t ROWS_PER_BLOCK = 16;
+    /*
+     * Fenêtre de la Component VaR : h = k / 10 voisins de chaque côté
+     * (10,000 scénarios à 99% : k = 100 → 21 scénarios autour du quantile)
+     */
+    static constexpr size_t WINDOW_DIVISOR = 10;
+};
+
+/*
+ * RÉSUMÉ DE CE FICHIER :
+ * ======================
+ *
+ * 1. AttributionLevel : NONE, POSITION (par trade), UNDERLYING (par marché)
+ * 2. RiskContribution : Component VaR/ES, Marginal VaR, Incremental VaR d'une ligne
+ * 3. RiskAttribution::compute : queue sélectionnée une fois sur les indices,
+ *    puis chaque ligne lue sur la queue (ES), autour du quantile (VaR)
+ *    et re-sélection sans la ligne (VaR incrémentale)
+ *
+ * LECTURE MÉTIER :
+ * - Component ES : qui porte la perte moyenne des pires jours (Σ = ES)
+ * - Marginal VaR > 0 : grossir la ligne (dans son sens, short compris) augmente
+ *   la VaR ; < 0 : la ligne couvre, la grossir réduit la VaR
+ * - Incremental VaR : VaR économisée en coupant entièrement la ligne
+ *
+ * USAGE TYPIQUE :
+ * auto metrics = calculator.calculate_portfolio_risk(positions, market_data,
+ *     RiskConfig{.attribution = AttributionLevel::POSITION});
+ * for (const auto& c : metrics.attribution.contributions) {
+ *     std::cout << c.name << " : " << c.component_es * 100 << "% de la valeur dans l'ES\n";
+ * }
+ */
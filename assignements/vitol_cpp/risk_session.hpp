@@ -0,0 +1,466 @@
+/*
+ * risk_session.hpp - Session de risque incrémentale
+ *
+ * calculate_portfolio_risk() repart de zéro à chaque appel : filtrage,
+ * Greeks de toutes les positions, simulation et réévaluation complète
+ * (positions × scénarios). Un trader qui amende un trade attend donc
+ * autant qu'un recalcul de fin de journée.
+ *
+ * Une RiskSession garde en mémoire, pour chaque position :
+ * - sa valeur et ses Greeks (notional inclus)
+ * - sa ligne de P&L sur les scénarios (mêmes scénarios pour toute la session)
+ * et les agrégats correspondants (valeur, Greeks par sous-jacent, P&L du
+ * portefeuille par scénario). Ajouter, amender ou retirer UN trade ne
+ * touche que sa propre ligne : O(scénarios) au lieu de O(positions × scénarios).
+ */
+
+#pragma once
+
+#include "portfolio_calculator.hpp" // Scénarios, RiskMetrics, MarketData, RiskConfig
+#include "portfolio_book.hpp"       // CompiledBook, RevaluationInvariants, ScenarioPnLMatrix
+#include "risk_attribution.hpp"     // Contributions VaR/ES sur les lignes de la session
+#include "pricing_models.hpp"       // Noyau Black-Scholes par lots (Greeks)
+#include "parallel_utils.hpp"       // Construction initiale sur plusieurs threads
+#include <unordered_map>            // instrument_id → ligne
+#include <string>                   // Identifiants des trades
+#include <vector>                   // Lignes et agrégats
+#include <span>                     // Positions en entrée, vues sur les lignes
+#include <array>                    // Niveaux de confiance
+#include <optional>                 // Erreur de validation éventuelle
+#include <chrono>                   // Temps de mise à jour
+
+// ===== SESSION DE RISQUE INCRÉMENTALE =====
+/*
+ * ORGANISATION INTERNE (une "ligne" par position, mêmes indices partout) :
+ *     book_        : colonnes SoA (strike, maturité, notional...) + univers des sous-jacents
+ *     invariants_  : invariants Black-Scholes et valeur de base par position
+ *     pnl_         : P&L par position et par scénario
+ *     greeks_      : Greeks étendus par position (notional inclus)
+ *     positions_   : Position d'origine (pour retrouver l'instrument_id d'une ligne)
+ * Un retrait déplace la dernière ligne dans le trou (swap_remove) : O(1)
+ * hors copie de la ligne de P&L.
+ *
+ * Les scénarios (rendements de TOUS les sous-jacents ayant spot et vol)
+ * sont simulés une fois à l'ouverture : un trade ajouté plus tard, même
+ * sur un sous-jacent encore absent, est réévalué sur les mêmes scénarios.
+ * La VaR est toujours en réévaluation complète (config.var_method ignoré).
+ */
+class RiskSession {
+public:
+    using MarketData = PortfolioRiskCalculator::MarketData;
+    using RiskMetrics = PortfolioRiskCalculator::RiskMetrics;
+
+    /*
+     * OUVERTURE DE SESSION
+     * ====================
+     * Positions invalides ou sans données de marché ignorées (comme
+     * calculate_portfolio_risk) ; en cas d'instrument_id en double,
+     * seule la première occurrence est gardée.
+     */
+    RiskSession(const PortfolioRiskCalculator& calculator,
+                std::span<const Position> positions,
+                const MarketData& market_data,
+                const RiskConfig& config = {})
+        : n_scenarios_(config.n_simulations),
+          n_threads_(calculator.thread_count()) {
+
+        const auto start_time = std::chrono::high_resolution_clock::now();
+
+        /*
+         * UNIVERS ET SCÉNARIOS
+         * ====================
+         * Book compilé avec tous les sous-jacents du marché, puis rendements
+         * simulés une fois pour toute la session
+         */
+        book_ = CompiledBook::compile(std::span<const Position>{}, market_data, true);
+        if (const auto simulation = calculator.simulate_book_returns(book_, n_scenarios_, config.horizon);
+            simulation.has_value()) {
+            returns_ = simulation.value();
+        } else {
+            // Corrélations indéfinies : scénarios nuls, VaR/ES à 0 et erreur publiée dans metrics()
+            var_error_ = simulation.error();
+            returns_.assign(book_.n_underlyings() * n_scenarios_, 0.0);
+        }
+
+        for (size_t p = 0; p < positions.size(); ++p) {
+            const Position& pos = positions[p];
+            if (!pos.is_valid() || !market_data.is_complete_for_position(pos)) continue;
+            if (!slots_.try_emplace(pos.instrument_id, book_.size()).second) continue;  // Doublon
+            book_.append_position(pos, p);
+            positions_.push_back(pos);
+        }
+
+        /*
+         * LIGNES DE TOUTES LES POSITIONS
+         * ==============================
+         * Invariants et Greeks, puis une ligne de P&L par position
+         * (lignes indépendantes → blocs de positions en parallèle)
+         */
+        invariants_ = RevaluationInvariants::compute(book_);
+        pnl_ = ScenarioPnLMatrix(book_.size(), n_scenarios_);
+        greeks_.resize(book_.size());
+
+        parallel::for_each_block(book_.size(), POSITIONS_PER_BLOCK, n_threads_,
+            [&](size_t, size_t begin, size_t end) {
+            compute_greeks(begin, end);
+            for (size_t i = begin; i < end; ++i) compute_row(i);
+        });
+
+        resync();
+        metrics_.calculation_time_us = elapsed_us(start_time);
+    }
+
+    /*
+     * MÉTRIQUES COURANTES
+     * ===================
+     * Toujours à jour après chaque opération (calculation_time_us = durée
+     * de la dernière opération)
+     */
+    [[nodiscard]] const RiskMetrics& metrics() const noexcept { return metrics_; }
+    [[nodiscard]] size_t size() const noexcept { return book_.size(); }
+    [[nodiscard]] size_t n_scenarios() const noexcept { return n_scenarios_; }
+    [[nodiscard]] bool contains(const std::string& instrument_id) const {
+        return slots_.contains(instrument_id);
+    }
+
+    // P&L du portefeuille par scénario (en $) et P&L par position (lignes du book courant)
+    [[nodiscard]] std::span<const double> portfolio_pnl() const noexcept { return portfolio_pnl_; }
+    [[nodiscard]] const ScenarioPnLMatrix& scenario_pnl() const noexcept { return pnl_; }
+
+    /*
+     * ATTRIBUTION DE LA VaR/ES
+     * ========================
+     * Sur les lignes déjà en mémoire : aucune réévaluation.
+     * UNDERLYING : une ligne par sous-jacent de l'univers (nulle s'il n'a pas de position)
+     */
+    [[nodiscard]] RiskAttribution attribution(AttributionLevel level = AttributionLevel::POSITION,
+                                              double confidence = 0.99) const {
+        if (level == AttributionLevel::NONE) return {};
+        if (level == AttributionLevel::POSITION) {
+            std::vector<std::string> names;
+            names.reserve(positions_.size());
+            for (const Position& pos : positions_) names.push_back(pos.instrument_id);
+            return RiskAttribution::compute(pnl_, portfolio_pnl_, names, invariants_.base_values,
+                                            portfolio_value_, confidence, n_threads_);
+        }
+        std::vector<double> exposures(book_.n_underlyings(), 0.0);
+        for (size_t i = 0; i < book_.size(); ++i) {
+            exposures[book_.underlying_ids[i]] += invariants_.base_values[i];
+        }
+        return RiskAttribution::compute(pnl_.aggregate(book_.underlying_ids, book_.n_underlyings()),
+                                        portfolio_pnl_, book_.underlyings, exposures,
+                                        portfolio_value_, confidence, n_threads_);
+    }
+
+    /*
+     * AJOUT D'UN TRADE
+     * ================
+     * Retourne la valeur de la position ajoutée
+     */
+    [[nodiscard]] expected<double, RiskError> add_position(const Position& pos) {
+        const auto start_time = std::chrono::high_resolution_clock::now();
+
+        if (const auto error = check(pos)) return expected<double, RiskError>{*error};
+        if (slots_.contains(pos.instrument_id)) {
+            return expected<double, RiskError>{RiskError::DUPLICATE_POSITION};
+        }
+
+        const size_t slot = book_.size();
+        slots_.emplace(pos.instrument_id, slot);
+        book_.append_position(pos, slot);
+        positions_.push_back(pos);
+        invariants_.resize(book_.size());
+        pnl_.append_row();
+        greeks_.emplace_back();
+
+        price_slot(slot);
+        apply(slot, +1.0);
+        refresh_metrics(book_.underlying_ids[slot]);
+
+        metrics_.calculation_time_us = elapsed_us(start_time);
+        return expected<double, RiskError>{invariants_.base_values[slot]};
+    }
+
+    /*
+     * AMENDEMENT D'UN TRADE (même instrument_id)
+     * ==========================================
+     * Notional, strike, maturité, type ou même sous-jacent peuvent changer.
+     * Retourne la nouvelle valeur de la position.
+     */
+    [[nodiscard]] expected<double, RiskError> amend_position(const Position& pos) {
+        const auto start_time = std::chrono::high_resolution_clock::now();
+
+        const auto it = slots_.find(pos.instrument_id);
+        if (it == slots_.end()) return expected<double, RiskError>{RiskError::UNKNOWN_POSITION};
+        if (const auto error = check(pos)) return expected<double, RiskError>{*error};
+
+        const size_t slot = it->second;
+        const uint32_t old_id = book_.underlying_ids[slot];
+
+        apply(slot, -1.0);
+        book_.assign_position(slot, pos);
+        positions_[slot] = pos;
+        price_slot(slot);
+        apply(slot, +1.0);
+
+        refresh_metrics(old_id);
+        if (book_.underlying_ids[slot] != old_id) refresh_metrics(book_.underlying_ids[slot]);
+
+        metrics_.calculation_time_us = elapsed_us(start_time);
+        return expected<double, RiskError>{invariants_.base_values[slot]};
+    }
+
+    /*
+     * RETRAIT D'UN TRADE
+     * ==================
+     * Retourne la valeur de la position retirée
+     */
+    [[nodiscard]] expected<double, RiskError> remove_position(const std::string& instrument_id) {
+        const auto start_time = std::chrono::high_resolution_clock::now();
+
+        const auto it = slots_.find(instrument_id);
+        if (it == slots_.end()) return expected<double, RiskError>{RiskError::UNKNOWN_POSITION};
+
+        const size_t slot = it->second;
+        const size_t last = book_.size() - 1;
+        const uint32_t id = book_.underlying_ids[slot];
+        const double removed_value = invariants_.base_values[slot];
+
+        apply(slot, -1.0);
+        slots_.erase(it);
+
+        /*
+         * SWAP-REMOVE : la dernière ligne prend la place de la ligne retirée
+         */
+        if (slot != last) slots_[positions_[last].instrument_id] = slot;
+        book_.swap_remove(slot);
+        invariants_.swap_remove(slot);
+        pnl_.swap_remove(slot);
+        swap_remove(greeks_, slot);
+        swap_remove(positions_, slot);
+
+        refresh_metrics(id);
+
+        metrics_.calculation_time_us = elapsed_us(start_time);
+        return expected<double, RiskError>{removed_value};
+    }
+
+    /*
+     * RESYNCHRONISATION DES AGRÉGATS
+     * ==============================
+     * Chaque mise à jour ajoute puis retranche des lignes : après des
+     * milliers d'amendements, les sommes peuvent différer de quelques ulps
+     * d'une somme refaite à neuf. resync() refait toutes les sommes dans
+     * l'ordre des lignes, O(positions × scénarios) (ex. une fois par heure).
+     */
+    void resync() {
+        const size_t n_underlyings = book_.n_underlyings();
+        greeks_by_id_.assign(n_underlyings, {});
+        positions_by_id_.assign(n_underlyings, 0);
+        portfolio_value_ = 0.0;
+
+        for (size_t i = 0; i < book_.size(); ++i) {
+            const uint32_t id = book_.underlying_ids[i];
+            greeks_by_id_[id].add(greeks_[i]);
+            ++positions_by_id_[id];
+            portfolio_value_ += invariants_.base_values[i];
+        }
+
+        // P&L du portefeuille : blocs de scénarios en parallèle, lignes sommées dans l'ordre
+        portfolio_pnl_.assign(n_scenarios_, 0.0);
+        parallel::for_each_block(n_scenarios_, SCENARIOS_PER_BLOCK, n_threads_,
+            [&](size_t, size_t begin, size_t end) {
+            for (size_t i = 0; i < book_.size(); ++i) {
+                const auto row = pnl_.row(i);
+                for (size_t s = begin; s < end; ++s) portfolio_pnl_[s] += row[s];
+            }
+        });
+
+        metrics_ = RiskMetrics{};
+        metrics_.monte_carlo_simulations = n_scenarios_;
+        metrics_.var_error = var_error_;
+        for (size_t id = 0; id < n_underlyings; ++id) refresh_greeks(static_cast<uint32_t>(id));
+        refresh_var();
+    }
+
+private:
+    static constexpr size_t POSITIONS_PER_BLOCK = 256;
+    static constexpr size_t SCENARIOS_PER_BLOCK = 4096;
+
+    size_t n_scenarios_;
+    size_t n_threads_;
+
+    // Une ligne par position
+    CompiledBook book_;
+    RevaluationInvariants invariants_;
+    ScenarioPnLMatrix pnl_;
+    std::vector<BlackScholesModel::ExtendedGreeks> greeks_;
+    std::vector<Position> positions_;
+    std::unordered_map<std::string, size_t> slots_;  // instrument_id → ligne
+
+    // Scénarios : returns_[id × n_scenarios + s]
+    std::vector<double> returns_;
+    std::optional<RiskError> var_error_;  // Simulation impossible (INVALID_CORRELATION)
+
+    // Agrégats
+    double portfolio_value_{0.0};
+    std::vector<BlackScholesModel::ExtendedGreeks> greeks_by_id_;
+    std::vector<size_t> positions_by_id_;
+    std::vector<double> portfolio_pnl_;
+    RiskMetrics metrics_;
+
+    /*
+     * VALIDATION D'UN TRADE ENTRANT
+     * Position cohérente et sous-jacent présent dans l'univers de la session
+     */
+    [[nodiscard]] std::optional<RiskError> check(const Position& pos) const {
+        if (!pos.is_valid()) return RiskError::INVALID_POSITION;
+        if (book_.find_underlying(pos.underlying) == book_.n_underlyings()) {
+            return RiskError::MISSING_MARKET_DATA;
+        }
+        return std::nullopt;
+    }
+
+    /*
+     * PRICING D'UNE LIGNE : invariants, Greeks et P&L par scénario
+     */
+    void price_slot(size_t slot) {
+        invariants_.assign(book_, slot);
+        compute_greeks(slot, slot + 1);
+        compute_row(slot);
+    }
+
+    // Greeks des lignes [begin, end) : noyau Black-Scholes par lots, puis × notional
+    void compute_greeks(size_t begin, size_t end) {
+        const size_t n = end - begin;
+        std::vector<double> spots(n), rates(n, book_.risk_free_rate), vols(n);
+        for (size_t k = 0; k < n; ++k) {
+            spots[k] = book_.spot(begin + k);
+            vols[k] = book_.vol(begin + k);
+        }
+
+        // Une colonne par champ d'ExtendedGreeks
+        std::vector<double> unit_greeks(10 * n);
+        const auto column = [&](size_t c) { return std::span<double>(unit_greeks).subspan(c * n, n); };
+        const BlackScholesModel::ExtendedGreeksBatch unit{
+            .price = column(0), .delta = column(1), .gamma = column(2), .vega = column(3),
+            .theta = column(4), .rho = column(5), .vanna = column(6), .volga = column(7),
+            .charm = column(8), .speed = column(9)};
+        BlackScholesModel::extended_greeks_batch(
+            spots,
+            std::span<const double>(book_.strikes).subspan(begin, n),
+            std::span<const double>(book_.maturities).subspan(begin, n),
+            rates, vols,
+            std::span<const uint8_t>(book_.is_call).subspan(begin, n),
+            unit);
+
+        for (size_t k = 0; k < n; ++k) {
+            greeks_[begin + k] = unit.at(k).scaled(book_.notionals[begin + k]);
+        }
+    }
+
+    // Ligne de P&L de la position i sur tous les scénarios (noyau vectorisé)
+    void compute_row(size_t i) {
+        const auto shocks = std::span<const double>(returns_).subspan(
+            book_.underlying_ids[i] * n_scenarios_, n_scenarios_);
+        invariants_.scenario_pnl(book_, i, shocks, pnl_.row(i));
+    }
+
+    /*
+     * AJOUT (sign = +1) OU RETRAIT (sign = -1) D'UNE LIGNE DANS LES AGRÉGATS
+     * O(scénarios) : c'est tout le coût d'une mise à jour
+     */
+    void apply(size_t slot, double sign) {
+        const uint32_t id = book_.underlying_ids[slot];
+        portfolio_value_ += sign * invariants_.base_values[slot];
+        greeks_by_id_[id].add(greeks_[slot], sign);
+        positions_by_id_[id] = sign > 0 ? positions_by_id_[id] + 1 : positions_by_id_[id] - 1;
+
+        const auto row = pnl_.row(slot);
+        for (size_t s = 0; s < n_scenarios_; ++s) portfolio_pnl_[s] += sign * row[s];
+    }
+
+    /*
+     * MISE À JOUR DES MÉTRIQUES PUBLIÉES
+     * Greeks du seul sous-jacent touché + valeur + VaR/ES (sélection O(scénarios))
+     */
+    void refresh_metrics(uint32_t id) {
+        refresh_greeks(id);
+        refresh_var();
+    }
+
+    // Comme calculate_portfolio_risk : un sous-jacent n'apparaît que s'il porte des positions
+    void refresh_greeks(uint32_t id) {
+        const std::string& underlying = book_.underlyings[id];
+        if (positions_by_id_[id] == 0) {
+            metrics_.erase_greeks(underlying);
+            return;
+        }
+        metrics_.set_greeks(underlying, greeks_by_id_[id]);
+    }
+
+    void refresh_var() {
+        metrics_.portfolio_value = portfolio_value_;
+        metrics_.var_95 = metrics_.es_95 = 0.0;
+        metrics_.var_99 = metrics_.es_99 = 0.0;
+        metrics_.var_999 = metrics_.es_999 = 0.0;
+        if (book_.empty() || portfolio_value_ == 0.0 || var_error_) return;
+
+        // Rendements = P&L / |valeur| (copie : portfolio_pnl_ doit rester dans l'ordre)
+        std::vector<double> returns(portfolio_pnl_);
+        const double scale = 1.0 / std::abs(portfolio_value_);
+        for (double& r : returns) r *= scale;
+
+        const std::array confidence_levels = {0.95, 0.99, 0.999};
+        const auto var_es = MonteCarloEngine::calculate_var_es_in_place(returns, confidence_levels);
+        metrics_.var_95 = var_es[0].first;
+        metrics_.es_95 = var_es[0].second;
+        metrics_.var_99 = var_es[1].first;
+        metrics_.es_99 = var_es[1].second;
+        metrics_.var_999 = var_es[2].first;
+        metrics_.es_999 = var_es[2].second;
+    }
+
+    template<typename T>
+    static void swap_remove(std::vector<T>& values, size_t i) {
+        if (i + 1 != values.size()) values[i] = std::move(values.back());
+        values.pop_back();
+    }
+
+    [[nodiscard]] static size_t elapsed_us(std::chrono::high_resolution_clock::time_point start) {
+        return static_cast<size_t>(std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::high_resolution_clock::now() - start).count());
+    }
+};
+
+/*
+ * RÉSUMÉ DE CE FICHIER :
+ * ======================
+ *
+ * CLASSE RiskSession :
+ * 1. CONSTRUCTEUR : simule les scénarios de l'univers, price toutes les positions
+ *    (Greeks + ligne de P&L), calcule les agrégats et la VaR/ES
+ * 2. ADD_POSITION / AMEND_POSITION / REMOVE_POSITION : mise à jour d'UNE ligne
+ *    et des agrégats en O(scénarios), VaR/ES recalculées par sélection
+ * 3. METRICS() : RiskMetrics courantes (même contenu que calculate_portfolio_risk)
+ * 4. RESYNC() : somme à neuf des agrégats (dérive d'arrondi)
+ * 5. PORTFOLIO_PNL() / SCENARIO_PNL() : P&L par scénario, total et par position
+ * 6. ATTRIBUTION() : Component VaR/ES, Marginal et Incremental VaR par
+ *    position ou sous-jacent, sur les lignes déjà calculées
+ *
+ * COÛTS :
+ * - Ouverture : O(positions × scénarios), comme un calcul complet
+ * - Mise à jour : O(scénarios) → 10,000 positions × 100,000 scénarios :
+ *   une ligne de 100,000 prix au lieu d'un milliard
+ * - Mémoire : positions × scénarios doubles (lignes de P&L conservées)
+ *
+ * USAGE TYPIQUE :
+ * PortfolioRiskCalculator calculator;
+ * RiskSession session(calculator, positions, market_data, RiskConfig{.n_simulations = 100'000});
+ *
+ * // Amendement booké par un trader : quelques millisecondes
+ * if (auto result = session.amend_position(amended_trade); !result.has_value()) {
+ *     log_error(result.error());
+ * }
+ * if (session.metrics().var_99 > daily_var_limit) alert_risk_manager("VaR limit exceeded!");
+ */
@@ -0,0 +1,298 @@
+/*
+ * stress_testing.hpp - Moteur de scénarios de stress multi-facteurs
+ *
+ * Un scénario de stress réaliste ne choque pas tous les marchés du même
+ * pourcentage : "Hormuz fermé" = Brent +40%, WTI +30%, vol pétrole +15 points,
+ * NatGas inchangé. Les desks en rejouent des milliers chaque soir.
+ *
+ * Chaque scénario est une liste CREUSE de chocs (sous-jacent, facteur,
+ * type, taille) appliqués par-dessus le marché de base, sans le copier :
+ * seuls les sous-jacents touchés sont repricés, par lots vectorisés
+ * (BlackScholesModel::price_and_greeks_batch), les scénarios étant
+ * répartis sur les threads. Résultat : matrice scénario × sous-jacent.
+ */
+
+#pragma once
+
+#include "portfolio_book.hpp"  // CompiledBook
+#include "pricing_models.hpp"  // Noyau Black-Scholes par lots
+#include "parallel_utils.hpp"  // Scénarios répartis sur plusieurs threads
+#include <string>              // Noms des scénarios et sous-jacents
+#include <vector>              // Chocs, matrice de résultats
+#include <span>                // Scénarios en entrée
+#include <array>               // Tranches de positions
+#include <algorithm>           // max, fill
+#include <cstdint>             // uint32_t, uint8_t
+
+// ===== DÉFINITION D'UN SCÉNARIO =====
+/*
+ * FACTEURS : spot, volatilité, taux sans risque (par sous-jacent)
+ * TYPES :
+ * - RELATIVE : x → x × (1 + size)   (spot -30% : size = -0.30)
+ * - ABSOLUTE : x → x + size         (vol +10 points : size = 0.10 ; taux +100 pb : size = 0.01)
+ */
+enum class StressFactor {
+    SPOT,
+    VOL,
+    RATE
+};
+
+enum class ShockType {
+    RELATIVE,
+    ABSOLUTE
+};
+
+struct StressShock {
+    std::string underlying;  // Sous-jacent choqué ("" = tous les sous-jacents)
+    StressFactor factor{StressFactor::SPOT};
+    ShockType type{ShockType::RELATIVE};
+    double size{0.0};
+};
+
+/*
+ * Chocs appliqués dans l'ordre (plusieurs chocs sur un même facteur se
+ * composent) ; sous-jacents absents du book ignorés
+ */
+struct StressScenario {
+    std::string name;
+    std::vector<StressShock> shocks;
+};
+
+// ===== RÉSULTATS : MATRICE SCÉNARIO × SOUS-JACENT =====
+/*
+ * pnl[scénario × n_underlyings + sous-jacent] : P&L en $ des positions du
+ * sous-jacent dans le scénario (0 si le scénario ne le touche pas)
+ */
+struct StressPnLMatrix {
+    std::vector<std::string> scenario_names;  // Lignes
+    std::vector<std::string> underlyings;     // Colonnes (ordre du book)
+    std::vector<double> pnl;
+
+    [[nodiscard]] size_t n_scenarios() const noexcept { return scenario_names.size(); }
+    [[nodiscard]] size_t n_underlyings() const noexcept { return underlyings.size(); }
+    [[nodiscard]] double at(size_t scenario, size_t underlying) const noexcept {
+        return pnl[scenario * underlyings.size() + underlying];
+    }
+    [[nodiscard]] std::span<const double> row(size_t scenario) const noexcept {
+        return {pnl.data() + scenario * underlyings.size(), underlyings.size()};
+    }
+    // P&L total du portefeuille dans le scénario
+    [[nodiscard]] double total(size_t scenario) const noexcept {
+        double sum = 0.0;
+        for (double value : row(scenario)) sum += value;
+        return sum;
+    }
+};
+
+// ===== MOTEUR DE STRESS =====
+/*
+ * PRÉPARATION (une fois) :
+ * - positions regroupées par sous-jacent (tableaux contigus par groupe)
+ * - valeurs de base avec le MÊME noyau que les scénarios → P&L nul sans choc
+ * - chocs résolus en identifiants entiers ("" développé en tous les sous-jacents)
+ *
+ * PAR SCÉNARIO :
+ * - paramètres choqués (S, σ, r) des seuls sous-jacents touchés
+ * - repricing de leurs positions par tranches, P&L sommé par sous-jacent
+ * Coût proportionnel aux positions TOUCHÉES, pas à la taille du book.
+ *
+ * Paramètres choqués invalides (spot ou vol ≤ 0) : positions valorisées à 0
+ * (comme une erreur de pricing ignorée par l'ancien stress_test_portfolio).
+ */
+class StressTestEngine {
+public:
+    [[nodiscard]] static StressPnLMatrix run(const CompiledBook& book,
+                                             std::span<const StressScenario> scenarios,
+                                             size_t n_threads = 1) {
+        const size_t n_underlyings = book.n_underlyings();
+        StressPnLMatrix result;
+        result.underlyings = book.underlyings;
+        result.scenario_names.reserve(scenarios.size());
+        for (const auto& scenario : scenarios) result.scenario_names.push_back(scenario.name);
+        result.pnl.assign(scenarios.size() * n_underlyings, 0.0);
+        if (book.empty() || scenarios.empty()) return result;
+
+        const GroupedBook grouped = GroupedBook::build(book);
+        const auto shocks = resolve_shocks(book, scenarios);
+
+        /*
+         * SCÉNARIOS EN PARALLÈLE
+         * ======================
+         * Chaque scénario écrit sa propre ligne : aucun partage entre threads.
+         * État choqué par sous-jacent en tableaux denses, réinitialisé
+         * uniquement pour les sous-jacents touchés (marqueur par scénario).
+         */
+        parallel::for_each_block(scenarios.size(), SCENARIOS_PER_BLOCK, n_threads,
+            [&](size_t, size_t begin, size_t end) {
+            std::vector<double> spot(n_underlyings), vol(n_underlyings), rate(n_underlyings);
+            std::vector<size_t> stamp(n_underlyings, 0);
+            std::vector<uint32_t> touched;
+
+            for (size_t s = begin; s < end; ++s) {
+                touched.clear();
+                for (size_t k = shocks.offsets[s]; k < shocks.offsets[s + 1]; ++k) {
+                    const ResolvedShock& shock = shocks.shocks[k];
+                    const uint32_t id = shock.underlying_id;
+                    if (stamp[id] != s + 1) {  // Premier choc de ce sous-jacent dans le scénario
+                        stamp[id] = s + 1;
+                        spot[id] = book.spots[id];
+                        vol[id] = book.vols[id];
+                        rate[id] = book.risk_free_rate;
+                        touched.push_back(id);
+                    }
+                    double& factor = shock.factor == StressFactor::SPOT ? spot[id]
+                                   : shock.factor == StressFactor::VOL ? vol[id] : rate[id];
+                    factor = shock.type == ShockType::RELATIVE ? factor * (1.0 + shock.size) : factor + shock.size;
+                }
+
+                for (const uint32_t id : touched) {
+                    result.pnl[s * n_underlyings + id] = grouped.stressed_pnl(id, spot[id], vol[id], rate[id]);
+                }
+            }
+        });
+
+        return result;
+    }
+
+private:
+    static constexpr size_t SCENARIOS_PER_BLOCK = 16;
+    static constexpr size_t POSITION_CHUNK = 256;  // Positions repricées par appel du noyau
+
+    /*
+     * POSITIONS REGROUPÉES PAR SOUS-JACENT
+     * Groupe id : indices [offsets[id], offsets[id + 1]) des tableaux
+     */
+    struct GroupedBook {
+        std::vector<size_t> offsets;
+        std::vector<double> strikes, maturities, notionals, base_values;
+        std::vector<uint8_t> is_call;
+
+        [[nodiscard]] static GroupedBook build(const CompiledBook& book) {
+            const size_t n_underlyings = book.n_underlyings();
+            GroupedBook grouped;
+            grouped.offsets.assign(n_underlyings + 1, 0);
+            for (size_t i = 0; i < book.size(); ++i) ++grouped.offsets[book.underlying_ids[i] + 1];
+            for (size_t id = 0; id < n_underlyings; ++id) grouped.offsets[id + 1] += grouped.offsets[id];
+
+            const size_t n = book.size();
+            grouped.strikes.resize(n);
+            grouped.maturities.resize(n);
+            grouped.notionals.resize(n);
+            grouped.is_call.resize(n);
+            grouped.base_values.assign(n, 0.0);
+
+            std::vector<size_t> cursor(grouped.offsets.begin(), grouped.offsets.end() - 1);
+            for (size_t i = 0; i < n; ++i) {
+                const size_t slot = cursor[book.underlying_ids[i]]++;  // Ordre du book conservé dans le groupe
+                grouped.strikes[slot] = book.strikes[i];
+                grouped.maturities[slot] = book.maturities[i];
+                grouped.notionals[slot] = book.notionals[i];
+                grouped.is_call[slot] = book.is_call[i];
+            }
+
+            // Valeurs de base : même noyau, paramètres non choqués
+            for (size_t id = 0; id < n_underlyings; ++id) {
+                grouped.value_group(id, book.spots[id], book.vols[id], book.risk_free_rate,
+                    std::span<double>(grouped.base_values).subspan(grouped.offsets[id],
+                                                                   grouped.offsets[id + 1] - grouped.offsets[id]));
+            }
+            return grouped;
+        }
+
+        // Σ (valeur choquée - valeur de base) des positions du groupe id
+        [[nodiscard]] double stressed_pnl(size_t id, double S, double sigma, double r) const noexcept {
+            std::array<double, POSITION_CHUNK> values;
+            double pnl = 0.0;
+            for (size_t begin = offsets[id]; begin < offsets[id + 1]; begin += POSITION_CHUNK) {
+                const size_t m = std::min(POSITION_CHUNK, offsets[id + 1] - begin);
+                value_range(begin, m, S, sigma, r, std::span<double>(values.data(), m));
+                for (size_t k = 0; k < m; ++k) pnl += values[k] - base_values[begin + k];
+            }
+            return pnl;
+        }
+
+        // Valeurs (notional inclus) des positions du groupe id pour (S, σ, r)
+        void value_group(size_t id, double S, double sigma, double r, std::span<double> out) const noexcept {
+            for (size_t begin = 0; begin < out.size(); begin += POSITION_CHUNK) {
+                const size_t m = std::min(POSITION_CHUNK, out.size() - begin);
+                value_range(offsets[id] + begin, m, S, sigma, r, out.subspan(begin, m));
+            }
+        }
+
+        // m positions consécutives à partir de first (m ≤ POSITION_CHUNK), même (S, σ, r)
+        void value_range(size_t first, size_t m, double S, double sigma, double r,
+                         std::span<double> out) const noexcept {
+            std::array<double, POSITION_CHUNK> spot, vol, rate, delta, gamma, vega, theta;
+            std::fill_n(spot.begin(), m, S);
+            std::fill_n(vol.begin(), m, sigma);
+            std::fill_n(rate.begin(), m, r);
+            BlackScholesModel::price_and_greeks_batch(
+                std::span<const double>(spot.data(), m),
+                std::span<const double>(strikes).subspan(first, m),
+                std::span<const double>(maturities).subspan(first, m),
+                std::span<const double>(rate.data(), m),
+                std::span<const double>(vol.data(), m),
+                std::span<const uint8_t>(is_call).subspan(first, m),
+                {out, {delta.data(), m}, {gamma.data(), m}, {vega.data(), m}, {theta.data(), m}});
+            for (size_t k = 0; k < m; ++k) out[k] *= notionals[first + k];
+        }
+    };
+
+    /*
+     * CHOCS RÉSOLUS (structure de tableaux)
+     * Scénario s : shocks[offsets[s], offsets[s + 1])
+     */
+    struct ResolvedShock {
+        uint32_t underlying_id;
+        StressFactor factor;
+        ShockType type;
+        double size;
+    };
+    struct ResolvedShocks {
+        std::vector<ResolvedShock> shocks;
+        std::vector<size_t> offsets{0};
+    };
+
+    [[nodiscard]] static ResolvedShocks resolve_shocks(const CompiledBook& book,
+                                                       std::span<const StressScenario> scenarios) {
+        ResolvedShocks resolved;
+        resolved.offsets.reserve(scenarios.size() + 1);
+        for (const auto& scenario : scenarios) {
+            for (const auto& shock : scenario.shocks) {
+                if (shock.underlying.empty()) {
+                    for (uint32_t id = 0; id < book.n_underlyings(); ++id) {
+                        resolved.shocks.push_back({id, shock.factor, shock.type, shock.size});
+                    }
+                } else if (const size_t id = book.find_underlying(shock.underlying); id < book.n_underlyings()) {
+                    resolved.shocks.push_back({static_cast<uint32_t>(id), shock.factor, shock.type, shock.size});
+                }
+            }
+            resolved.offsets.push_back(resolved.shocks.size());
+        }
+        return resolved;
+    }
+};
+
+/*
+ * RÉSUMÉ DE CE FICHIER :
+ * ======================
+ *
+ * 1. StressShock / StressScenario : chocs creux (sous-jacent, spot / vol /
+ *    taux, relatif / absolu), nommés par scénario
+ * 2. StressPnLMatrix : P&L scénario × sous-jacent (+ total par scénario)
+ * 3. StressTestEngine::run : positions regroupées par sous-jacent, chocs
+ *    résolus en entiers, scénarios en parallèle, repricing par lots des
+ *    seuls sous-jacents touchés
+ *
+ * USAGE TYPIQUE :
+ * const std::vector<StressScenario> scenarios = {
+ *     {"Hormuz closure", {{"BRENT", StressFactor::SPOT, ShockType::RELATIVE, 0.40},
+ *                         {"WTI", StressFactor::SPOT, ShockType::RELATIVE, 0.30},
+ *                         {"BRENT", StressFactor::VOL, ShockType::ABSOLUTE, 0.15}}},
+ *     {"Rates +200bp", {{"", StressFactor::RATE, ShockType::ABSOLUTE, 0.02}}}
+ * };
+ * const auto stress = calculator.run_stress_scenarios(positions, market_data, scenarios);
+ * for (size_t s = 0; s < stress.n_scenarios(); ++s) {
+ *     std::cout << stress.scenario_names[s] << ": $" << stress.total(s) << "\n";
+ * }
+ */
@@ -10,6 +10,8 @@
 #include <concepts>  // Pour les "concepts" C++20 (nouvelles règles de types)
 #include <ranges>    // Pour manipuler des collections de données facilement
 #include <string>    // Pour utiliser std::string
+#include <span>      // Pour les blocs de données (ReturnSource)
+#include <utility>   // Pour std::move (expected sans copie)
 
 // ===== CONCEPTS C++20 - RÈGLES POUR LES TYPES =====
 /*
@@ -56,6 +58,44 @@ concept RandomAccessRange = std::ranges::random_access_range<Container> &&
  * - std::list<double> → ERREUR (pas d'accès rapide)
  */
 
+// Concept 4: Un accumulateur qui "digère" une trajectoire prix par prix
+template<typename A>
+concept PathAccumulator = std::copy_constructible<A> && requires(A a, const A ca, double price) {
+    a.reset(price);                                 // Début de trajectoire (S0)
+    a.add(price);                                   // Prix suivant
+    { ca.value() } -> std::convertible_to<double>;  // Résultat (ex: payoff)
+};
+/*
+ * Permet de calculer un payoff path-dependent SANS stocker la trajectoire :
+ * moyenne courante, maximum courant, barrière touchée...
+ * Exemple : PayoffModel::PayoffAccumulator
+ */
+
+// Concept 5: Un accumulateur qui fournit aussi une "variable de contrôle"
+template<typename A>
+concept ControlledPathAccumulator = PathAccumulator<A> && requires(const A ca) {
+    { ca.control() } -> std::convertible_to<double>;  // Valeur dont l'espérance est connue
+};
+/*
+ * Variable de contrôle = quantité très corrélée au payoff, dont on connaît
+ * l'espérance exacte (ex: payoff asiatique GÉOMÉTRIQUE, formule fermée).
+ * L'écart "simulé - exact" sert à corriger l'estimation du payoff.
+ */
+
+// Concept 6: Une source d'historique de rendements, lue par blocs de dates
+template<typename S>
+concept ReturnSource = requires(S s, const S cs, std::span<double> block) {
+    { cs.underlyings() } -> std::convertible_to<std::span<const std::string>>;  // Colonnes
+    s.rewind();                                    // Retour à la première date
+    { s.read(block) } -> std::convertible_to<size_t>;  // Dates lues (0 = fin)
+};
+/*
+ * read() remplit block date par date (block[d × colonnes + c]) avec au plus
+ * block.size() / colonnes dates : l'historique complet (10 ans × centaines de
+ * sous-jacents) n'a jamais besoin d'être en mémoire.
+ * Exemples : CsvReturnHistory, InMemoryReturnHistory (historical_simulation.hpp)
+ */
+
 // ===== GESTION D'ERREURS MODERNE =====
 /*
  * Au lieu d'utiliser des exceptions (qui peuvent être lentes),
@@ -77,6 +117,9 @@ public:
     // Constructeur quand tout va bien - on stocke la valeur
     expected(const T& value) : value_(value), has_value_(true) {}
     
+    // Même chose sans copie (gros résultats : matrices de scénarios)
+    expected(T&& value) : value_(std::move(value)), has_value_(true) {}
+    
     // Constructeur quand il y a une erreur - on stocke l'erreur
     expected(const E& error) : error_(error), has_value_(false) {}
     
@@ -121,7 +164,11 @@ enum class RiskError {
     NEGATIVE_TIME,          // Temps jusqu'à expiration négatif
     INVALID_STRIKE,         // Prix d'exercice invalide
     COMPUTATION_FAILED,     // Échec de calcul général
-    MISSING_MARKET_DATA     // Données de marché manquantes
+    MISSING_MARKET_DATA,    // Données de marché manquantes
+    INVALID_CORRELATION,    // Matrice de corrélation/covariance indéfinie (valeur propre < 0)
+    INVALID_POSITION,       // Position incohérente (is_valid() faux)
+    DUPLICATE_POSITION,     // instrument_id déjà présent (RiskSession)
+    UNKNOWN_POSITION        // instrument_id introuvable (RiskSession)
 };
 /*
  * enum class = énumération moderne (C++11+)